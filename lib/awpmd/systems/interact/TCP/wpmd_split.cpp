@@ -607,6 +607,19 @@ cdouble  AWPMD_split::overlap(int ic1, int s1, int c1,int ic2, int s2, int c2){
 }
 
 
+///\en Returns 1 if any split pair of the electron block (c1,c2) of spin s has a nonzero
+///    inter-partition force multiplier, 0 otherwise.
+int AWPMD_split::check_part_block(int s, int ic1, int c1, int ic2, int c2){
+  for(int j1=0;j1<nspl[s][c1];j1++){
+    for(int k2=0;k2<nspl[s][c2];k2++){
+      if(check_part1(s,ic1+j1,ic2+k2).second)
+        return 1;
+    }
+  }
+  return 0;
+}
+
+
 /// adds the derivatives of Y in the term v*Y[s](c2,c1)
 void AWPMD_split::y_deriv(cdouble v,int s,int c2, int c1){
   int ic=0;
@@ -1059,11 +1072,16 @@ int AWPMD_split::interaction(int flag, Vector_3P fi, Vector_3P fe_x,
 # if 1 // pair by pair sum
         // second block
         // e-e interaction
+        int own12=-1; // whether the c1-c2 block has terms on this partition (checked once on demand)
         for(int s2=s1;s2<2;s2++){
           if(approx==HARTREE && c1!=c2) // only Vkmkm terms for Hartree
                continue;
           if(/*s1==s2 &&*/ c2<c1) // pair selection term
              continue;
+          if(own12<0)
+            own12=check_part_block(s1,ic1,c1,ic2,c2);
+          if(!own12) // all terms of the block belong to other partitions: skip the c3-c4 loops
+            continue;
                   
           int ic3=0; // starting index of the wp for current electron
           for(int c3=0 ;c3<ne[s2];ic3+=nspl[s2][c3],c3++){ // incrementing block2 wp address
@@ -1121,7 +1139,8 @@ int AWPMD_split::interaction(int flag, Vector_3P fi, Vector_3P fe_x,
 
                 for(int k2=(approx==HARTREE ? j1: 0); k2<nspl[s1][c2];k2++){
                   int M12=(c1==c2 && j1==k2 ? 1: 2);
-                  
+                  if(!check_part1(s1,ic1+j1,ic2+k2).second) // no terms of this pair on this partition
+                    continue;
                  
                   cdouble ck2(split_c[s1][ic2+k2][0],split_c[s1][ic2+k2][1]);
                 
@@ -162,6 +162,11 @@ public:
   ///    Norms must be pre-calculated.
   cdouble overlap(int ic1, int s1, int c1,int ic2, int s2, int c2);
 
+  ///\en Returns 1 if any split pair of the electron block (c1,c2) of spin s has a nonzero
+  ///    inter-partition force multiplier, 0 otherwise. Since \ref check_part1 is based on the
+  ///    first pair only, e-e terms started by a block returning 0 may be skipped entirely.
+  int check_part_block(int s, int ic1, int c1, int ic2, int c2);
+
   //e same as interaction, but using Hartee factorization (no antisymmetrization)
   int interaction_hartree(int flag=0, Vector_3P fi=NULL, Vector_3P fe_x=NULL, 
                                       Vector_3P fe_p=NULL, double *fe_w=NULL, double *fe_pw=NULL, Vector_2P fe_c=NULL);
@@ -38,6 +38,8 @@ using namespace LAMMPS_NS;
 PairGayBerne::PairGayBerne(LAMMPS *lmp) : Pair(lmp)
 {
   single_enable = 0;
+  nmax = 0;
+  wcache = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -65,6 +67,7 @@ PairGayBerne::~PairGayBerne()
     delete [] lshape;
     delete [] setwell;
   }
+  memory->sfree(wcache);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -74,16 +77,12 @@ void PairGayBerne::compute(int eflag, int vflag)
   int i,j,ii,jj,inum,jnum,itype,jtype;
   double evdwl,one_eng,rsq,r2inv,r6inv,forcelj,factor_lj;
   double fforce[3],ttor[3],rtor[3],r12[3];
-  double a1[3][3],b1[3][3],g1[3][3],a2[3][3],b2[3][3],g2[3][3],temp[3][3];
   int *ilist,*jlist,*numneigh,**firstneigh;
-  double *iquat,*jquat;
 
   evdwl = 0.0;
   if (eflag || vflag) ev_setup(eflag,vflag);
   else evflag = vflag_fdotr = 0;
 
-  AtomVecEllipsoid::Bonus *bonus = avec->bonus;
-  int *ellipsoid = atom->ellipsoid;
   double **x = atom->x;
   double **f = atom->f;
   double **tor = atom->torque;
@@ -97,20 +96,19 @@ void PairGayBerne::compute(int eflag, int vflag)
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // matrices of each ellipsoid are computed once, not once per neighbor
+
+  int nall = nlocal + atom->nghost;
+  grow_cache();
+  for (i = 0; i < nall; i++)
+    if (form[type[i]][type[i]] == ELLIPSE_ELLIPSE) precompute_i(i,wcache[i]);
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
     itype = type[i];
-
-    if (form[itype][itype] == ELLIPSE_ELLIPSE) {
-      iquat = bonus[ellipsoid[i]].quat;
-      MathExtra::quat_to_mat_trans(iquat,a1);
-      MathExtra::diag_times3(well[itype],a1,temp);
-      MathExtra::transpose_times3(a1,temp,b1);
-      MathExtra::diag_times3(shape2[itype],a1,temp);
-      MathExtra::transpose_times3(a1,temp,g1);
-    }
+    GBVars &wi = wcache[i];
 
     jlist = firstneigh[i];
     jnum = numneigh[i];
@@ -149,29 +147,19 @@ void PairGayBerne::compute(int eflag, int vflag)
           break;
 
         case SPHERE_ELLIPSE:
-          jquat = bonus[ellipsoid[j]].quat;
-          MathExtra::quat_to_mat_trans(jquat,a2);
-          MathExtra::diag_times3(well[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,b2);
-          MathExtra::diag_times3(shape2[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,g2);
-          one_eng = gayberne_lj(j,i,a2,b2,g2,r12,rsq,fforce,rtor);
+          one_eng = gayberne_lj(j,i,wcache[j].a,wcache[j].b,wcache[j].g,
+                                r12,rsq,fforce,rtor);
           ttor[0] = ttor[1] = ttor[2] = 0.0;
           break;
 
         case ELLIPSE_SPHERE:
-          one_eng = gayberne_lj(i,j,a1,b1,g1,r12,rsq,fforce,ttor);
+          one_eng = gayberne_lj(i,j,wi.a,wi.b,wi.g,r12,rsq,fforce,ttor);
           rtor[0] = rtor[1] = rtor[2] = 0.0;
           break;
 
         default:
-          jquat = bonus[ellipsoid[j]].quat;
-          MathExtra::quat_to_mat_trans(jquat,a2);
-          MathExtra::diag_times3(well[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,b2);
-          MathExtra::diag_times3(shape2[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,g2);
-          one_eng = gayberne_analytic(i,j,a1,a2,b1,b2,g1,g2,r12,rsq,
+          one_eng = gayberne_analytic(i,j,wi.a,wcache[j].a,wi.b,wcache[j].b,
+                                      wi.g,wcache[j].g,r12,rsq,
                                       fforce,ttor,rtor);
           break;
         }
@@ -214,6 +202,36 @@ void PairGayBerne::compute(int eflag, int vflag)
   if (vflag_fdotr) virial_fdotr_compute();
 }
 
+/* ----------------------------------------------------------------------
+   grow per-particle matrix cache to hold all owned and ghost particles
+------------------------------------------------------------------------- */
+
+void PairGayBerne::grow_cache()
+{
+  int nall = atom->nlocal + atom->nghost;
+  if (nall <= nmax) return;
+  nmax = atom->nmax;
+  wcache = (GBVars *)
+    memory->srealloc(wcache,nmax*sizeof(GBVars),"pair:wcache");
+}
+
+/* ----------------------------------------------------------------------
+   rotation, well depth and shape matrices of ellipsoid i
+------------------------------------------------------------------------- */
+
+void PairGayBerne::precompute_i(const int i, GBVars &ws)
+{
+  double temp[3][3];
+  int itype = atom->type[i];
+  AtomVecEllipsoid::Bonus *bonus = avec->bonus;
+
+  MathExtra::quat_to_mat_trans(bonus[atom->ellipsoid[i]].quat,ws.a);
+  MathExtra::diag_times3(well[itype],ws.a,temp);
+  MathExtra::transpose_times3(ws.a,temp,ws.b);
+  MathExtra::diag_times3(shape2[itype],ws.a,temp);
+  MathExtra::transpose_times3(ws.a,temp,ws.g);
+}
+
 /* ----------------------------------------------------------------------
    allocate all arrays
 ------------------------------------------------------------------------- */
@@ -907,3 +925,14 @@ void PairGayBerne::compute_eta_torque(double m[3][3], double m2[3][3],
                     2.0*m[1][1]*m2[2][2]*m[0][0]+m[2][1]*m[1][0]*m2[2][0]+
                     m[2][0]*m[0][1]*m2[2][1]-2.0*m2[2][2]*m[1][0]*m[0][1])/den;
 }
+
+/* ----------------------------------------------------------------------
+   memory usage of per-particle matrix cache
+------------------------------------------------------------------------- */
+
+double PairGayBerne::memory_usage()
+{
+  double bytes = Pair::memory_usage();
+  bytes += nmax * sizeof(GBVars);
+  return bytes;
+}
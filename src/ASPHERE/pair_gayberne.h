@@ -37,6 +37,7 @@ class PairGayBerne : public Pair {
   void read_restart(FILE *);
   void write_restart_settings(FILE *);
   void read_restart_settings(FILE *);
+  virtual double memory_usage();
 
  protected:
   enum{SPHERE_SPHERE,SPHERE_ELLIPSE,ELLIPSE_SPHERE,ELLIPSE_ELLIPSE};
@@ -57,7 +58,20 @@ class PairGayBerne : public Pair {
   int *setwell;
   class AtomVecEllipsoid *avec;
 
+  // per-particle matrices for Gay-Berne calculation
+
+  struct GBVars {
+    double a[3][3];     // rotation matrix (lab->body)
+    double b[3][3];     // A'*E*A, well depth matrix
+    double g[3][3];     // A'*S^2*A, shape matrix
+  };
+
+  GBVars *wcache;       // matrices of owned+ghost ellipsoids, once per step
+  int nmax;             // allocated size of wcache
+
   void allocate();
+  void grow_cache();
+  void precompute_i(const int i, GBVars &ws);
   double gayberne_analytic(const int i, const int j, double a1[3][3],
                            double a2[3][3], double b1[3][3], double b2[3][3],
                            double g1[3][3], double g2[3][3], double *r12,
@@ -45,6 +45,9 @@ PairRESquared::PairRESquared(LAMMPS *lmp) : Pair(lmp),
   b_alpha = 45.0/56.0;
   solv_f_a = 3.0/(16.0*atan(1.0)*-36.0);
   solv_f_r = 3.0/(16.0*atan(1.0)*2025.0);
+
+  nmax = 0;
+  wcache = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -72,6 +75,7 @@ PairRESquared::~PairRESquared()
     delete [] lshape;
     delete [] setwell;
   }
+  memory->sfree(wcache);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -82,7 +86,6 @@ void PairRESquared::compute(int eflag, int vflag)
   double evdwl,one_eng,rsq,r2inv,r6inv,forcelj,factor_lj;
   double fforce[3],ttor[3],rtor[3],r12[3];
   int *ilist,*jlist,*numneigh,**firstneigh;
-  RE2Vars wi,wj;
 
   evdwl = 0.0;
   if (eflag || vflag) ev_setup(eflag,vflag);
@@ -101,15 +104,20 @@ void PairRESquared::compute(int eflag, int vflag)
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // temporaries of each ellipsoid (not a LJ sphere) are computed once,
+  // not once per neighbor
+
+  int nall = nlocal + atom->nghost;
+  grow_cache();
+  for (i = 0; i < nall; i++)
+    if (lshape[type[i]] != 0.0) precompute_i(i,wcache[i]);
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
     itype = type[i];
-
-    // not a LJ sphere
-
-    if (lshape[itype] != 0.0) precompute_i(i,wi);
+    const RE2Vars &wi = wcache[i];
 
     jlist = firstneigh[i];
     jnum = numneigh[i];
@@ -148,14 +156,13 @@ void PairRESquared::compute(int eflag, int vflag)
           break;
 
          case SPHERE_ELLIPSE:
-          precompute_i(j,wj);
           if (newton_pair || j < nlocal) {
-            one_eng = resquared_lj(j,i,wj,r12,rsq,fforce,rtor,true);
+            one_eng = resquared_lj(j,i,wcache[j],r12,rsq,fforce,rtor,true);
             tor[j][0] += rtor[0]*factor_lj;
             tor[j][1] += rtor[1]*factor_lj;
             tor[j][2] += rtor[2]*factor_lj;
           } else
-            one_eng = resquared_lj(j,i,wj,r12,rsq,fforce,rtor,false);
+            one_eng = resquared_lj(j,i,wcache[j],r12,rsq,fforce,rtor,false);
           break;
 
          case ELLIPSE_SPHERE:
@@ -166,8 +173,8 @@ void PairRESquared::compute(int eflag, int vflag)
           break;
 
          default:
-          precompute_i(j,wj);
-          one_eng = resquared_analytic(i,j,wi,wj,r12,rsq,fforce,ttor,rtor);
+          one_eng = resquared_analytic(i,j,wi,wcache[j],r12,rsq,
+                                       fforce,ttor,rtor);
           tor[i][0] += ttor[0]*factor_lj;
           tor[i][1] += ttor[1]*factor_lj;
           tor[i][2] += ttor[2]*factor_lj;
@@ -204,6 +211,19 @@ void PairRESquared::compute(int eflag, int vflag)
   if (vflag_fdotr) virial_fdotr_compute();
 }
 
+/* ----------------------------------------------------------------------
+   grow per-particle temporaries to hold all owned and ghost particles
+------------------------------------------------------------------------- */
+
+void PairRESquared::grow_cache()
+{
+  int nall = atom->nlocal + atom->nghost;
+  if (nall <= nmax) return;
+  nmax = atom->nmax;
+  wcache = (RE2Vars *)
+    memory->srealloc(wcache,nmax*sizeof(RE2Vars),"pair:wcache");
+}
+
 /* ----------------------------------------------------------------------
    allocate all arrays
 ------------------------------------------------------------------------- */
@@ -988,3 +1008,14 @@ double PairRESquared::resquared_lj(const int i, const int j,
 
   return Ua+Ur;
 }
+
+/* ----------------------------------------------------------------------
+   memory usage of per-particle temporaries
+------------------------------------------------------------------------- */
+
+double PairRESquared::memory_usage()
+{
+  double bytes = Pair::memory_usage();
+  bytes += nmax * sizeof(RE2Vars);
+  return bytes;
+}
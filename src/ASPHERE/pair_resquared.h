@@ -37,6 +37,7 @@ class PairRESquared : public Pair {
   void read_restart(FILE *);
   void write_restart_settings(FILE *);
   void read_restart_settings(FILE *);
+  virtual double memory_usage();
 
  protected:
   enum{SPHERE_SPHERE,SPHERE_ELLIPSE,ELLIPSE_SPHERE,ELLIPSE_ELLIPSE};
@@ -73,7 +74,11 @@ class PairRESquared : public Pair {
     double lAsa[3][3][3];  // lAtwo+lA'*sa
   };
 
+  RE2Vars *wcache;      // temporaries of owned+ghost ellipsoids, once per step
+  int nmax;             // allocated size of wcache
+
   void allocate();
+  void grow_cache();
 
   void precompute_i(const int i,RE2Vars &ws);
   double det_prime(const double m[3][3], const double m2[3][3]);
@@ -443,6 +443,7 @@ void FixPour::pre_exchange()
 
   int nfix = modify->nfix;
   Fix **fix = modify->fix;
+  int nlocal_previous = atom->nlocal;
 
   for (i = nprevious; i < nnear; i++) {
     coord[0] = xnear[i][0];
@@ -473,6 +474,7 @@ void FixPour::pre_exchange()
              coord[0] >= sublo[0] && coord[0] < subhi[0]) flag = 1;
 
     if (flag) {
+      atom->map_drop_ghost();
       avec->create_atom(ntype,coord);
       m = atom->nlocal - 1;
       atom->type[m] = ntype;
@@ -489,18 +491,14 @@ void FixPour::pre_exchange()
 
   // reset global natoms
   // set tag # of new particles beyond all previous atoms
-  // if global map exists, reset it now instead of waiting for comm
-  // since deleting atoms messes up ghosts
+  // if global map exists, add new particles to it now,
+  //   they took the slots of ghost atoms that were removed from the map
 
   if (nnear - nprevious > 0) {
     atom->natoms += nnear - nprevious;
     if (atom->tag_enable) {
       atom->tag_extend();
-      if (atom->map_style) {
-        atom->nghost = 0;
-        atom->map_init();
-        atom->map_set();
-      }
+      atom->map_new_owned(nlocal_previous);
     }
   }
 
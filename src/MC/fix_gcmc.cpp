@@ -32,6 +32,7 @@
 #include "random_park.h"
 #include "force.h"
 #include "pair.h"
+#include "neighbor.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -42,6 +43,10 @@ using namespace LAMMPS_NS;
 using namespace FixConst;
 using namespace MathConst;
 
+#define BIG 1.0e20
+#define SMALL 1.0e-6
+#define MAXBINDIM 100
+
 /* ---------------------------------------------------------------------- */
 
 FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
@@ -85,6 +90,7 @@ FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
   rotation_group = 0;
   rotation_groupbit = 0;
   rotation_inversegroupbit = 0;
+  overlap_cutoffsq = 0.0;
 
   // read options from end of input line
 
@@ -161,7 +167,16 @@ FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
   gcmc_nmax = 0;
   local_gas_list = NULL;
 
+  atom_coord = NULL;
+  model_atom_buf = NULL;
+  model_nspecial = NULL;
+  model_special = NULL;
   model_atom = NULL;
+
+  nbinx = nbiny = nbinz = 0;
+  maxbin = maxnext = 0;
+  binhead = NULL;
+  binnext = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -195,6 +210,12 @@ void FixGCMC::options(int narg, char **arg)
       max_rotation_angle = atof(arg[iarg+1]);
       max_rotation_angle *= MY_PI/180;
       iarg += 2;
+    } else if (strcmp(arg[iarg],"overlap_cutoff") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix GCMC command");
+      double overlap_cutoff = atof(arg[iarg+1]);
+      if (overlap_cutoff < 0.0) error->all(FLERR,"Illegal fix GCMC command");
+      overlap_cutoffsq = overlap_cutoff*overlap_cutoff;
+      iarg += 2;
     } else error->all(FLERR,"Illegal fix GCMC command");
   }
 }
@@ -208,7 +229,11 @@ FixGCMC::~FixGCMC()
   memory->destroy(local_gas_list);
   memory->destroy(atom_coord);
   memory->destroy(model_atom_buf);
+  memory->destroy(model_nspecial);
+  memory->destroy(model_special);
   delete model_atom;
+  memory->destroy(binhead);
+  memory->destroy(binnext);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -296,9 +321,35 @@ void FixGCMC::init()
     
   // get all of the needed molecule data if molflag, 
   // otherwise just get the gas mass
-  
-  if (molflag) get_model_molecule();
-  else gas_mass = atom->mass[ngcmc_type];
+  // template is only extracted on the first run,
+  //   so the template molecule may be deleted after that
+
+  if (molflag) {
+    if (model_atom == NULL) get_model_molecule();
+
+    // maxmol = largest molecule tag across all existing atoms
+
+    maxmol = 0;
+    for (int i = 0; i < atom->nlocal; i++) 
+      maxmol = MAX(atom->molecule[i],maxmol);
+    int maxmol_all;
+    MPI_Allreduce(&maxmol,&maxmol_all,1,MPI_INT,MPI_MAX,world);
+    maxmol = maxmol_all;
+
+    // a rotated atom can move by up to twice the template radius,
+    //   energy() only sees its new neighbors if they are ghost atoms
+
+    double cutneed = force->pair->cutforce +
+      MAX(2.0*model_radius,displace);
+    double cutghost = MAX(force->pair->cutforce + neighbor->skin,
+                          comm->cutghostuser);
+    if (comm->nprocs > 1 && cutghost < cutneed && comm->me == 0) {
+      char str[128];
+      sprintf(str,"Fix GCMC molecule moves require a comm ghost cutoff "
+              "of %g to include all interactions",cutneed);
+      error->warning(FLERR,str);
+    }
+  } else gas_mass = atom->mass[ngcmc_type];
   
   if (gas_mass <= 0.0)
     error->all(FLERR,"Illegal fix GCMC gas mass <= 0");
@@ -358,7 +409,10 @@ void FixGCMC::pre_exchange()
   if (regionflag) volume = region_volume;
   else volume = domain->xprd * domain->yprd * domain->zprd;
 
-  update_gas_atoms_list();
+  // pre_exchange() is called before the forward comm of a reneighbor step,
+  //   so ghost atoms still have the positions of the previous step
+
+  update_ghosts();
 
   if (molflag) {
     for (int i = 0; i < ncycles; i++) {
@@ -418,8 +472,10 @@ void FixGCMC::attempt_atomic_translation()
     coord[0] = x[i][0] + displace*rx;
     coord[1] = x[i][1] + displace*ry;
     coord[2] = x[i][2] + displace*rz;
+    overlap_flag = 0;
     double energy_after = energy(i,ngcmc_type,-1,coord);
-    if (random_unequal->uniform() < exp(-beta*(energy_after - energy_before))) {
+    if (!overlap_flag && 
+        random_unequal->uniform() < exp(-beta*(energy_after - energy_before))) {
       x[i][0] = coord[0];
       x[i][1] = coord[1];
       x[i][2] = coord[2];
@@ -431,8 +487,7 @@ void FixGCMC::attempt_atomic_translation()
   MPI_Allreduce(&success,&success_all,1,MPI_INT,MPI_MAX,world);
 
   if (success_all) {
-    comm->borders();
-    update_gas_atoms_list();
+    update_ghosts();
     ntranslation_successes += 1.0;
   }
 }
@@ -454,8 +509,7 @@ void FixGCMC::attempt_atomic_deletion()
   if (i >= 0) {
     double deletion_energy = energy(i,ngcmc_type,-1,atom->x[i]);
     if (random_unequal->uniform() < ngas*exp(beta*deletion_energy)/(zz*volume)) {
-      atom->avec->copy(atom->nlocal-1,i,1);
-      atom->nlocal--;
+      atom->delete_owned(i);
       success = 1;
     }
   }
@@ -464,12 +518,8 @@ void FixGCMC::attempt_atomic_deletion()
   MPI_Allreduce(&success,&success_all,1,MPI_INT,MPI_MAX,world);
 
   if (success_all) {
-    if (atom->tag_enable) {
-      atom->natoms--;
-      if (atom->map_style) atom->map_init();
-    }
-    comm->borders();
-    update_gas_atoms_list();
+    if (atom->tag_enable) atom->natoms--;
+    update_ghosts();
     ndeletion_successes += 1.0;
   }
 }
@@ -507,9 +557,11 @@ void FixGCMC::attempt_atomic_insertion()
 
   int success = 0;
   if (proc_flag) {
+    overlap_flag = 0;
     double insertion_energy = energy(-1,ngcmc_type,-1,coord);
-    if (random_unequal->uniform() <
+    if (!overlap_flag && random_unequal->uniform() <
         zz*volume*exp(-beta*insertion_energy)/(ngas+1)) {
+      atom->map_drop_ghost();
       atom->avec->create_atom(ngcmc_type,coord);
       int m = atom->nlocal - 1;
       atom->mask[m] = 1 | groupbit;
@@ -533,10 +585,9 @@ void FixGCMC::attempt_atomic_insertion()
     if (atom->tag_enable) {
       atom->natoms++;
       atom->tag_extend();
-      if (atom->map_style) atom->map_init();
+      if (success) atom->map_new_owned(atom->nlocal-1);
     }
-    comm->borders();
-    update_gas_atoms_list();
+    update_ghosts();
     ninsertion_successes += 1.0;
   }
 }
@@ -572,17 +623,20 @@ void FixGCMC::attempt_molecule_translation()
   com_displace[2] = displace*rz;
 
   double energy_after = 0.0;
+  overlap_flag = 0;
   for (int i = 0; i < atom->nlocal; i++) {
     if (atom->molecule[i] == translation_molecule) {
       coord[0] = x[i][0] + com_displace[0];
       coord[1] = x[i][1] + com_displace[1];
       coord[2] = x[i][2] + com_displace[2];
       energy_after += energy(i,atom->type[i],translation_molecule,coord);
+      if (overlap_flag) break;
     }
   }
 
-  double energy_after_sum = 0.0;
-  MPI_Allreduce(&energy_after,&energy_after_sum,1,MPI_DOUBLE,MPI_SUM,world);
+  double energy_after_sum,overlap_sum;
+  sum_energy_overlap(energy_after,energy_after_sum,overlap_sum);
+  if (overlap_sum > 0.0) return;
 
   if (random_equal->uniform() < exp(-beta*(energy_after_sum - energy_before_sum))) {
     for (int i = 0; i < atom->nlocal; i++) {
@@ -592,8 +646,7 @@ void FixGCMC::attempt_molecule_translation()
         x[i][2] += com_displace[2];
       }
     }
-    comm->borders();
-    update_gas_atoms_list();
+    update_ghosts();
     ntranslation_successes += 1.0;
   }
 }
@@ -634,28 +687,34 @@ void FixGCMC::attempt_molecule_rotation()
   double **x = atom->x;
   tagint *image = atom->image;
   double energy_after = 0.0;
+  overlap_flag = 0;
   int n = 0;
   for (int i = 0; i < nlocal; i++) {
     if (mask[i] & rotation_groupbit) {
-      double xtmp[3];
-      domain->unmap(x[i],image[i],xtmp);
-      xtmp[0] -= com[0];
-      xtmp[1] -= com[1];
-      xtmp[2] -= com[2];
+      double xtmp[3],xold[3];
+      domain->unmap(x[i],image[i],xold);
+      xtmp[0] = xold[0] - com[0];
+      xtmp[1] = xold[1] - com[1];
+      xtmp[2] = xold[2] - com[2];
       atom_coord[n][0] = rot[0]*xtmp[0] + rot[1]*xtmp[1] + rot[2]*xtmp[2] + com[0];
       atom_coord[n][1] = rot[3]*xtmp[0] + rot[4]*xtmp[1] + rot[5]*xtmp[2] + com[1];
       atom_coord[n][2] = rot[6]*xtmp[0] + rot[7]*xtmp[1] + rot[8]*xtmp[2] + com[2];
-      xtmp[0] = atom_coord[n][0];
-      xtmp[1] = atom_coord[n][1];
-      xtmp[2] = atom_coord[n][2];
-      domain->remap(xtmp);
-      energy_after += energy(i,atom->type[i],rotation_molecule,xtmp);
+
+      // evaluate energy at the rotated position closest to x[i],
+      //   not remapped into the box, so this proc's ghosts surround it
+
+      xtmp[0] = x[i][0] + atom_coord[n][0] - xold[0];
+      xtmp[1] = x[i][1] + atom_coord[n][1] - xold[1];
+      xtmp[2] = x[i][2] + atom_coord[n][2] - xold[2];
+      if (!overlap_flag)
+        energy_after += energy(i,atom->type[i],rotation_molecule,xtmp);
       n++;
     }
   }
 
-  double energy_after_sum = 0.0;
-  MPI_Allreduce(&energy_after,&energy_after_sum,1,MPI_DOUBLE,MPI_SUM,world);
+  double energy_after_sum,overlap_sum;
+  sum_energy_overlap(energy_after,energy_after_sum,overlap_sum);
+  if (overlap_sum > 0.0) return;
 
   if (random_equal->uniform() < exp(-beta*(energy_after_sum - energy_before_sum))) {
     int n = 0;
@@ -669,8 +728,7 @@ void FixGCMC::attempt_molecule_rotation()
         n++;
       }
     }
-    comm->borders();
-    update_gas_atoms_list();
+    update_ghosts();
     nrotation_successes += 1.0;
   }
 }
@@ -694,15 +752,11 @@ void FixGCMC::attempt_molecule_deletion()
   if (random_equal->uniform() < ngas*exp(beta*deletion_energy_sum)/(zz*volume)) {
     int i = 0;
     while (i < atom->nlocal) {
-      if (atom->molecule[i] == deletion_molecule) {
-        atom->avec->copy(atom->nlocal-1,i,1);
-        atom->nlocal--;
-      } else i++;
+      if (atom->molecule[i] == deletion_molecule) atom->delete_owned(i);
+      else i++;
     }
     atom->natoms -= natoms_per_molecule;
-    atom->map_init();
-    comm->borders();
-    update_gas_atoms_list();
+    update_ghosts();
     ndeletion_successes += 1.0;
   }
 }
@@ -740,8 +794,13 @@ void FixGCMC::attempt_molecule_insertion()
   double rot[9];
   get_rotation_matrix(MY_2PI,&rot[0]);
 
+  // evaluate the trial molecule as a virtual copy of the template,
+  //   no atoms are created unless the insertion is accepted
+  // stop summing energy as soon as an overlap is found
+
   double **model_x = model_atom->x;
   double insertion_energy = 0.0;
+  overlap_flag = 0;
   bool procflag[natoms_per_molecule];
   for (int i = 0; i < natoms_per_molecule; i++) {
     atom_coord[i][0] = rot[0]*model_x[i][0] + rot[1]*model_x[i][1] + rot[2]*model_x[i][2] + com_coord[0];
@@ -759,12 +818,14 @@ void FixGCMC::attempt_molecule_insertion()
         xtmp[1] >= sublo[1] && xtmp[1] < subhi[1] &&
         xtmp[2] >= sublo[2] && xtmp[2] < subhi[2]) {
       procflag[i] = true;
-      insertion_energy += energy(-1,model_atom->type[i],-1,xtmp);
+      if (!overlap_flag)
+        insertion_energy += energy(-1,model_atom->type[i],-1,xtmp);
     }
   }
 
-  double insertion_energy_sum = 0.0;
-  MPI_Allreduce(&insertion_energy,&insertion_energy_sum,1,MPI_DOUBLE,MPI_SUM,world);
+  double insertion_energy_sum,overlap_sum;
+  sum_energy_overlap(insertion_energy,insertion_energy_sum,overlap_sum);
+  if (overlap_sum > 0.0) return;
 
   if (random_equal->uniform() < zz*volume*exp(-beta*insertion_energy_sum)/(ngas+1)) {  
     maxmol++;
@@ -777,15 +838,26 @@ void FixGCMC::attempt_molecule_insertion()
     MPI_Allreduce(&maxtag,&maxtag_all,1,MPI_INT,MPI_MAX,world);
     int atom_offset = maxtag_all;
 
+    // new atom IDs are the same on all procs, grow the map to hold them
+    //   before they are added to it one at a time
+
+    atom->map_grow_array(atom_offset + natoms_per_molecule);
+
+    // only unpack template atoms this proc will own,
+    //   else skip them, 1st value of each packed atom is its length
+    // each new atom takes the slot of the 1st ghost atom
+    // unpack_restart() may grow the per-atom arrays,
+    //   so only access them after it is done
+
     int k = 0;
-    double **x = atom->x;
-    double **v = atom->v;
-    tagint *image = atom->image;
-    int *molecule = atom->molecule;
-    int *tag = atom->tag;
     for (int i = 0; i < natoms_per_molecule; i++) {
-      k += atom->avec->unpack_restart(&model_atom_buf[k]);
       if (procflag[i]) {
+        atom->map_drop_ghost();
+        k += atom->avec->unpack_restart(&model_atom_buf[k]);
+        double **x = atom->x;
+        double **v = atom->v;
+        tagint *image = atom->image;
+        int *tag = atom->tag;
         int m = atom->nlocal - 1;
         image[m] = imagetmp;
         x[m][0] = atom_coord[i][0];
@@ -821,24 +893,31 @@ void FixGCMC::attempt_molecule_insertion()
             atom->improper_atom3[m][j] += atom_offset;
             atom->improper_atom4[m][j] += atom_offset;
           }
+        if (model_nspecial) {
+          for (int j = 0; j < 3; j++)
+            atom->nspecial[m][j] = model_nspecial[i][j];
+          for (int j = 0; j < model_nspecial[i][2]; j++)
+            atom->special[m][j] = model_special[i][j] + atom_offset;
+        }
         
         int nfix = modify->nfix;
         Fix **fix = modify->fix;
         for (int j = 0; j < nfix; j++)
           if (fix[j]->create_attribute) fix[j]->set_arrays(m);
 
-      } else atom->nlocal--;
+        atom->map_new_owned(m);
+      } else k += static_cast<int> (model_atom_buf[k]);
     }
     atom->natoms += natoms_per_molecule;
-    atom->map_init();
-    comm->borders();
-    update_gas_atoms_list();
+    update_ghosts();
     ninsertion_successes += 1.0;
   }
 }
 
 /* ----------------------------------------------------------------------
    compute particle's interaction energy with the rest of the system
+   only loop over owned and ghost atoms in the 27 bins around coord
+   set overlap_flag and return if any atom is within overlap_cutoff
 ------------------------------------------------------------------------- */
 
 double FixGCMC::energy(int i, int itype, int imolecule, double *coord)
@@ -848,7 +927,6 @@ double FixGCMC::energy(int i, int itype, int imolecule, double *coord)
   double **x = atom->x;
   int *type = atom->type;
   int *molecule = atom->molecule;
-  int nall = atom->nlocal + atom->nghost;
   pair = force->pair;
   cutsq = force->pair->cutsq;
 
@@ -856,25 +934,123 @@ double FixGCMC::energy(int i, int itype, int imolecule, double *coord)
   double factor_coul = 1.0;
   double factor_lj = 1.0;
 
+  int ix = coord2bin(coord[0],0);
+  int iy = coord2bin(coord[1],1);
+  int iz = coord2bin(coord[2],2);
+  int kxlo = MAX(ix-1,0);
+  int kxhi = MIN(ix+1,nbinx-1);
+  int kylo = MAX(iy-1,0);
+  int kyhi = MIN(iy+1,nbiny-1);
+  int kzlo = MAX(iz-1,0);
+  int kzhi = MIN(iz+1,nbinz-1);
+
   double total_energy = 0.0;
-  for (int j = 0; j < nall; j++) {
+  for (int kz = kzlo; kz <= kzhi; kz++)
+    for (int ky = kylo; ky <= kyhi; ky++)
+      for (int kx = kxlo; kx <= kxhi; kx++) {
+        int ibin = (kz*nbiny + ky)*nbinx + kx;
+        for (int j = binhead[ibin]; j >= 0; j = binnext[j]) {
+
+          if (i == j) continue;
+          if (molflag)
+            if (imolecule == molecule[j]) continue;
+
+          delx = coord[0] - x[j][0];
+          dely = coord[1] - x[j][1];
+          delz = coord[2] - x[j][2];
+          rsq = delx*delx + dely*dely + delz*delz;
+          int jtype = type[j];
+
+          if (rsq < overlap_cutoffsq) {
+            overlap_flag = 1;
+            return 0.0;
+          }
 
-    if (i == j) continue;
-    if (molflag)
-      if (imolecule == molecule[j]) continue;
+          if (rsq < cutsq[itype][jtype])
+            total_energy +=
+              pair->single(i,j,itype,jtype,rsq,factor_coul,factor_lj,fpair);
+        }
+      }
 
-    delx = coord[0] - x[j][0];
-    dely = coord[1] - x[j][1];
-    delz = coord[2] - x[j][2];
-    rsq = delx*delx + dely*dely + delz*delz;
-    int jtype = type[j];
+  return total_energy;
+}
 
-    if (rsq < cutsq[itype][jtype])
-      total_energy +=
-        pair->single(i,j,itype,jtype,rsq,factor_coul,factor_lj,fpair);
+/* ----------------------------------------------------------------------
+   sum a trial energy and overlap flag across procs in one reduction
+------------------------------------------------------------------------- */
+
+void FixGCMC::sum_energy_overlap(double energy_local, double &energy_sum,
+                                 double &overlap_sum)
+{
+  double one[2],all[2];
+  one[0] = energy_local;
+  one[1] = overlap_flag;
+  MPI_Allreduce(one,all,2,MPI_DOUBLE,MPI_SUM,world);
+  energy_sum = all[0];
+  overlap_sum = all[1];
+}
+
+/* ----------------------------------------------------------------------
+   bin owned and ghost atoms into cells at least as large as the
+   largest pair cutoff, so energy() only visits nearby atoms
+   must be redone whenever atoms move or ghost atoms are re-acquired
+------------------------------------------------------------------------- */
+
+void FixGCMC::bin_atoms()
+{
+  double **x = atom->x;
+  int nall = atom->nlocal + atom->nghost;
+
+  // bounding box of owned and ghost atoms
+
+  double lo[3],hi[3];
+  lo[0] = lo[1] = lo[2] = BIG;
+  hi[0] = hi[1] = hi[2] = -BIG;
+  for (int i = 0; i < nall; i++)
+    for (int k = 0; k < 3; k++) {
+      lo[k] = MIN(lo[k],x[i][k]);
+      hi[k] = MAX(hi[k],x[i][k]);
+    }
+  if (nall == 0) lo[0] = lo[1] = lo[2] = hi[0] = hi[1] = hi[2] = 0.0;
+
+  double binsize = force->pair->cutforce;
+  if (binsize <= 0.0) binsize = BIG;
+
+  int nbin[3];
+  for (int k = 0; k < 3; k++) {
+    double extent = hi[k] - lo[k];
+    nbin[k] = static_cast<int> (extent/binsize);
+    if (nbin[k] < 1) nbin[k] = 1;
+    if (nbin[k] > MAXBINDIM) nbin[k] = MAXBINDIM;
+    binlo[k] = lo[k];
+    bininv[k] = nbin[k]/MAX(extent,SMALL);
+  }
+  nbinx = nbin[0];
+  nbiny = nbin[1];
+  nbinz = nbin[2];
+
+  int nbins = nbinx*nbiny*nbinz;
+  if (nbins > maxbin) {
+    maxbin = nbins;
+    memory->destroy(binhead);
+    memory->create(binhead,maxbin,"GCMC:binhead");
+  }
+  if (atom->nmax > maxnext) {
+    maxnext = atom->nmax;
+    memory->destroy(binnext);
+    memory->create(binnext,maxnext,"GCMC:binnext");
   }
 
-  return total_energy;
+  for (int m = 0; m < nbins; m++) binhead[m] = -1;
+
+  // add atoms in reverse order so each bin lists them in ascending order
+
+  for (int i = nall-1; i >= 0; i--) {
+    int ibin = (coord2bin(x[i][2],2)*nbiny + coord2bin(x[i][1],1))*nbinx +
+      coord2bin(x[i][0],0);
+    binnext[i] = binhead[ibin];
+    binhead[ibin] = i;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -1046,16 +1222,6 @@ void FixGCMC::get_model_molecule()
   
   memory->create(atom_coord,natoms_per_molecule,3,"fixGCMC:atom_coord");
 
-  // maxmol = largest molecule tag across all existing atoms
-
-  maxmol = 0;
-  if (atom->molecular) {
-    for (int i = 0; i < atom->nlocal; i++) maxmol = MAX(atom->molecule[i],maxmol);
-    int maxmol_all;
-    MPI_Allreduce(&maxmol,&maxmol_all,1,MPI_INT,MPI_MAX,world);
-    maxmol = maxmol_all;
-  }
-
   // communication buffer for model atom's info
   // max_size = largest buffer needed by any proc
   // must do before new Atom class created,
@@ -1120,13 +1286,35 @@ void FixGCMC::get_model_molecule()
   AtomVec *old_avec = old_atom->avec;
   AtomVec *model_avec = atom->avec;
 
+  // special neighbors are not part of the restart info,
+  //   so also pack them into ibuf, in the same atom order
+
+  int maxspecial = 0;
+  int *ibuf = NULL;
+  if (old_atom->molecular) {
+    maxspecial = old_atom->maxspecial;
+    memory->create(model_nspecial,natoms_per_molecule,3,
+                   "fixGCMC:model_nspecial");
+    memory->create(model_special,natoms_per_molecule,maxspecial,
+                   "fixGCMC:model_special");
+    memory->create(ibuf,natoms_per_molecule*(3+maxspecial),"fixGCMC:ibuf");
+  }
+
   int model_buf_size = 0;
+  int nmodel = 0;
   for (int iproc = 0; iproc < comm->nprocs; iproc++) {
     int nbuf_iproc = 0;
+    int nibuf_iproc = 0;
     if (comm->me == iproc) {
       for (int i = 0; i < old_atom->nlocal; i++) {
         if (old_atom->molecule[i] == model_molecule_number) {
           nbuf_iproc += old_avec->pack_restart(i,&buf[nbuf_iproc]);
+          if (ibuf) {
+            for (int k = 0; k < 3; k++)
+              ibuf[nibuf_iproc++] = old_atom->nspecial[i][k];
+            for (int k = 0; k < old_atom->nspecial[i][2]; k++)
+              ibuf[nibuf_iproc++] = old_atom->special[i][k];
+          }
         }
       }
     }
@@ -1138,11 +1326,24 @@ void FixGCMC::get_model_molecule()
     int m = 0;
     while (m < nbuf_iproc)
       m += model_avec->unpack_restart(&buf[m]);
+
+    if (ibuf) {
+      MPI_Bcast(&nibuf_iproc,1,MPI_INT,iproc,world);
+      MPI_Bcast(ibuf,nibuf_iproc,MPI_INT,iproc,world);
+      m = 0;
+      while (m < nibuf_iproc) {
+        for (int k = 0; k < 3; k++) model_nspecial[nmodel][k] = ibuf[m++];
+        for (int k = 0; k < model_nspecial[nmodel][2]; k++)
+          model_special[nmodel][k] = ibuf[m++];
+        nmodel++;
+      }
+    }
   }
 
-  // free communication buffer 
+  // free communication buffers
 
   memory->destroy(buf);
+  memory->destroy(ibuf);
   
   // make sure that the number of model atoms is equal to the number of atoms per gas molecule
   
@@ -1152,17 +1353,24 @@ void FixGCMC::get_model_molecule()
   
   // compute the model molecule's mass and center-of-mass
   // then recenter model molecule on the origin
+  // every proc stores the whole model molecule,
+  //   so group sums over procs count each model atom nprocs times
 
-  double com[3]; 
-  gas_mass = group->mass(0);
-  group->xcm(0,gas_mass,com);
+  double com[3];
+  double masstotal = group->mass(0);
+  group->xcm(0,masstotal,com);
+  gas_mass = masstotal/comm->nprocs;
 
   double **x = atom->x;  
+  model_radius = 0.0;
   for (int i = 0; i < nlocal; i++) {
     domain->unmap(x[i],atom->image[i]);
     x[i][0] -= com[0];
     x[i][1] -= com[1];
     x[i][2] -= com[2];
+    model_radius = MAX(model_radius,
+                       sqrt(x[i][0]*x[i][0] + x[i][1]*x[i][1] +
+                            x[i][2]*x[i][2]));
   }
 
   int mintag = atom->tag[0];
@@ -1172,6 +1380,9 @@ void FixGCMC::get_model_molecule()
   for (int i = 0; i < nlocal; i++) {
     atom->mask[i] = 1 | groupbit;
     atom->tag[i] -= atom_offset;
+    if (model_nspecial)
+      for (int j = 0; j < model_nspecial[i][2]; j++)
+        model_special[i][j] -= atom_offset;
     if (atom->avec->bonds_allow)
       for (int j = 0; j < atom->num_bond[i]; j++)
         atom->bond_atom[i][j] -= atom_offset;
@@ -1210,6 +1421,22 @@ void FixGCMC::get_model_molecule()
   atom = old_atom;
 }
 
+/* ----------------------------------------------------------------------
+   migrate moved atoms and re-acquire ghost atoms after an accepted move,
+     insertion, or deletion, same as Verlet does on a reneighbor step
+   owned atoms added or removed have already updated the map incrementally
+   then refresh the gas atom list and the cell list used by energy()
+------------------------------------------------------------------------- */
+
+void FixGCMC::update_ghosts()
+{
+  domain->pbc();
+  comm->exchange();
+  comm->borders();
+  update_gas_atoms_list();
+  bin_atoms();
+}
+
 /* ----------------------------------------------------------------------
    update the list of gas atoms
 ------------------------------------------------------------------------- */
@@ -46,8 +46,10 @@ class FixGCMC : public Fix {
   int pick_random_gas_molecule_in_region();
   double molecule_energy(int);
   void get_rotation_matrix(double, double *);
+  void bin_atoms();
   void get_model_molecule();
   void update_gas_atoms_list();
+  void update_ghosts();
   double compute_vector(int);
   double memory_usage();
   void write_restart(FILE *);
@@ -94,8 +96,19 @@ class FixGCMC : public Fix {
   double **cutsq;
   double **atom_coord;
   double *model_atom_buf;
+  int **model_nspecial;     // special neighbors of model molecule atoms
+  int **model_special;
+  double model_radius;      // max distance of model atom from its COM
   tagint imagetmp;
 
+  double overlap_cutoffsq;  // insertions/moves closer than this are rejected
+  int overlap_flag;         // 1 if energy() found an overlap
+
+  int nbinx,nbiny,nbinz;    // cell list of owned+ghost atoms for energy()
+  int maxbin,maxnext;
+  int *binhead,*binnext;
+  double binlo[3],bininv[3];
+
   class Pair *pair;
 
   class RanPark *random_equal;
@@ -104,6 +117,17 @@ class FixGCMC : public Fix {
   class Atom *model_atom;
 
   void options(int, char **);
+  void sum_energy_overlap(double, double &, double &);
+
+  // bin index of coord in dimension dim, clamped to the cell list
+
+  inline int coord2bin(double coord, int dim) {
+    int nbin = (dim == 0) ? nbinx : ((dim == 1) ? nbiny : nbinz);
+    int ibin = static_cast<int> ((coord - binlo[dim])*bininv[dim]);
+    if (ibin < 0) return 0;
+    if (ibin >= nbin) return nbin-1;
+    return ibin;
+  };
 };
 
 }
@@ -190,6 +214,14 @@ Fix GCMC will ignore the fix group specified by the user. User should
 set the fix group to "all". Fix GCMC will overwrite the user-specified
 fix group with a group consisting of all GCMC gas atoms.
 
+W: Fix GCMC molecule moves require a comm ghost cutoff of %g to include all interactions
+
+Rotating a molecule can move its atoms further than the neighbor skin
+distance.  The energy of the moved atoms is computed from the owned
+and ghost atoms of the processor that owns them, so the ghost cutoff
+must be large enough to include all of their new neighbors.  Use the
+communicate cutoff command to set it.
+
 E: Fix GCMC region does not support a bounding box 
  
 Not all regions represent bounded volumes.  You cannot use 
@@ -21,6 +21,11 @@ if (test $1 = 1) then
     cp pair_lj_cut_tip4p_long_opt.h ..
   fi
 
+  if (test -e ../pair_lj_cut_coul_long_polarization.cpp) then
+    cp pair_lj_cut_coul_long_polarization_opt.cpp ..
+    cp pair_lj_cut_coul_long_polarization_opt.h ..
+  fi
+
   cp pair_lj_cut_opt.cpp ..
   cp pair_lj_cut_opt.h ..
 
@@ -35,6 +40,7 @@ elif (test $1 = 0) then
   rm -f ../pair_lj_charmm_coul_long_opt.cpp
   rm -f ../pair_lj_cut_coul_long_opt.cpp
   rm -f ../pair_lj_cut_tip4p_long_opt.cpp
+  rm -f ../pair_lj_cut_coul_long_polarization_opt.cpp
   rm -f ../pair_lj_cut_opt.cpp
   rm -f ../pair_morse_opt.cpp
 
@@ -44,6 +50,7 @@ elif (test $1 = 0) then
   rm -f ../pair_lj_charmm_coul_long_opt.h
   rm -f ../pair_lj_cut_coul_long_opt.h
   rm -f ../pair_lj_cut_tip4p_long_opt.h
+  rm -f ../pair_lj_cut_coul_long_polarization_opt.h
   rm -f ../pair_lj_cut_opt.h
   rm -f ../pair_morse_opt.h
 
@@ -0,0 +1,546 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "float.h"
+#include "pair_lj_cut_coul_long_polarization_opt.h"
+#include "atom.h"
+#include "force.h"
+#include "domain.h"
+#include "neigh_list.h"
+
+using namespace LAMMPS_NS;
+
+#define EWALD_F   1.12837917
+#define EWALD_P   0.3275911
+#define A1        0.254829592
+#define A2       -0.284496736
+#define A3        1.421413741
+#define A4       -1.453152027
+#define A5        1.061405429
+
+enum{DAMPING_EXPONENTIAL,DAMPING_NONE};
+
+/* ---------------------------------------------------------------------- */
+
+PairLJCutCoulLongPolarizationOpt::PairLJCutCoulLongPolarizationOpt(LAMMPS *lmp) :
+  PairLJCutCoulLongPolarization(lmp)
+{
+  respa_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairLJCutCoulLongPolarizationOpt::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = vflag_fdotr = 0;
+
+  if (!ncoultablebits) {
+    if (evflag) {
+      if (eflag) {
+        if (force->newton_pair) eval<1,1,1,0>();
+        else eval<1,1,0,0>();
+      } else {
+        if (force->newton_pair) eval<1,0,1,0>();
+        else eval<1,0,0,0>();
+      }
+    } else {
+      if (force->newton_pair) eval<0,0,1,0>();
+      else eval<0,0,0,0>();
+    }
+  } else {
+    if (evflag) {
+      if (eflag) {
+        if (force->newton_pair) eval<1,1,1,1>();
+        else eval<1,1,0,1>();
+      } else {
+        if (force->newton_pair) eval<1,0,1,1>();
+        else eval<1,0,0,1>();
+      }
+    } else {
+      if (force->newton_pair) eval<0,0,1,1>();
+      else eval<0,0,0,1>();
+    }
+  }
+
+  // induced dipoles on top of the pairwise forces
+
+  polar_compute(eflag);
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template < const int EVFLAG, const int EFLAG,
+           const int NEWTON_PAIR, const int CTABLE >
+void PairLJCutCoulLongPolarizationOpt::eval()
+{
+  int i,ii,j,jj,inum,jnum,itype,jtype,itable;
+  double qtmp,xtmp,ytmp,ztmp,delx,dely,delz,evdwl,ecoul,fpair;
+  double fraction,table;
+  double r,r2inv,r6inv,forcecoul,forcelj,factor_coul,factor_lj;
+  double grij,expm2,prefactor,t,erfc;
+  int *ilist,*jlist,*numneigh,**firstneigh;
+  double rsq;
+
+  evdwl = ecoul = 0.0;
+
+  double **x = atom->x;
+  double **f = atom->f;
+  double *q = atom->q;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  double *special_coul = force->special_coul;
+  double *special_lj = force->special_lj;
+  double qqrd2e = force->qqrd2e;
+  double fxtmp,fytmp,fztmp;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // loop over neighbors of my atoms
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    qtmp = q[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    fxtmp = fytmp = fztmp = 0.0;
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      factor_lj = special_lj[sbmask(j)];
+      factor_coul = special_coul[sbmask(j)];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      jtype = type[j];
+
+      if (rsq < cutsq[itype][jtype]) {
+        r2inv = 1.0/rsq;
+
+        if (rsq < cut_coulsq) {
+          if (!CTABLE || rsq <= tabinnersq) {
+            r = sqrt(rsq);
+            grij = g_ewald * r;
+            expm2 = exp(-grij*grij);
+            t = 1.0 / (1.0 + EWALD_P*grij);
+            erfc = t * (A1+t*(A2+t*(A3+t*(A4+t*A5)))) * expm2;
+            prefactor = qqrd2e * qtmp*q[j]/r;
+            forcecoul = prefactor * (erfc + EWALD_F*grij*expm2);
+            if (factor_coul < 1.0) forcecoul -= (1.0-factor_coul)*prefactor;
+          } else {
+            union_int_float_t rsq_lookup;
+            rsq_lookup.f = rsq;
+            itable = rsq_lookup.i & ncoulmask;
+            itable >>= ncoulshiftbits;
+            fraction = (rsq_lookup.f - rtable[itable]) * drtable[itable];
+            table = ftable[itable] + fraction*dftable[itable];
+            forcecoul = qtmp*q[j] * table;
+            if (factor_coul < 1.0) {
+              table = ctable[itable] + fraction*dctable[itable];
+              prefactor = qtmp*q[j] * table;
+              forcecoul -= (1.0-factor_coul)*prefactor;
+            }
+          }
+        } else forcecoul = 0.0;
+
+        if (rsq < cut_ljsq[itype][jtype]) {
+          r6inv = r2inv*r2inv*r2inv;
+          forcelj = r6inv * (lj1[itype][jtype]*r6inv - lj2[itype][jtype]);
+        } else forcelj = 0.0;
+
+        fpair = (forcecoul + factor_lj*forcelj) * r2inv;
+
+        fxtmp += delx*fpair;
+        fytmp += dely*fpair;
+        fztmp += delz*fpair;
+        if (NEWTON_PAIR || j < nlocal) {
+          f[j][0] -= delx*fpair;
+          f[j][1] -= dely*fpair;
+          f[j][2] -= delz*fpair;
+        }
+
+        if (EFLAG) {
+          if (rsq < cut_coulsq) {
+            if (!CTABLE || rsq <= tabinnersq)
+              ecoul = prefactor*erfc;
+            else {
+              table = etable[itable] + fraction*detable[itable];
+              ecoul = qtmp*q[j] * table;
+            }
+            if (factor_coul < 1.0) ecoul -= (1.0-factor_coul)*prefactor;
+          } else ecoul = 0.0;
+
+          if (rsq < cut_ljsq[itype][jtype]) {
+            evdwl = r6inv*(lj3[itype][jtype]*r6inv-lj4[itype][jtype]) -
+              offset[itype][jtype];
+            evdwl *= factor_lj;
+          } else evdwl = 0.0;
+        }
+
+        if (EVFLAG) ev_tally(i,j,nlocal,NEWTON_PAIR,
+                             evdwl,ecoul,fpair,delx,dely,delz);
+      }
+    }
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   static field without the checks for a frozen group in the pair loop
+------------------------------------------------------------------------- */
+
+void PairLJCutCoulLongPolarizationOpt::static_field_wolf()
+{
+  if (frozen_group >= 0) {
+    PairPolarization::static_field_wolf();
+    return;
+  }
+
+  int i,j,moli;
+  double qtmp,xtmp,ytmp,ztmp,delx,dely,delz,rsq,r,ef_temp;
+  double efx,efy,efz;
+  double xjimage[3];
+
+  double **x = atom->x;
+  double *q = atom->q;
+  int *molecule = atom->molecule;
+  double **ef_static = atom->ef_static;
+  int nlocal = atom->nlocal;
+  double f_shift = -1.0/(cut_coul*cut_coul);
+
+  for (i = 0; i < nlocal; i++)
+    ef_static[i][0] = ef_static[i][1] = ef_static[i][2] = 0.0;
+
+  for (i = 0; i < nlocal; i++) {
+    qtmp = q[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    moli = molecule[i];
+    efx = efy = efz = 0.0;
+
+    for (j = i+1; j < nlocal; j++) {
+      if (molecule[j] == moli && moli != 0) continue;
+      domain->closest_image(x[i],x[j],xjimage);
+      delx = xtmp - xjimage[0];
+      dely = ytmp - xjimage[1];
+      delz = ztmp - xjimage[2];
+      rsq = delx*delx + dely*dely + delz*delz;
+
+      if (rsq <= cut_coulsq) {
+        r = sqrt(rsq);
+        ef_temp = (1.0/rsq + f_shift)*1.0/r;
+        efx += ef_temp*q[j]*delx;
+        efy += ef_temp*q[j]*dely;
+        efz += ef_temp*q[j]*delz;
+        ef_static[j][0] -= ef_temp*qtmp*delx;
+        ef_static[j][1] -= ef_temp*qtmp*dely;
+        ef_static[j][2] -= ef_temp*qtmp*delz;
+      }
+    }
+    ef_static[i][0] += efx;
+    ef_static[i][1] += efy;
+    ef_static[i][2] += efz;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairLJCutCoulLongPolarizationOpt::build_dipole_field_matrix()
+{
+  if (damping_type == DAMPING_EXPONENTIAL) build_matrix_eval<1>();
+  else build_matrix_eval<0>();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template < const int DAMPING >
+void PairLJCutCoulLongPolarizationOpt::build_matrix_eval()
+{
+  int N = npolar;
+  double **x = atom->x;
+  double *static_polarizability = atom->static_polarizability;
+  int i,j,k,l,ii,jj,p,q;
+  double r,r2,r3,r5,e,damping_term1,damping_term2;
+  double del[3],xjimage[3];
+  double damp = polar_damp;
+  double damp2 = damp*damp;
+  double damp3 = damp2*damp;
+
+  // the leading block of the frozen atoms is kept if still current
+
+  int nf = frozen_tensor_valid ? nfrozen : 0;
+  double **T = dipole_field_matrix;
+
+  for (i = 0; i < 3*N; i++)
+    for (j = (i < 3*nf ? 3*nf : 0); j < 3*N; j++)
+      T[i][j] = 0.0;
+
+  for (k = nf; k < N; k++) {
+    ii = k*3;
+    i = polar_list[k];
+    for (p = 0; p < 3; p++)
+      T[ii+p][ii+p] = 1.0/static_polarizability[i];
+  }
+
+  damping_term1 = damping_term2 = 1.0;
+
+  for (k = 0; k < (N - 1); k++) {
+    ii = k*3;
+    i = polar_list[k];
+    for (l = (k < nf ? nf : k + 1); l < N; l++) {
+      jj = l*3;
+      j = polar_list[l];
+
+      domain->closest_image(x[i],x[j],xjimage);
+      del[0] = x[i][0] - xjimage[0];
+      del[1] = x[i][1] - xjimage[1];
+      del[2] = x[i][2] - xjimage[2];
+      r2 = del[0]*del[0] + del[1]*del[1] + del[2]*del[2];
+
+      r = sqrt(r2);
+      if (r == 0.0) r3 = r5 = DBL_MAX;
+      else {
+        r3 = 1.0/(r*r*r);
+        r5 = 1.0/(r*r*r*r*r);
+      }
+
+      if (DAMPING) {
+        e = exp(-damp*r);
+        damping_term1 = 1.0 - e*(0.5*damp2*r2 + damp*r + 1.0);
+        damping_term2 = 1.0 - e*(damp3*r2*r/6.0 + 0.5*damp2*r2 + damp*r + 1.0);
+      }
+
+      for (p = 0; p < 3; p++) {
+        for (q = 0; q < 3; q++)
+          T[ii+p][jj+q] = T[jj+q][ii+p] = -3.0*del[p]*del[q]*damping_term2*r5;
+        T[ii+p][jj+p] += damping_term1*r3;
+        T[jj+p][ii+p] = T[ii+p][jj+p];
+      }
+    }
+  }
+
+  if (frozen_group >= 0) frozen_tensor_valid = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairLJCutCoulLongPolarizationOpt::polar_forces(int eflag,
+                                                    double &u_polar_self,
+                                                    double &u_polar_ef,
+                                                    double &u_polar_dd)
+{
+  if (damping_type == DAMPING_EXPONENTIAL) {
+    if (evflag) {
+      if (eflag) polar_forces_eval<1,1,1>(u_polar_self,u_polar_ef,u_polar_dd);
+      else polar_forces_eval<1,0,1>(u_polar_self,u_polar_ef,u_polar_dd);
+    } else polar_forces_eval<0,0,1>(u_polar_self,u_polar_ef,u_polar_dd);
+  } else {
+    if (evflag) {
+      if (eflag) polar_forces_eval<1,1,0>(u_polar_self,u_polar_ef,u_polar_dd);
+      else polar_forces_eval<1,0,0>(u_polar_self,u_polar_ef,u_polar_dd);
+    } else polar_forces_eval<0,0,0>(u_polar_self,u_polar_ef,u_polar_dd);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template < const int EVFLAG, const int EFLAG, const int DAMPING >
+void PairLJCutCoulLongPolarizationOpt::polar_forces_eval(double &u_polar_self,
+                                                         double &u_polar_ef,
+                                                         double &u_polar_dd)
+{
+  int i,j,ii,moli;
+  double qtmp,qj,alphaj,xtmp,ytmp,ztmp,delx,dely,delz,xsq,ysq,zsq;
+  double rsq,r,rinv,r2inv,r3inv,r5inv,r7inv,ef_temp,common_factor;
+  double pdotp,pidotr,pjdotr,pre1,pre2,pre3,pre4,pre5;
+  double term_1,term_2,term_3;
+  double fx,fy,fz,fxtmp,fytmp,fztmp;
+  double mui0,mui1,mui2;
+  double xjimage[3];
+
+  double **x = atom->x;
+  double **f = atom->f;
+  double *q = atom->q;
+  int *molecule = atom->molecule;
+  double *static_polarizability = atom->static_polarizability;
+  double **mu = atom->mu_induced;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  double f_shift = -1.0/(cut_coul*cut_coul);
+  double s = sqrt(force->qqrd2e);
+  double damp = polar_damp;
+  double damp2 = damp*damp;
+  double damp3 = damp2*damp;
+
+  // every atom in polar_list carries a dipole
+
+  for (ii = 0; ii < npolar; ii++) {
+    i = polar_list[ii];
+    qtmp = q[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    moli = molecule[i];
+    mui0 = mu[i][0];
+    mui1 = mu[i][1];
+    mui2 = mu[i][2];
+    fxtmp = fytmp = fztmp = 0.0;
+
+    if (EFLAG) {
+      u_polar_self += 0.5*(mui0*mui0 + mui1*mui1 + mui2*mui2) /
+        static_polarizability[i];
+      if (nfix_efield)
+        u_polar_ef -= (mui0*ef_external[i][0] + mui1*ef_external[i][1] +
+                       mui2*ef_external[i][2])*s;
+    }
+
+    // pairs of two dipoles are done once for i < j
+
+    for (j = 0; j < nlocal; j++) {
+      alphaj = static_polarizability[j];
+      if (j == i || (j < i && alphaj != 0.0)) continue;
+
+      domain->closest_image(x[i],x[j],xjimage);
+      delx = xtmp - xjimage[0];
+      dely = ytmp - xjimage[1];
+      delz = ztmp - xjimage[2];
+      xsq = delx*delx;
+      ysq = dely*dely;
+      zsq = delz*delz;
+      rsq = xsq + ysq + zsq;
+
+      r2inv = 1.0/rsq;
+      rinv = sqrt(r2inv);
+      r = 1.0/rinv;
+      r3inv = r2inv*rinv;
+
+      fx = fy = fz = 0.0;
+
+      if (rsq < cut_coulsq && (molecule[j] != moli || moli == 0)) {
+        if (EFLAG) ef_temp = (1.0/rsq + f_shift)*1.0/r*s;
+
+        // dipole on i, charge on j
+
+        qj = q[j];
+        if (qj != 0.0) {
+          common_factor = qj*s*r3inv;
+          fx += common_factor * (mui0 * ((-2.0*xsq+ysq+zsq)*r2inv + f_shift*(ysq+zsq)) +
+                                 mui1 * (-3.0*delx*dely*r2inv - f_shift*delx*dely) +
+                                 mui2 * (-3.0*delx*delz*r2inv - f_shift*delx*delz));
+          fy += common_factor * (mui0 * (-3.0*delx*dely*r2inv - f_shift*delx*dely) +
+                                 mui1 * ((-2.0*ysq+xsq+zsq)*r2inv + f_shift*(xsq+zsq)) +
+                                 mui2 * (-3.0*dely*delz*r2inv - f_shift*dely*delz));
+          fz += common_factor * (mui0 * (-3.0*delx*delz*r2inv - f_shift*delx*delz) +
+                                 mui1 * (-3.0*dely*delz*r2inv - f_shift*dely*delz) +
+                                 mui2 * ((-2.0*zsq+xsq+ysq)*r2inv + f_shift*(xsq+ysq)));
+          if (EFLAG)
+            u_polar_ef -= mui0*ef_temp*qj*delx + mui1*ef_temp*qj*dely +
+              mui2*ef_temp*qj*delz;
+        }
+
+        // dipole on j, charge on i
+
+        if (alphaj != 0.0 && qtmp != 0.0) {
+          common_factor = qtmp*s*r3inv;
+          fx -= common_factor * (mu[j][0] * ((-2.0*xsq+ysq+zsq)*r2inv + f_shift*(ysq+zsq)) +
+                                 mu[j][1] * (-3.0*delx*dely*r2inv - f_shift*delx*dely) +
+                                 mu[j][2] * (-3.0*delx*delz*r2inv - f_shift*delx*delz));
+          fy -= common_factor * (mu[j][0] * (-3.0*delx*dely*r2inv - f_shift*delx*dely) +
+                                 mu[j][1] * ((-2.0*ysq+xsq+zsq)*r2inv + f_shift*(xsq+zsq)) +
+                                 mu[j][2] * (-3.0*dely*delz*r2inv - f_shift*dely*delz));
+          fz -= common_factor * (mu[j][0] * (-3.0*delx*delz*r2inv - f_shift*delx*delz) +
+                                 mu[j][1] * (-3.0*dely*delz*r2inv - f_shift*dely*delz) +
+                                 mu[j][2] * ((-2.0*zsq+xsq+ysq)*r2inv + f_shift*(xsq+ysq)));
+          if (EFLAG)
+            u_polar_ef += mu[j][0]*ef_temp*qtmp*delx + mu[j][1]*ef_temp*qtmp*dely +
+              mu[j][2]*ef_temp*qtmp*delz;
+        }
+      }
+
+      // dipole on i, dipole on j
+
+      if (alphaj != 0.0) {
+        r5inv = r3inv*r2inv;
+        r7inv = r5inv*r2inv;
+
+        pdotp = mui0*mu[j][0] + mui1*mu[j][1] + mui2*mu[j][2];
+        pidotr = mui0*delx + mui1*dely + mui2*delz;
+        pjdotr = mu[j][0]*delx + mu[j][1]*dely + mu[j][2]*delz;
+
+        if (DAMPING) {
+          term_1 = exp(-damp*r);
+          term_2 = 1.0 + damp*r + 0.5*damp2*r*r;
+          term_3 = term_2 + 1.0/6.0*damp3*r*r*r;
+
+          pre1 = 3.0*r5inv*pdotp*(1.0-term_1*term_2) -
+            15.0*r7inv*pidotr*pjdotr*(1.0-term_1*term_3);
+          pre2 = 3.0*r5inv*pjdotr*(1.0-term_1*term_3);
+          pre3 = 3.0*r5inv*pidotr*(1.0-term_1*term_3);
+          pre4 = -pdotp*r3inv*(-term_1*(damp*rinv+damp2) +
+                               term_1*damp*term_2*rinv);
+          pre5 = 3.0*pidotr*pjdotr*r5inv*(-term_1*(damp*rinv+damp2+0.5*r*damp3) +
+                                          term_1*damp*term_3*rinv);
+
+          fx += (pre1+pre4+pre5)*delx + pre2*mui0 + pre3*mu[j][0];
+          fy += (pre1+pre4+pre5)*dely + pre2*mui1 + pre3*mu[j][1];
+          fz += (pre1+pre4+pre5)*delz + pre2*mui2 + pre3*mu[j][2];
+
+          if (EFLAG)
+            u_polar_dd += r3inv*pdotp*(1.0-term_1*term_2) -
+              3.0*r5inv*pidotr*pjdotr*(1.0-term_1*term_3);
+        } else {
+          pre1 = 3.0*r5inv*pdotp - 15.0*r7inv*pidotr*pjdotr;
+          pre2 = 3.0*r5inv*pjdotr;
+          pre3 = 3.0*r5inv*pidotr;
+
+          fx += pre1*delx + pre2*mui0 + pre3*mu[j][0];
+          fy += pre1*dely + pre2*mui1 + pre3*mu[j][1];
+          fz += pre1*delz + pre2*mui2 + pre3*mu[j][2];
+
+          if (EFLAG) u_polar_dd += r3inv*pdotp - 3.0*r5inv*pidotr*pjdotr;
+        }
+      }
+
+      // j is always an owned atom
+
+      fxtmp += fx;
+      fytmp += fy;
+      fztmp += fz;
+      f[j][0] -= fx;
+      f[j][1] -= fy;
+      f[j][2] -= fz;
+
+      if (EVFLAG) ev_tally_xyz(i,j,nlocal,newton_pair,0.0,0.0,
+                               fx,fy,fz,delx,dely,delz);
+    }
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+  }
+}
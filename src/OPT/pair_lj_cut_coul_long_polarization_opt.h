@@ -0,0 +1,49 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(lj/cut/coul/long/polarization/opt,PairLJCutCoulLongPolarizationOpt)
+
+#else
+
+#ifndef LMP_PAIR_LJ_CUT_COUL_LONG_POLARIZATION_OPT_H
+#define LMP_PAIR_LJ_CUT_COUL_LONG_POLARIZATION_OPT_H
+
+#include "pair_lj_cut_coul_long_polarization.h"
+
+namespace LAMMPS_NS {
+
+class PairLJCutCoulLongPolarizationOpt : public PairLJCutCoulLongPolarization {
+ public:
+  PairLJCutCoulLongPolarizationOpt(class LAMMPS *);
+  virtual void compute(int, int);
+
+ protected:
+  virtual void static_field_wolf();
+  virtual void build_dipole_field_matrix();
+  virtual void polar_forces(int, double &, double &, double &);
+
+  template <const int EVFLAG, const int EFLAG,
+            const int NEWTON_PAIR, const int CTABLE >
+  void eval();
+  template < const int DAMPING >
+  void build_matrix_eval();
+  template < const int EVFLAG, const int EFLAG, const int DAMPING >
+  void polar_forces_eval(double &, double &, double &);
+};
+
+}
+
+#endif
+#endif
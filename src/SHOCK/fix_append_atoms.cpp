@@ -487,6 +487,7 @@ void FixAppendAtoms::pre_exchange()
                   x[2] += ranz * 2.0*(randomx->uniform()-0.5);
                 }
                 addnode++;
+                atom->map_drop_ghost();
                 atom->avec->create_atom(basistype[m],x);
               }
             }
@@ -498,16 +499,15 @@ void FixAppendAtoms::pre_exchange()
     MPI_Barrier(world);
     MPI_Allreduce(&addnode,&addtotal,1,MPI_INT,MPI_SUM,world);
 
+    // new atoms took the slots of ghost atoms that were removed from the map,
+    //   add them to the map once they have IDs
+
     if (addtotal) {
       domain->reset_box();
       if (atom->tag_enable) {
         atom->tag_extend();
         atom->natoms += addtotal;
-        if (atom->map_style) {
-          atom->nghost = 0;
-          atom->map_init();
-          atom->map_set();
-        }
+        atom->map_new_owned(atom->nlocal - addnode);
       }
     }
   }
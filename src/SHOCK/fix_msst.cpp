@@ -27,6 +27,8 @@
 #include "output.h"
 #include "modify.h"
 #include "compute.h"
+#include "compute_temp.h"
+#include "compute_pressure.h"
 #include "kspace.h"
 #include "update.h"
 #include "respa.h"
@@ -220,13 +222,6 @@ FixMSST::FixMSST(LAMMPS *lmp, int narg, char **arg) :
 
   nrigid = 0;
   rfix = NULL;
-
-  old_velocity = new double* [atom->nlocal];
-  for ( int j = 0; j < atom->nlocal; j++ ) {
-    old_velocity[j] = new double [3];
-  }
-  atoms_allocated = atom->nlocal;
-
 }
 
 /* ---------------------------------------------------------------------- */
@@ -244,12 +239,6 @@ FixMSST::~FixMSST()
   delete [] id_temp;
   delete [] id_press;
   delete [] id_pe;
-
-  for ( int j = 0; j < atoms_allocated; j++ ) {
-    delete [] old_velocity[j];
-  }
-  delete [] old_velocity;
-
 }
 
 /* ---------------------------------------------------------------------- */
@@ -304,6 +293,15 @@ void FixMSST::init()
   if (force->kspace) kspace_flag = 1;
   else kspace_flag = 0;
 
+  // KE tensor, virial and velocity sum can be reduced in one collective
+  //   if the temperature and pressure are the computes created by this fix
+  //   and the temperature group is the group of this fix
+  // otherwise the computes are invoked one after the other
+
+  fused = 0;
+  if (tflag && pflag && temperature->igroup == igroup &&
+      atom->rmass == NULL) fused = 1;
+
   // detect if any fix rigid exist so rigid bodies move when box is dilated
   // rfix[] = indices to each fix rigid
 
@@ -401,6 +399,12 @@ void FixMSST::setup(int vflag)
         }
       }
     }
+
+    // refresh T,P so output on this step sees the rescaled velocities
+
+    temperature->compute_vector();
+    pressure->compute_vector();
+    couple();
   }
 
   // trigger virial computation on next timestep
@@ -416,26 +420,22 @@ void FixMSST::initial_integrate(int vflag)
 {
   int sd;
   double p_msst;                // MSST driving pressure.
-  int i, k;
   double vol;
-  int nlocal = atom->nlocal;
-  int *mask = atom->mask;
-  double **v = atom->v;
-  double **f = atom->f;
-  double *mass = atom->mass;
-  int *type = atom->type;
-  double **x = atom->x;
-
-  // check to see if old_velocity is correctly allocated
-
-  check_alloc(nlocal);
 
   sd = direction;
 
-  // compute new pressure and volume.
-  temperature->compute_vector();
-  pressure->compute_vector();
-  couple();
+  // compute new pressure, velocity sum and volume.
+
+  if (fused) {
+    double t[7];
+    thermo_local(t);
+    reduce_thermo(t);
+  } else {
+    temperature->compute_vector();
+    pressure->compute_vector();
+    couple();
+    velocity_sum = compute_vsum();
+  }
   vol = compute_vol();
 
   // propagate the time derivative of
@@ -463,63 +463,16 @@ void FixMSST::initial_integrate(int vflag)
       0.5 * (B * B * omega[sd] - A * B ) * dthalf * dthalf;
   }
 
-  // propagate velocity sum 1/2 step by
-  // temporarily propagating the velocities.
-
-  velocity_sum = compute_vsum();
-  for (i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit) {
-      for ( k = 0; k < 3; k++ ) {
-        double C = f[i][k] * force->ftm2v / mass[type[i]];
-        double D = mu * omega[sd] * omega[sd] /
-          (velocity_sum * mass[type[i]] * vol );
-        old_velocity[i][k] = v[i][k];
-        if ( k == direction ) {
-          D = D - 2.0 * omega[sd] / vol;
-        }
-        if ( fabs(dthalf * D) > 1.0e-06 ) {
-          double expd = exp(D * dthalf);
-          v[i][k] = expd * ( C + D * v[i][k] - C / expd ) / D;
-        } else {
-          v[i][k] = v[i][k] + ( C + D * v[i][k] ) * dthalf +
-            0.5 * (D * D * v[i][k] + C * D ) * dthalf * dthalf;
-        }
-      }
-    }
-  }
-  velocity_sum = compute_vsum();
-
-  // reset the velocities.
+  // propagate velocity sum 1/2 step.
+  // the trial velocities are only accumulated into the sum,
+  // so the atom velocities need not be saved and restored
 
-  for (i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit) {
-      for ( k = 0; k < 3; k++ ) {
-        v[i][k] = old_velocity[i][k];
-      }
-    }
-  }
+  double vsum_local = vsum_trial(vol);
+  MPI_Allreduce(&vsum_local,&velocity_sum,1,MPI_DOUBLE,MPI_SUM,world);
 
   // propagate velocities 1/2 step using the new velocity sum.
 
-  for (i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit) {
-      for ( k = 0; k < 3; k++ ) {
-        double C = f[i][k] * force->ftm2v / mass[type[i]];
-        double D = mu * omega[sd] * omega[sd] /
-          (velocity_sum * mass[type[i]] * vol );
-        if ( k == direction ) {
-          D = D - 2.0 * omega[sd] / vol;
-        }
-        if ( fabs(dthalf * D) > 1.0e-06 ) {
-          double expd = exp(D * dthalf);
-          v[i][k] = expd * ( C + D * v[i][k] - C / expd ) / D;
-        } else {
-          v[i][k] = v[i][k] + ( C + D * v[i][k] ) * dthalf +
-            0.5 * (D * D * v[i][k] + C * D ) * dthalf * dthalf;
-        }
-      }
-    }
-  }
+  propagate_v(vol,NULL);
 
   // propagate the volume 1/2 step.
 
@@ -532,13 +485,7 @@ void FixMSST::initial_integrate(int vflag)
 
   // propagate particle positions 1 time step.
 
-  for (i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit) {
-      x[i][0] += dtv * v[i][0];
-      x[i][1] += dtv * v[i][1];
-      x[i][2] += dtv * v[i][2];
-    }
-  }
+  propagate_x();
 
   // propagate the volume 1/2 step.
 
@@ -558,49 +505,25 @@ void FixMSST::initial_integrate(int vflag)
 
 void FixMSST::final_integrate()
 {
-  int i;
-
-  // v update only for atoms in MSST group
-
-  double **v = atom->v;
-  double **f = atom->f;
-  double *mass = atom->mass;
-  int *type = atom->type;
-  int *mask = atom->mask;
-  int nlocal = atom->nlocal;
   double vol = compute_vol();
   double p_msst;
   int sd = direction;
 
   // propagate particle velocities 1/2 step.
+  // if fused, accumulate KE tensor and velocity sum in the same pass
 
-  for (i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit) {
-      for ( int k = 0; k < 3; k++ ) {
-        double C = f[i][k] * force->ftm2v / mass[type[i]];
-        double D = mu * omega[sd] * omega[sd] /
-          (velocity_sum * mass[type[i]] * vol );
-        if ( k == direction ) {
-          D = D - 2.0 * omega[sd] / vol;
-        }
-        if ( fabs(dthalf * D) > 1.0e-06 ) {
-          double expd = exp(D * dthalf);
-          v[i][k] = expd * ( C + D * v[i][k] - C / expd ) / D;
-        } else {
-          v[i][k] = v[i][k] + ( C + D * v[i][k] ) * dthalf +
-            0.5 * (D * D * v[i][k] + C * D ) * dthalf * dthalf;
-        }
-      }
-    }
-  }
-
-  // compute new pressure and volume.
+  double t[7];
+  propagate_v(vol,fused ? t : NULL);
 
-  temperature->compute_vector();
+  // compute new pressure, velocity sum and volume.
 
-  pressure->compute_vector();
-  couple();
-  velocity_sum = compute_vsum();
+  if (fused) reduce_thermo(t);
+  else {
+    temperature->compute_vector();
+    pressure->compute_vector();
+    couple();
+    velocity_sum = compute_vsum();
+  }
   vol = compute_vol();
 
   // propagate the time derivative of the volume 1/2 step at fixed V, r, rdot.
@@ -787,12 +710,6 @@ int FixMSST::modify_param(int narg, char **arg)
 
 double FixMSST::compute_scalar()
 {
-  // compute new pressure and volume.
-
-  temperature->compute_vector();
-  pressure->compute_vector();
-  couple();
-
   double volume = compute_vol();
 
   double energy = 0.0;
@@ -838,10 +755,7 @@ double FixMSST::compute_hugoniot()
   double dhugo;
 
   e = compute_etotal();
-
-  temperature->compute_vector();
-  pressure->compute_vector();
-  p = pressure->vector[direction];
+  p = compute_pressure();
 
   v = compute_vol();
 
@@ -862,9 +776,7 @@ double FixMSST::compute_rayleigh()
   double v, p;
   double drayleigh;
 
-  temperature->compute_vector();
-  pressure->compute_vector();
-  p = pressure->vector[direction];
+  p = compute_pressure();
 
   v = compute_vol();
 
@@ -901,14 +813,40 @@ double FixMSST::compute_lagrangian_position()
 double FixMSST::compute_etotal()
 {
   double epot,ekin,etot;
+
+  // reuse KE if already computed on this timestep
+  // PE is always recomputed since it includes fix energy contributions
+  // KE is the trace of the KE tensor when that is current
+
+  bigint ntimestep = update->ntimestep;
   epot = pe->compute_scalar();
   if (thermo_energy) epot -= compute_scalar();
-  ekin = temperature->compute_scalar();
-  ekin *= 0.5 * temperature->dof * force->boltz;
+
+  if (temperature->invoked_vector == ntimestep) {
+    double *ke_tensor = temperature->vector;
+    ekin = 0.5 * (ke_tensor[0] + ke_tensor[1] + ke_tensor[2]);
+  } else {
+    ekin = temperature->compute_scalar();
+    ekin *= 0.5 * temperature->dof * force->boltz;
+  }
   etot = epot+ekin;
   return etot;
 }
 
+/* ----------------------------------------------------------------------
+   pressure along the shock direction for output,
+   reuse the pressure tensor if already computed on this timestep
+------------------------------------------------------------------------- */
+
+double FixMSST::compute_pressure()
+{
+  if (pressure->invoked_vector != update->ntimestep) {
+    temperature->compute_vector();
+    pressure->compute_vector();
+  }
+  return pressure->vector[direction];
+}
+
 /* ---------------------------------------------------------------------- */
 
 double FixMSST::compute_vol()
@@ -919,26 +857,6 @@ double FixMSST::compute_vol()
     return domain->xprd * domain->yprd;
 }
 
-/* ----------------------------------------------------------------------
-   Checks to see if the allocated size of old_velocity is >= n
-   The number of local atoms can change during a parallel run.
-------------------------------------------------------------------------- */
-
-void FixMSST::check_alloc(int n)
-{
-  if ( atoms_allocated < n ) {
-    for ( int j = 0; j < atoms_allocated; j++ ) {
-      delete [] old_velocity[j];
-    }
-    delete [] old_velocity;
-
-    old_velocity = new double* [n];
-    for ( int j = 0; j < n; j++ )
-      old_velocity[j] = new double [3];
-    atoms_allocated = n;
-  }
-}
-
 double FixMSST::compute_vsum()
 {
   double vsum;
@@ -958,3 +876,191 @@ double FixMSST::compute_vsum()
   MPI_Allreduce(&t,&vsum,1,MPI_DOUBLE,MPI_SUM,world);
   return vsum;
 }
+
+/* ----------------------------------------------------------------------
+   sum KE tensor, virial and velocity sum across procs in one collective
+   t = KE tensor (m v_a v_b, xx,yy,zz,xy,xz,yz) and velocity sum
+     of owned atoms in group
+   set T,P computes and velocity_sum from the totals
+------------------------------------------------------------------------- */
+
+void FixMSST::reduce_thermo(double *t)
+{
+  double local[13],all[13];
+
+  for (int k = 0; k < 6; k++) local[k] = t[k];
+  ((ComputePressure *) pressure)->virial_local(&local[6],6);
+  local[12] = t[6];
+
+  MPI_Allreduce(local,all,13,MPI_DOUBLE,MPI_SUM,world);
+
+  ((ComputeTemp *) temperature)->compute_reduced(all);
+  ((ComputePressure *) pressure)->compute_vector_reduced(&all[6]);
+  couple();
+  velocity_sum = all[12];
+}
+
+/* ----------------------------------------------------------------------
+   KE tensor and velocity sum of owned atoms in group
+------------------------------------------------------------------------- */
+
+void FixMSST::thermo_local(double *t)
+{
+  thermo_range(0,atom->nlocal,t);
+}
+
+/* ----------------------------------------------------------------------
+   sum of squared velocities of owned atoms in group
+     after a trial 1/2 step velocity update
+   atom velocities are not changed
+------------------------------------------------------------------------- */
+
+double FixMSST::vsum_trial(double vol)
+{
+  return vsum_range(0,atom->nlocal,vol);
+}
+
+/* ----------------------------------------------------------------------
+   propagate velocities of owned atoms in group 1/2 step
+   if t is not NULL, return KE tensor and velocity sum of new velocities
+------------------------------------------------------------------------- */
+
+void FixMSST::propagate_v(double vol, double *t)
+{
+  propagate_v_range(0,atom->nlocal,vol,t);
+}
+
+/* ----------------------------------------------------------------------
+   propagate positions of owned atoms in group 1 step
+------------------------------------------------------------------------- */
+
+void FixMSST::propagate_x()
+{
+  propagate_x_range(0,atom->nlocal);
+}
+
+/* ----------------------------------------------------------------------
+   loops of the above over owned atoms ifrom to ito-1
+------------------------------------------------------------------------- */
+
+void FixMSST::thermo_range(int ifrom, int ito, double *t)
+{
+  double **v = atom->v;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  double massone;
+
+  for (int k = 0; k < 7; k++) t[k] = 0.0;
+
+  for (int i = ifrom; i < ito; i++)
+    if (mask[i] & groupbit) {
+      massone = mass[type[i]];
+      t[0] += massone * v[i][0]*v[i][0];
+      t[1] += massone * v[i][1]*v[i][1];
+      t[2] += massone * v[i][2]*v[i][2];
+      t[3] += massone * v[i][0]*v[i][1];
+      t[4] += massone * v[i][0]*v[i][2];
+      t[5] += massone * v[i][1]*v[i][2];
+      t[6] += v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMSST::vsum_range(int ifrom, int ito, double vol)
+{
+  double **v = atom->v;
+  double **f = atom->f;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int sd = direction;
+
+  double vsum_local = 0.0;
+  for (int i = ifrom; i < ito; i++) {
+    if (mask[i] & groupbit) {
+      for ( int k = 0; k < 3; k++ ) {
+        double C = f[i][k] * force->ftm2v / mass[type[i]];
+        double D = mu * omega[sd] * omega[sd] /
+          (velocity_sum * mass[type[i]] * vol );
+        double vtrial;
+        if ( k == direction ) {
+          D = D - 2.0 * omega[sd] / vol;
+        }
+        if ( fabs(dthalf * D) > 1.0e-06 ) {
+          double expd = exp(D * dthalf);
+          vtrial = expd * ( C + D * v[i][k] - C / expd ) / D;
+        } else {
+          vtrial = v[i][k] + ( C + D * v[i][k] ) * dthalf +
+            0.5 * (D * D * v[i][k] + C * D ) * dthalf * dthalf;
+        }
+        vsum_local += vtrial * vtrial;
+      }
+    }
+  }
+  return vsum_local;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSST::propagate_v_range(int ifrom, int ito, double vol,
+                                double *t)
+{
+  double **v = atom->v;
+  double **f = atom->f;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int sd = direction;
+  double massone;
+
+  if (t) for (int k = 0; k < 7; k++) t[k] = 0.0;
+
+  for (int i = ifrom; i < ito; i++) {
+    if (mask[i] & groupbit) {
+      for ( int k = 0; k < 3; k++ ) {
+        double C = f[i][k] * force->ftm2v / mass[type[i]];
+        double D = mu * omega[sd] * omega[sd] /
+          (velocity_sum * mass[type[i]] * vol );
+        if ( k == direction ) {
+          D = D - 2.0 * omega[sd] / vol;
+        }
+        if ( fabs(dthalf * D) > 1.0e-06 ) {
+          double expd = exp(D * dthalf);
+          v[i][k] = expd * ( C + D * v[i][k] - C / expd ) / D;
+        } else {
+          v[i][k] = v[i][k] + ( C + D * v[i][k] ) * dthalf +
+            0.5 * (D * D * v[i][k] + C * D ) * dthalf * dthalf;
+        }
+      }
+      if (t) {
+        massone = mass[type[i]];
+        t[0] += massone * v[i][0]*v[i][0];
+        t[1] += massone * v[i][1]*v[i][1];
+        t[2] += massone * v[i][2]*v[i][2];
+        t[3] += massone * v[i][0]*v[i][1];
+        t[4] += massone * v[i][0]*v[i][2];
+        t[5] += massone * v[i][1]*v[i][2];
+        t[6] += v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSST::propagate_x_range(int ifrom, int ito)
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  int *mask = atom->mask;
+
+  for (int i = ifrom; i < ito; i++) {
+    if (mask[i] & groupbit) {
+      x[i][0] += dtv * v[i][0];
+      x[i][1] += dtv * v[i][1];
+      x[i][2] += dtv * v[i][2];
+    }
+  }
+}
@@ -31,9 +31,9 @@ namespace LAMMPS_NS {
 class FixMSST : public Fix {
  public:
   FixMSST(class LAMMPS *, int, char **);
-  ~FixMSST();
+  virtual ~FixMSST();
   int setmask();
-  void init();
+  virtual void init();
   void setup(int);
   void initial_integrate(int);
   void final_integrate();
@@ -43,7 +43,7 @@ class FixMSST : public Fix {
   void restart(char *);
   int modify_param(int, char **);
 
- private:
+ protected:
   double dtv,dtf,dthalf;           // Full and half step sizes.
   double boltz,nktv2p, mvv2e;      // Boltzmann factor and unit conversions.
   double total_mass;               // Mass of the computational cell.
@@ -56,8 +56,8 @@ class FixMSST : public Fix {
                                    // strain ke at simulation start
 
   double velocity_sum;             // Sum of the velocities squared.
-
-  double **old_velocity;           // Saved velocities.
+  int fused;                       // 1 if KE tensor, virial and velocity
+                                   // sum are reduced in one collective
 
   int kspace_flag;                 // 1 if KSpace invoked, 0 if not
   int nrigid;                      // number of rigid fixes
@@ -84,20 +84,29 @@ class FixMSST : public Fix {
   int v0_set;                      // Is volume set.
   int e0_set;                      // Is energy set.
 
-  int atoms_allocated;             // The number of allocated atoms in old_velocity.
-
   // functions
 
   void couple();
   void remap(int);
-  void check_alloc(int n);
   double compute_etotal();
+  double compute_pressure();
   double compute_vol();
   double compute_hugoniot();
   double compute_rayleigh();
   double compute_lagrangian_speed();
   double compute_lagrangian_position();
   double compute_vsum();
+
+  void reduce_thermo(double *);
+  virtual void thermo_local(double *);
+  virtual double vsum_trial(double);
+  virtual void propagate_v(double, double *);
+  virtual void propagate_x();
+
+  void thermo_range(int, int, double *);
+  double vsum_range(int, int, double);
+  void propagate_v_range(int, int, double, double *);
+  void propagate_x_range(int, int);
 };
 
 }
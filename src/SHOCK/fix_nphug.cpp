@@ -18,6 +18,10 @@
 #include "error.h"
 #include "update.h"
 #include "compute.h"
+#include "compute_temp.h"
+#include "compute_pressure.h"
+#include "compute_pe.h"
+#include "atom.h"
 #include "force.h"
 #include "domain.h"
 #include "group.h"
@@ -29,6 +33,7 @@
 using namespace LAMMPS_NS;
 using namespace FixConst;
 
+enum{NOBIAS,BIAS};         // same as fix_nh.cpp
 enum{ISO,ANISO,TRICLINIC}; // same as fix_nh.cpp
 
 /* ---------------------------------------------------------------------- */
@@ -198,6 +203,15 @@ void FixNPHug::init()
   if (icompute < 0)
     error->all(FLERR,"Potential energy ID for fix nvt/nph/npt does not exist");
   pe = modify->compute[icompute];
+
+  // PE, KE tensor and virial can be reduced in one collective
+  //   if the computes are the plain temp, pressure and pe styles
+  // otherwise the computes are invoked one after the other
+
+  fused = 0;
+  if (which == NOBIAS && strcmp(temperature->style,"temp") == 0 &&
+      strcmp(pressure->style,"pressure") == 0 &&
+      strcmp(pe->style,"pe") == 0) fused = 1;
 }
 
 
@@ -253,12 +267,78 @@ double FixNPHug::compute_etotal()
   double epot,ekin,etot;
   epot = pe->compute_scalar();
   if (thermo_energy) epot -= compute_scalar();
-  ekin = temperature->compute_scalar();
-  ekin *= 0.5 * tdof * force->boltz;
+
+  // uniaxial case takes KE from the trace of the KE tensor,
+  // which the pressure tensor then uses without another reduction
+
+  if (uniaxial == 1) {
+    temperature->compute_vector();
+    double *ke_tensor = temperature->vector;
+    ekin = 0.5 * (ke_tensor[0] + ke_tensor[1] + ke_tensor[2]);
+  } else {
+    ekin = temperature->compute_scalar();
+    ekin *= 0.5 * tdof * force->boltz;
+  }
   etot = epot+ekin;
   return etot;
 }
 
+/* ----------------------------------------------------------------------
+   same as compute_etotal() and the pressure in compute_hugoniot(),
+     with PE, KE tensor and virial summed across procs in one collective
+   return total energy and p = pressure along idir or hydrostatic
+------------------------------------------------------------------------- */
+
+double FixNPHug::reduce_etotal(double &p)
+{
+  double **v = atom->v;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int tgroupbit = temperature->groupbit;
+  double massone;
+
+  double local[13],all[13];
+  for (int k = 0; k < 6; k++) local[k] = 0.0;
+
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & tgroupbit) {
+      if (rmass) massone = rmass[i];
+      else massone = mass[type[i]];
+      local[0] += massone * v[i][0]*v[i][0];
+      local[1] += massone * v[i][1]*v[i][1];
+      local[2] += massone * v[i][2]*v[i][2];
+      local[3] += massone * v[i][0]*v[i][1];
+      local[4] += massone * v[i][0]*v[i][2];
+      local[5] += massone * v[i][1]*v[i][2];
+    }
+  ((ComputePressure *) pressure)->virial_local(&local[6],6);
+  local[12] = ((ComputePE *) pe)->energy_local();
+
+  MPI_Allreduce(local,all,13,MPI_DOUBLE,MPI_SUM,world);
+
+  ((ComputeTemp *) temperature)->compute_reduced(all);
+  if (uniaxial == 1) {
+    ((ComputePressure *) pressure)->compute_vector_reduced(&all[6]);
+    p = pressure->vector[idir];
+  } else p = ((ComputePressure *) pressure)->compute_scalar_reduced(&all[6]);
+
+  double epot,ekin;
+  epot = ((ComputePE *) pe)->compute_scalar_reduced(all[12]);
+  if (thermo_energy) epot -= compute_scalar();
+
+  if (uniaxial == 1) {
+    double *ke_tensor = temperature->vector;
+    ekin = 0.5 * (ke_tensor[0] + ke_tensor[1] + ke_tensor[2]);
+  } else {
+    ekin = temperature->scalar;
+    ekin *= 0.5 * tdof * force->boltz;
+  }
+  return epot+ekin;
+}
+
 /* ---------------------------------------------------------------------- */
 
 double FixNPHug::compute_vol()
@@ -279,16 +359,19 @@ double FixNPHug::compute_hugoniot()
   double v,e,p;
   double dhugo;
 
-  e = compute_etotal();
+  if (fused) e = reduce_etotal(p);
+  else {
 
-  temperature->compute_vector();
+    // temperature was already computed by compute_etotal()
 
+    e = compute_etotal();
 
-  if (uniaxial == 1) {
-    pressure->compute_vector();
-    p = pressure->vector[idir];
-  } else
-    p = pressure->compute_scalar();
+    if (uniaxial == 1) {
+      pressure->compute_vector();
+      p = pressure->vector[idir];
+    } else
+      p = pressure->compute_scalar();
+  }
 
   v = compute_vol();
 
@@ -309,9 +392,8 @@ double FixNPHug::compute_us()
   double v,p;
   double eps,us;
 
-  temperature->compute_vector();
-
   if (uniaxial == 1) {
+    temperature->compute_vector();
     pressure->compute_vector();
     p = pressure->vector[idir];
   } else
@@ -44,6 +44,7 @@ class FixNPHug : public FixNH {
   double compute_hugoniot();
   double compute_us();
   double compute_up();
+  double reduce_etotal(double &);
 
   char *id_pe;
   int peflag;
@@ -51,6 +52,8 @@ class FixNPHug : public FixNH {
   double v0,p0,e0,rho0;
   int idir;
   int uniaxial;
+  int fused;                       // 1 if PE, KE tensor and virial are
+                                   // reduced in one collective
 
   int size_restart_global();
 };
@@ -28,6 +28,13 @@ struct _mpi_double_int {
 };
 typedef struct _mpi_double_int double_int;
 
+/* derived datatypes are negative, their sizes are stored here */
+
+#define MAXEXTRA_DATATYPE 16
+
+static int used_datatype[MAXEXTRA_DATATYPE];
+static int size_datatype[MAXEXTRA_DATATYPE];
+
 /* ---------------------------------------------------------------------- */
 /* MPI Functions */
 /* ---------------------------------------------------------------------- */
@@ -110,12 +117,56 @@ int MPI_Type_size(MPI_Datatype datatype, int *size)
   else if (datatype == MPI_BYTE) *size = sizeof(char);
   else if (datatype == MPI_LONG_LONG) *size = sizeof(uint64_t);
   else if (datatype == MPI_DOUBLE_INT) *size = sizeof(double_int);
+  else if (datatype < 0) *size = size_datatype[-datatype-1];
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Type_contiguous(int count, MPI_Datatype oldtype,
+                        MPI_Datatype *newtype)
+{
+  int i,size;
+  for (i = 0; i < MAXEXTRA_DATATYPE; i++)
+    if (!used_datatype[i]) break;
+  if (i == MAXEXTRA_DATATYPE) return -1;
+
+  MPI_Type_size(oldtype,&size);
+  used_datatype[i] = 1;
+  size_datatype[i] = count*size;
+  *newtype = -(i+1);
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Type_commit(MPI_Datatype *datatype) {return 0;}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Type_free(MPI_Datatype *datatype)
+{
+  if (*datatype < 0) used_datatype[-(*datatype)-1] = 0;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* user-defined reduction is never invoked for a single proc */
 
+int MPI_Op_create(MPI_User_function *function, int commute, MPI_Op *op)
+{
+  *op = 0;
   return 0;
 }
 
 /* ---------------------------------------------------------------------- */
 
+int MPI_Op_free(MPI_Op *op) {return 0;}
+
+/* ---------------------------------------------------------------------- */
+
 int MPI_Send(void *buf, int count, MPI_Datatype datatype,
              int dest, int tag, MPI_Comm comm)
 {
@@ -161,6 +212,40 @@ int MPI_Irecv(void *buf, int count, MPI_Datatype datatype,
 
 /* ---------------------------------------------------------------------- */
 
+int MPI_Send_init(void *buf, int count, MPI_Datatype datatype,
+                  int dest, int tag, MPI_Comm comm, MPI_Request *request)
+{
+  printf("MPI Stub WARNING: Should not send message to self\n");
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Recv_init(void *buf, int count, MPI_Datatype datatype,
+                  int source, int tag, MPI_Comm comm, MPI_Request *request)
+{
+  printf("MPI Stub WARNING: Should not recv message from self\n");
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Start(MPI_Request *request)
+{
+  printf("MPI Stub WARNING: Should not start message to/from self\n");
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Request_free(MPI_Request *request)
+{
+  *request = MPI_REQUEST_NULL;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
 int MPI_Wait(MPI_Request *request, MPI_Status *status)
 {
   printf("MPI Stub WARNING: Should not wait on message from self\n");
@@ -284,6 +369,7 @@ int MPI_Allreduce(void *sendbuf, void *recvbuf, int count,
   else if (datatype == MPI_BYTE) n = count*sizeof(char);
   else if (datatype == MPI_LONG_LONG) n = count*sizeof(uint64_t);
   else if (datatype == MPI_DOUBLE_INT) n = count*sizeof(double_int);
+  else if (datatype < 0) n = count*size_datatype[-datatype-1];
 
   if (sendbuf == MPI_IN_PLACE || recvbuf == MPI_IN_PLACE) return 0;
   memcpy(recvbuf,sendbuf,n);
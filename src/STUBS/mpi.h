@@ -44,6 +44,7 @@ extern "C" {
 #define MPI_LOR 6
 
 #define MPI_ANY_SOURCE -1
+#define MPI_REQUEST_NULL 0
 
 #define MPI_Comm int
 #define MPI_Request int
@@ -74,6 +75,15 @@ int MPI_Finalize();
 double MPI_Wtime();
 
 int MPI_Type_size(int, int *);
+int MPI_Type_contiguous(int count, MPI_Datatype oldtype,
+                        MPI_Datatype *newtype);
+int MPI_Type_commit(MPI_Datatype *datatype);
+int MPI_Type_free(MPI_Datatype *datatype);
+
+typedef void MPI_User_function(void *invec, void *inoutvec, int *len,
+                               MPI_Datatype *datatype);
+int MPI_Op_create(MPI_User_function *function, int commute, MPI_Op *op);
+int MPI_Op_free(MPI_Op *op);
 
 int MPI_Send(void *buf, int count, MPI_Datatype datatype,
              int dest, int tag, MPI_Comm comm);
@@ -86,6 +96,12 @@ int MPI_Recv(void *buf, int count, MPI_Datatype datatype,
 int MPI_Irecv(void *buf, int count, MPI_Datatype datatype,
               int source, int tag, MPI_Comm comm, MPI_Request *request);
 int MPI_Wait(MPI_Request *request, MPI_Status *status);
+int MPI_Send_init(void *buf, int count, MPI_Datatype datatype,
+                  int dest, int tag, MPI_Comm comm, MPI_Request *request);
+int MPI_Recv_init(void *buf, int count, MPI_Datatype datatype,
+                  int source, int tag, MPI_Comm comm, MPI_Request *request);
+int MPI_Start(MPI_Request *request);
+int MPI_Request_free(MPI_Request *request);
 int MPI_Waitall(int n, MPI_Request *request, MPI_Status *status);
 int MPI_Waitany(int count, MPI_Request *request, int *index,
                 MPI_Status *status);
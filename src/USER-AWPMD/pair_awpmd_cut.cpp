@@ -163,7 +163,7 @@ void PairAWPMDCut::compute(int eflag, int vflag)
     for (int jj = 0; jj < jnum; jj++) {
       int j = jlist[jj];
       j &= NEIGHMASK;
-      if(j>=nlocal){ // this is a ghost
+      if(j>=nlocal && gmap[j]<0){ // this is a ghost not yet marked as needed
         Vector_3 rj=Vector_3(x[j][0],x[j][1],x[j][2]);
         int jtype = type[j];
         double rsq=(ri-rj).norm2();
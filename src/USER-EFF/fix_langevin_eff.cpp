@@ -51,6 +51,8 @@ enum{CONSTANT,EQUAL,ATOM};
 FixLangevinEff::FixLangevinEff(LAMMPS *lmp, int narg, char **arg) :
   FixLangevin(lmp, narg, arg)
 {
+  if (philox) error->all(FLERR,"Fix langevin/eff does not support rng philox");
+
   erforcelangevin = NULL;
 }
 
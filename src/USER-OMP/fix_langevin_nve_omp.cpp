@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "fix_langevin_nve_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "update.h"
+#include "random_mars.h"
+#include "random_philox.h"
+
+#include "thr_omp.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{CONSTANT,EQUAL,ATOM};
+enum{MARS,PHILOX};
+enum{RANFORCE,RANOMEGA,RANANGMOM};
+
+/* ---------------------------------------------------------------------- */
+
+FixLangevinNVEOMP::FixLangevinNVEOMP(LAMMPS *lmp, int narg, char **arg) :
+  FixLangevinNVE(lmp, narg, arg)
+{
+  nthreads_rng = 0;
+  random_thr = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixLangevinNVEOMP::~FixLangevinNVEOMP()
+{
+  for (int i = 1; i < nthreads_rng; i++) delete random_thr[i];
+  delete [] random_thr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLangevinNVEOMP::init()
+{
+  FixLangevinNVE::init();
+
+  // one RNG per thread, thread 0 uses the RNG of the serial fix
+  //   so that results with one thread match fix langevin/nve
+
+  if (nthreads_rng != comm->nthreads) {
+    for (int i = 1; i < nthreads_rng; i++) delete random_thr[i];
+    delete [] random_thr;
+    nthreads_rng = comm->nthreads;
+    random_thr = new RanMars*[nthreads_rng];
+    random_thr[0] = random;
+    for (int i = 1; i < nthreads_rng; i++)
+      random_thr[i] = new RanMars(lmp,seed + comm->me + comm->nprocs*i);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLangevinNVEOMP::initial_integrate(int vflag)
+{
+  double * const * const x = atom->x;
+  double * const * const v = atom->v;
+  const double * const * const f = atom->f;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  int i;
+
+#if defined(_OPENMP)
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      const double dtfm = dtf / (rmass ? rmass[i] : mass[type[i]]);
+      v[i][0] += dtfm * f[i][0];
+      v[i][1] += dtfm * f[i][1];
+      v[i][2] += dtfm * f[i][2];
+      x[i][0] += dtv * v[i][0];
+      x[i][1] += dtv * v[i][1];
+      x[i][2] += dtv * v[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLangevinNVEOMP::final_integrate()
+{
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+  compute_target();
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    if (atom->rmass) final_thr<1>(ifrom, ito, tid);
+    else final_thr<0>(ifrom, ito, tid);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   fused Langevin force and 2nd half-step update for atoms ifrom to ito-1
+   tsqrt is shared between threads, so per-atom values are kept local
+------------------------------------------------------------------------- */
+
+template <int RMASS>
+void FixLangevinNVEOMP::final_thr(int ifrom, int ito, int tid)
+{
+  double * const * const v = atom->v;
+  double * const * const f = atom->f;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  const int * const tag = atom->tag;
+  const bigint ntimestep = update->ntimestep;
+
+  const double boltz = force->boltz;
+  const double dt = update->dt;
+  const double mvv2e = force->mvv2e;
+  const double ftm2v = force->ftm2v;
+
+  RanMars &rng = *random_thr[tid];
+  RanPhilox prng(seed);
+
+  double gamma1,gamma2,tsqrtone,dtfm,ran[3];
+
+  for (int i = ifrom; i < ito; i++) {
+    if (mask[i] & groupbit) {
+      tsqrtone = (tstyle == ATOM) ? sqrt(tforce[i]) : tsqrt;
+      if (RMASS) {
+        gamma1 = -rmass[i] / t_period / ftm2v;
+        gamma2 = sqrt(rmass[i]) * sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
+        gamma1 *= 1.0/ratio[type[i]];
+        gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrtone;
+        dtfm = dtf / rmass[i];
+      } else {
+        gamma1 = gfactor1[type[i]];
+        gamma2 = gfactor2[type[i]] * tsqrtone;
+        dtfm = dtf / mass[type[i]];
+      }
+      if (rngstyle == PHILOX) {
+        prng.reset(tag[i],RANFORCE,ntimestep);
+        ran[0] = prng.uniform();
+        ran[1] = prng.uniform();
+        ran[2] = prng.uniform();
+      } else {
+        ran[0] = rng.uniform();
+        ran[1] = rng.uniform();
+        ran[2] = rng.uniform();
+      }
+      f[i][0] += gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+      f[i][1] += gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+      f[i][2] += gamma1*v[i][2] + gamma2*(ran[2]-0.5);
+      v[i][0] += dtfm * f[i][0];
+      v[i][1] += dtfm * f[i][1];
+      v[i][2] += dtfm * f[i][2];
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixLangevinNVEOMP::memory_usage()
+{
+  double bytes = FixLangevinNVE::memory_usage();
+  bytes += nthreads_rng * sizeof(RanMars *);
+  bytes += (nthreads_rng-1) * sizeof(RanMars);
+  return bytes;
+}
@@ -0,0 +1,48 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(langevin/nve/omp,FixLangevinNVEOMP)
+
+#else
+
+#ifndef LMP_FIX_LANGEVIN_NVE_OMP_H
+#define LMP_FIX_LANGEVIN_NVE_OMP_H
+
+#include "fix_langevin_nve.h"
+
+namespace LAMMPS_NS {
+
+class FixLangevinNVEOMP : public FixLangevinNVE {
+ public:
+  FixLangevinNVEOMP(class LAMMPS *, int, char **);
+  virtual ~FixLangevinNVEOMP();
+  void init();
+  virtual void initial_integrate(int);
+  virtual void final_integrate();
+  double memory_usage();
+
+ protected:
+  int nthreads_rng;
+  class RanMars **random_thr;
+
+ private:
+  template <int RMASS>
+  void final_thr(int, int, int);
+};
+
+}
+
+#endif
+#endif
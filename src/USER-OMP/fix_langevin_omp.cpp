@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "fix_langevin_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "group.h"
+#include "update.h"
+#include "random_mars.h"
+#include "random_philox.h"
+#include "error.h"
+
+#include "thr_omp.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{NOBIAS,BIAS};
+enum{CONSTANT,EQUAL,ATOM};
+enum{MARS,PHILOX};
+enum{RANFORCE,RANOMEGA,RANANGMOM};
+
+/* ---------------------------------------------------------------------- */
+
+FixLangevinOMP::FixLangevinOMP(LAMMPS *lmp, int narg, char **arg) :
+  FixLangevin(lmp, narg, arg)
+{
+  nthreads_rng = 0;
+  random_thr = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixLangevinOMP::~FixLangevinOMP()
+{
+  for (int i = 1; i < nthreads_rng; i++) delete random_thr[i];
+  delete [] random_thr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLangevinOMP::init()
+{
+  FixLangevin::init();
+
+  // one RNG per thread, thread 0 uses the RNG of the serial fix
+  //   so that results with one thread match fix langevin
+
+  if (nthreads_rng != comm->nthreads) {
+    for (int i = 1; i < nthreads_rng; i++) delete random_thr[i];
+    delete [] random_thr;
+    nthreads_rng = comm->nthreads;
+    random_thr = new RanMars*[nthreads_rng];
+    random_thr[0] = random;
+    for (int i = 1; i < nthreads_rng; i++)
+      random_thr[i] = new RanMars(lmp,seed + comm->me + comm->nprocs*i);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   threaded version of the thermostat without tally
+   a velocity bias is removed and restored by the temperature compute,
+     which is not thread-safe, so that case uses the serial version
+------------------------------------------------------------------------- */
+
+void FixLangevinOMP::post_force_no_tally()
+{
+  if (which == BIAS) {
+    FixLangevin::post_force_no_tally();
+    return;
+  }
+
+  double * const * const f = atom->f;
+  const int * const mask = atom->mask;
+  const int nlocal = atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+  compute_target();
+
+  bigint count;
+  if (zeroflag) {
+    count = group->count(igroup);
+    if (count == 0)
+      error->all(FLERR,"Cannot zero Langevin force of 0 atoms");
+  }
+
+  double fsum0 = 0.0;
+  double fsum1 = 0.0;
+  double fsum2 = 0.0;
+
+#if defined(_OPENMP)
+#pragma omp parallel reduction(+:fsum0,fsum1,fsum2)
+#endif
+  {
+    int ifrom, ito, tid;
+    double fsum[3];
+
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    fsum[0] = fsum[1] = fsum[2] = 0.0;
+
+    if (atom->rmass) eval_thr<1>(ifrom, ito, tid, fsum);
+    else eval_thr<0>(ifrom, ito, tid, fsum);
+
+    fsum0 += fsum[0];
+    fsum1 += fsum[1];
+    fsum2 += fsum[2];
+  }
+
+  // set total force to zero
+
+  if (zeroflag) {
+    double fsum[3],fsumall[3];
+    fsum[0] = fsum0;
+    fsum[1] = fsum1;
+    fsum[2] = fsum2;
+    MPI_Allreduce(fsum,fsumall,3,MPI_DOUBLE,MPI_SUM,world);
+    const double fx = fsumall[0] / count;
+    const double fy = fsumall[1] / count;
+    const double fz = fsumall[2] / count;
+    int i;
+
+#if defined(_OPENMP)
+#pragma omp parallel for private(i)
+#endif
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        f[i][0] -= fx;
+        f[i][1] -= fy;
+        f[i][2] -= fz;
+      }
+  }
+
+  // thermostat omega and angmom
+
+  if (oflag) omega_thermostat();
+  if (aflag) angmom_thermostat();
+}
+
+/* ----------------------------------------------------------------------
+   damping and random force for atoms ifrom to ito-1
+   random numbers come from this thread's RanMars or a private
+     instance of the counter-based RNG
+   tsqrt is shared between threads, so per-atom values are kept local
+------------------------------------------------------------------------- */
+
+template <int RMASS>
+void FixLangevinOMP::eval_thr(int ifrom, int ito, int tid, double *fsum)
+{
+  const double * const * const v = atom->v;
+  double * const * const f = atom->f;
+  const double * const rmass = atom->rmass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  const int * const tag = atom->tag;
+  const bigint ntimestep = update->ntimestep;
+
+  const double boltz = force->boltz;
+  const double dt = update->dt;
+  const double mvv2e = force->mvv2e;
+  const double ftm2v = force->ftm2v;
+
+  RanMars &rng = *random_thr[tid];
+  RanPhilox prng(seed);
+
+  double gamma1,gamma2,tsqrtone,fran[3];
+
+  for (int i = ifrom; i < ito; i++) {
+    if (mask[i] & groupbit) {
+      tsqrtone = (tstyle == ATOM) ? sqrt(tforce[i]) : tsqrt;
+      if (RMASS) {
+        gamma1 = -rmass[i] / t_period / ftm2v;
+        gamma2 = sqrt(rmass[i]) * sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
+        gamma1 *= 1.0/ratio[type[i]];
+        gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrtone;
+      } else {
+        gamma1 = gfactor1[type[i]];
+        gamma2 = gfactor2[type[i]] * tsqrtone;
+      }
+      if (rngstyle == PHILOX) {
+        prng.reset(tag[i],RANFORCE,ntimestep);
+        fran[0] = gamma2*(prng.uniform()-0.5);
+        fran[1] = gamma2*(prng.uniform()-0.5);
+        fran[2] = gamma2*(prng.uniform()-0.5);
+      } else {
+        fran[0] = gamma2*(rng.uniform()-0.5);
+        fran[1] = gamma2*(rng.uniform()-0.5);
+        fran[2] = gamma2*(rng.uniform()-0.5);
+      }
+      f[i][0] += gamma1*v[i][0] + fran[0];
+      f[i][1] += gamma1*v[i][1] + fran[1];
+      f[i][2] += gamma1*v[i][2] + fran[2];
+      fsum[0] += fran[0];
+      fsum[1] += fran[1];
+      fsum[2] += fran[2];
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixLangevinOMP::memory_usage()
+{
+  double bytes = FixLangevin::memory_usage();
+  bytes += nthreads_rng * sizeof(RanMars *);
+  bytes += (nthreads_rng-1) * sizeof(RanMars);
+  return bytes;
+}
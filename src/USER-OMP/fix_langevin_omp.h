@@ -0,0 +1,48 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(langevin/omp,FixLangevinOMP)
+
+#else
+
+#ifndef LMP_FIX_LANGEVIN_OMP_H
+#define LMP_FIX_LANGEVIN_OMP_H
+
+#include "fix_langevin.h"
+
+namespace LAMMPS_NS {
+
+class FixLangevinOMP : public FixLangevin {
+ public:
+  FixLangevinOMP(class LAMMPS *, int, char **);
+  virtual ~FixLangevinOMP();
+  void init();
+  double memory_usage();
+
+ protected:
+  int nthreads_rng;
+  class RanMars **random_thr;
+
+  virtual void post_force_no_tally();
+
+ private:
+  template <int RMASS>
+  void eval_thr(int, int, int, double *);
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "fix_msst_omp.h"
+#include "atom.h"
+#include "comm.h"
+
+#include "thr_omp.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+FixMSSTOMP::FixMSSTOMP(LAMMPS *lmp, int narg, char **arg) :
+  FixMSST(lmp, narg, arg)
+{
+  nthreads_t = 0;
+  t_thr = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMSSTOMP::~FixMSSTOMP()
+{
+  delete [] t_thr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSSTOMP::init()
+{
+  FixMSST::init();
+
+  if (nthreads_t != comm->nthreads) {
+    delete [] t_thr;
+    nthreads_t = comm->nthreads;
+    t_thr = new double[7*nthreads_t];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   threaded versions of the FixMSST passes over atoms
+   each thread sums into its own slot of t_thr, slots are summed after
+------------------------------------------------------------------------- */
+
+void FixMSSTOMP::thermo_local(double *t)
+{
+  const int nlocal = atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    thermo_range(ifrom, ito, &t_thr[7*tid]);
+  }
+  sum_thr(t, 7);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMSSTOMP::vsum_trial(double vol)
+{
+  const int nlocal = atom->nlocal;
+  const int nthreads = comm->nthreads;
+  double vsum;
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    t_thr[7*tid] = vsum_range(ifrom, ito, vol);
+  }
+  sum_thr(&vsum, 1);
+  return vsum;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSSTOMP::propagate_v(double vol, double *t)
+{
+  const int nlocal = atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    propagate_v_range(ifrom, ito, vol, t ? &t_thr[7*tid] : NULL);
+  }
+  if (t) sum_thr(t, 7);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSSTOMP::propagate_x()
+{
+  const int nlocal = atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    propagate_x_range(ifrom, ito);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sum first n values of the per-thread slots into t
+------------------------------------------------------------------------- */
+
+void FixMSSTOMP::sum_thr(double *t, int n)
+{
+  for (int k = 0; k < n; k++) t[k] = 0.0;
+  for (int i = 0; i < comm->nthreads; i++)
+    for (int k = 0; k < n; k++) t[k] += t_thr[7*i+k];
+}
@@ -0,0 +1,49 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(msst/omp,FixMSSTOMP)
+
+#else
+
+#ifndef LMP_FIX_MSST_OMP_H
+#define LMP_FIX_MSST_OMP_H
+
+#include "fix_msst.h"
+
+namespace LAMMPS_NS {
+
+class FixMSSTOMP : public FixMSST {
+ public:
+  FixMSSTOMP(class LAMMPS *, int, char **);
+  virtual ~FixMSSTOMP();
+  virtual void init();
+
+ protected:
+  int nthreads_t;
+  double *t_thr;                   // per-thread partial sums
+
+  virtual void thermo_local(double *);
+  virtual double vsum_trial(double);
+  virtual void propagate_v(double, double *);
+  virtual void propagate_x();
+
+ private:
+  void sum_thr(double *, int);
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,515 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "string.h"
+#include "fix_nh_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "compute_temp.h"
+#include "compute_pressure.h"
+#include "force.h"
+#include "kspace.h"
+#include "update.h"
+
+#include "thr_omp.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{NOBIAS,BIAS};
+enum{ISO,ANISO,TRICLINIC};
+
+/* ---------------------------------------------------------------------- */
+
+FixNHOMP::FixNHOMP(LAMMPS *lmp, int narg, char **arg) :
+  FixNH(lmp, narg, arg)
+{
+  fused = 0;
+  nthreads_ke = 0;
+  ke_thr = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixNHOMP::~FixNHOMP()
+{
+  delete [] ke_thr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNHOMP::init()
+{
+  FixNH::init();
+
+  // KE tensor can be accumulated in the velocity update and reduced
+  //   together with the virial if the temperature is a plain compute temp
+  //   on the same group as this fix and the pressure a plain compute pressure
+  // otherwise the threaded per-pass routines are used with the usual
+  //   compute invocations of FixNH
+
+  fused = 0;
+  if (which == NOBIAS && strcmp(temperature->style,"temp") == 0 &&
+      temperature->igroup == igroup &&
+      (!pstat_flag || strcmp(pressure->style,"pressure") == 0)) fused = 1;
+
+  if (nthreads_ke != comm->nthreads) {
+    delete [] ke_thr;
+    nthreads_ke = comm->nthreads;
+    ke_thr = new double[6*nthreads_ke];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   1st half of Verlet update
+   same sequence as FixNH::initial_integrate() with the KE tensor and
+     virial reduced in one collective and consecutive passes merged
+------------------------------------------------------------------------- */
+
+void FixNHOMP::initial_integrate(int vflag)
+{
+  if (!fused) {
+    FixNH::initial_integrate(vflag);
+    return;
+  }
+
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+  // update eta_press_dot
+
+  if (pstat_flag && mpchain) nhc_press_integrate();
+
+  // update eta_dot
+
+  if (tstat_flag) {
+    compute_temp_target();
+    nhc_temp_integrate();
+  }
+
+  if (!pstat_flag) {
+
+    // no box remap between velocity and position update
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+    {
+      int ifrom, ito, tid;
+      loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+      if (atom->rmass) nve_vx_thr<1>(ifrom, ito);
+      else nve_vx_thr<0>(ifrom, ito);
+    }
+    return;
+  }
+
+  // need to recompute pressure to account for change in KE
+
+  double ke[6];
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    if (atom->rmass) ke_thr_eval<1>(ifrom, ito, &ke_thr[6*tid]);
+    else ke_thr_eval<0>(ifrom, ito, &ke_thr[6*tid]);
+  }
+  sum_ke_thr(ke);
+  reduce_temp_press(ke);
+
+  compute_press_target();
+  nh_omega_dot();
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    if (atom->rmass) press_nve_v_thr<1>(ifrom, ito);
+    else press_nve_v_thr<0>(ifrom, ito);
+  }
+
+  // remap simulation box by 1/2 step
+
+  remap();
+
+  nve_x();
+
+  // remap simulation box by 1/2 step
+  // redo KSpace coeffs since volume has changed
+
+  remap();
+  if (kspace_flag) force->kspace->setup();
+}
+
+/* ----------------------------------------------------------------------
+   2nd half of Verlet update
+   velocity update, barostat scaling and KE tensor in a single pass,
+     then one collective for the KE tensor and the virial
+------------------------------------------------------------------------- */
+
+void FixNHOMP::final_integrate()
+{
+  if (!fused) {
+    FixNH::final_integrate();
+    return;
+  }
+
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  const int nthreads = comm->nthreads;
+  double ke[6];
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    if (atom->rmass) {
+      if (pstat_flag) nve_v_ke_thr<1,1>(ifrom, ito, &ke_thr[6*tid]);
+      else nve_v_ke_thr<1,0>(ifrom, ito, &ke_thr[6*tid]);
+    } else {
+      if (pstat_flag) nve_v_ke_thr<0,1>(ifrom, ito, &ke_thr[6*tid]);
+      else nve_v_ke_thr<0,0>(ifrom, ito, &ke_thr[6*tid]);
+    }
+  }
+  sum_ke_thr(ke);
+
+  // compute new T,P
+
+  reduce_temp_press(ke);
+  t_current = temperature->scalar;
+
+  if (pstat_flag) nh_omega_dot();
+
+  // update eta_dot
+  // update eta_press_dot
+
+  if (tstat_flag) nhc_temp_integrate();
+  if (pstat_flag && mpchain) nhc_press_integrate();
+}
+
+/* ----------------------------------------------------------------------
+   sum local KE tensor and virial across procs in one collective
+   set temperature and pressure from the result
+   compute appropriately coupled elements of mvv_current
+------------------------------------------------------------------------- */
+
+void FixNHOMP::reduce_temp_press(double *ke)
+{
+  double local[12],all[12];
+  int n = 6;
+
+  for (int i = 0; i < 6; i++) local[i] = ke[i];
+  if (pstat_flag) {
+    ((ComputePressure *) pressure)->virial_local(&local[6],6);
+    n = 12;
+  }
+
+  MPI_Allreduce(local,all,n,MPI_DOUBLE,MPI_SUM,world);
+
+  ((ComputeTemp *) temperature)->compute_reduced(all);
+
+  if (pstat_flag) {
+    if (pstyle == ISO)
+      ((ComputePressure *) pressure)->compute_scalar_reduced(&all[6]);
+    else ((ComputePressure *) pressure)->compute_vector_reduced(&all[6]);
+    couple();
+    pressure->addstep(update->ntimestep+1);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sum per-thread KE tensors in thread order
+------------------------------------------------------------------------- */
+
+void FixNHOMP::sum_ke_thr(double *ke)
+{
+  for (int k = 0; k < 6; k++) ke[k] = 0.0;
+  for (int t = 0; t < comm->nthreads; t++)
+    for (int k = 0; k < 6; k++) ke[k] += ke_thr[6*t+k];
+}
+
+/* ----------------------------------------------------------------------
+   threaded versions of the FixNH passes over atoms
+   a velocity bias is removed and restored by the temperature compute,
+     which is not thread-safe, so that case uses the serial versions
+------------------------------------------------------------------------- */
+
+void FixNHOMP::nve_v()
+{
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  const double * const * const f = atom->f;
+  double * const * const v = atom->v;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  int i;
+
+#if defined(_OPENMP)
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      const double dtfm = dtf / (rmass ? rmass[i] : mass[type[i]]);
+      v[i][0] += dtfm*f[i][0];
+      v[i][1] += dtfm*f[i][1];
+      v[i][2] += dtfm*f[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNHOMP::nve_x()
+{
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  double * const * const x = atom->x;
+  const double * const * const v = atom->v;
+  const int * const mask = atom->mask;
+  int i;
+
+  // x update by full step only for atoms in group
+
+#if defined(_OPENMP)
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      x[i][0] += dtv * v[i][0];
+      x[i][1] += dtv * v[i][1];
+      x[i][2] += dtv * v[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNHOMP::nh_v_press()
+{
+  if (which == BIAS) {
+    FixNH::nh_v_press();
+    return;
+  }
+
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  const int nthreads = comm->nthreads;
+
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+  {
+    int ifrom, ito, tid;
+    loop_setup_thr(ifrom, ito, tid, nlocal, nthreads);
+    nh_v_press_thr(ifrom, ito);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNHOMP::nh_v_temp()
+{
+  if (which == BIAS) {
+    FixNH::nh_v_temp();
+    return;
+  }
+
+  const int nlocal = (igroup == atom->firstgroup) ? atom->nfirst : atom->nlocal;
+  double * const * const v = atom->v;
+  const int * const mask = atom->mask;
+  const double factor = factor_eta;
+  int i;
+
+#if defined(_OPENMP)
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      v[i][0] *= factor;
+      v[i][1] *= factor;
+      v[i][2] *= factor;
+    }
+}
+
+/* ----------------------------------------------------------------------
+   per-thread kernels for atoms ifrom to ito-1
+------------------------------------------------------------------------- */
+
+void FixNHOMP::nh_v_press_thr(int ifrom, int ito)
+{
+  double * const * const v = atom->v;
+  const int * const mask = atom->mask;
+  double factor[3];
+
+  factor[0] = exp(-dt4*(omega_dot[0]+mtk_term2));
+  factor[1] = exp(-dt4*(omega_dot[1]+mtk_term2));
+  factor[2] = exp(-dt4*(omega_dot[2]+mtk_term2));
+
+  for (int i = ifrom; i < ito; i++)
+    if (mask[i] & groupbit) {
+      v[i][0] *= factor[0];
+      v[i][1] *= factor[1];
+      v[i][2] *= factor[2];
+      if (pstyle == TRICLINIC) {
+        v[i][0] += -dthalf*(v[i][1]*omega_dot[5] + v[i][2]*omega_dot[4]);
+        v[i][1] += -dthalf*v[i][2]*omega_dot[3];
+      }
+      v[i][0] *= factor[0];
+      v[i][1] *= factor[1];
+      v[i][2] *= factor[2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int RMASS>
+void FixNHOMP::ke_thr_eval(int ifrom, int ito, double *ke)
+{
+  const double * const * const v = atom->v;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  double massone;
+
+  for (int k = 0; k < 6; k++) ke[k] = 0.0;
+
+  for (int i = ifrom; i < ito; i++)
+    if (mask[i] & groupbit) {
+      massone = RMASS ? rmass[i] : mass[type[i]];
+      ke[0] += massone * v[i][0]*v[i][0];
+      ke[1] += massone * v[i][1]*v[i][1];
+      ke[2] += massone * v[i][2]*v[i][2];
+      ke[3] += massone * v[i][0]*v[i][1];
+      ke[4] += massone * v[i][0]*v[i][2];
+      ke[5] += massone * v[i][1]*v[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int RMASS>
+void FixNHOMP::nve_vx_thr(int ifrom, int ito)
+{
+  double * const * const x = atom->x;
+  double * const * const v = atom->v;
+  const double * const * const f = atom->f;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  double dtfm;
+
+  for (int i = ifrom; i < ito; i++)
+    if (mask[i] & groupbit) {
+      dtfm = dtf / (RMASS ? rmass[i] : mass[type[i]]);
+      v[i][0] += dtfm*f[i][0];
+      v[i][1] += dtfm*f[i][1];
+      v[i][2] += dtfm*f[i][2];
+      x[i][0] += dtv * v[i][0];
+      x[i][1] += dtv * v[i][1];
+      x[i][2] += dtv * v[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int RMASS>
+void FixNHOMP::press_nve_v_thr(int ifrom, int ito)
+{
+  double * const * const v = atom->v;
+  const double * const * const f = atom->f;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  double dtfm,factor[3];
+
+  factor[0] = exp(-dt4*(omega_dot[0]+mtk_term2));
+  factor[1] = exp(-dt4*(omega_dot[1]+mtk_term2));
+  factor[2] = exp(-dt4*(omega_dot[2]+mtk_term2));
+
+  for (int i = ifrom; i < ito; i++)
+    if (mask[i] & groupbit) {
+      v[i][0] *= factor[0];
+      v[i][1] *= factor[1];
+      v[i][2] *= factor[2];
+      if (pstyle == TRICLINIC) {
+        v[i][0] += -dthalf*(v[i][1]*omega_dot[5] + v[i][2]*omega_dot[4]);
+        v[i][1] += -dthalf*v[i][2]*omega_dot[3];
+      }
+      v[i][0] *= factor[0];
+      v[i][1] *= factor[1];
+      v[i][2] *= factor[2];
+
+      dtfm = dtf / (RMASS ? rmass[i] : mass[type[i]]);
+      v[i][0] += dtfm*f[i][0];
+      v[i][1] += dtfm*f[i][1];
+      v[i][2] += dtfm*f[i][2];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int RMASS, int PSTAT>
+void FixNHOMP::nve_v_ke_thr(int ifrom, int ito, double *ke)
+{
+  double * const * const v = atom->v;
+  const double * const * const f = atom->f;
+  const double * const rmass = atom->rmass;
+  const double * const mass = atom->mass;
+  const int * const type = atom->type;
+  const int * const mask = atom->mask;
+  double massone,dtfm,factor[3];
+
+  if (PSTAT) {
+    factor[0] = exp(-dt4*(omega_dot[0]+mtk_term2));
+    factor[1] = exp(-dt4*(omega_dot[1]+mtk_term2));
+    factor[2] = exp(-dt4*(omega_dot[2]+mtk_term2));
+  }
+
+  for (int k = 0; k < 6; k++) ke[k] = 0.0;
+
+  for (int i = ifrom; i < ito; i++)
+    if (mask[i] & groupbit) {
+      massone = RMASS ? rmass[i] : mass[type[i]];
+      dtfm = dtf / massone;
+      v[i][0] += dtfm*f[i][0];
+      v[i][1] += dtfm*f[i][1];
+      v[i][2] += dtfm*f[i][2];
+
+      if (PSTAT) {
+        v[i][0] *= factor[0];
+        v[i][1] *= factor[1];
+        v[i][2] *= factor[2];
+        if (pstyle == TRICLINIC) {
+          v[i][0] += -dthalf*(v[i][1]*omega_dot[5] + v[i][2]*omega_dot[4]);
+          v[i][1] += -dthalf*v[i][2]*omega_dot[3];
+        }
+        v[i][0] *= factor[0];
+        v[i][1] *= factor[1];
+        v[i][2] *= factor[2];
+      }
+
+      ke[0] += massone * v[i][0]*v[i][0];
+      ke[1] += massone * v[i][1]*v[i][1];
+      ke[2] += massone * v[i][2]*v[i][2];
+      ke[3] += massone * v[i][0]*v[i][1];
+      ke[4] += massone * v[i][0]*v[i][2];
+      ke[5] += massone * v[i][1]*v[i][2];
+    }
+}
@@ -0,0 +1,52 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_FIX_NH_OMP_H
+#define LMP_FIX_NH_OMP_H
+
+#include "fix_nh.h"
+
+namespace LAMMPS_NS {
+
+class FixNHOMP : public FixNH {
+ public:
+  FixNHOMP(class LAMMPS *, int, char **);
+  virtual ~FixNHOMP();
+  virtual void init();
+  virtual void initial_integrate(int);
+  virtual void final_integrate();
+
+ protected:
+  int fused;                       // 1 if KE/virial reduction is fused
+  int nthreads_ke;
+  double *ke_thr;                  // per-thread partial KE tensors
+
+  virtual void nve_x();
+  virtual void nve_v();
+  virtual void nh_v_press();
+  virtual void nh_v_temp();
+
+  void reduce_temp_press(double *);
+
+ private:
+  template <int RMASS> void ke_thr_eval(int, int, double *);
+  template <int RMASS> void nve_vx_thr(int, int);
+  template <int RMASS> void press_nve_v_thr(int, int);
+  template <int RMASS, int PSTAT> void nve_v_ke_thr(int, int, double *);
+  void nh_v_press_thr(int, int);
+  void sum_ke_thr(double *);
+};
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "neigh_list.h"
 #include "update.h"
 #include "random_mars.h"
+#include "random_philox.h"
 
 #include "suffix.h"
 using namespace LAMMPS_NS;
@@ -122,6 +123,9 @@ void PairDPDOMP::eval(int iifrom, int iito, ThrData * const thr)
   const double dtinvsqrt = 1.0/sqrt(update->dt);
   double fxtmp,fytmp,fztmp;
   RanMars &rng = *random_thr[thr->get_tid()];
+  RanPhilox philox(seed);
+  const int * const tag = atom->tag;
+  const bigint ntimestep = update->ntimestep;
 
   ilist = list->ilist;
   numneigh = list->numneigh;
@@ -163,7 +167,11 @@ void PairDPDOMP::eval(int iifrom, int iito, ThrData * const thr)
         delvz = vztmp - v[j][2];
         dot = delx*delvx + dely*delvy + delz*delvz;
         wd = 1.0 - r/cut[itype][jtype];
-        randnum = rng.gaussian();
+        if (rngstyle == PHILOX) {
+          if (tag[i] < tag[j]) philox.reset(tag[i],tag[j],ntimestep);
+          else philox.reset(tag[j],tag[i],ntimestep);
+          randnum = philox.gaussian();
+        } else randnum = rng.gaussian();
 
         // conservative force = a0 * wd
         // drag force = -gamma * wd^2 * (delx dot delv) / r
@@ -21,6 +21,7 @@
 #include "neigh_list.h"
 #include "update.h"
 #include "random_mars.h"
+#include "random_philox.h"
 
 #include "suffix.h"
 using namespace LAMMPS_NS;
@@ -120,6 +121,9 @@ void PairDPDTstatOMP::eval(int iifrom, int iito, ThrData * const thr)
   const double dtinvsqrt = 1.0/sqrt(update->dt);
   double fxtmp,fytmp,fztmp;
   RanMars &rng = *random_thr[thr->get_tid()];
+  RanPhilox philox(seed);
+  const int * const tag = atom->tag;
+  const bigint ntimestep = update->ntimestep;
 
   // adjust sigma if target T is changing
 
@@ -173,7 +177,11 @@ void PairDPDTstatOMP::eval(int iifrom, int iito, ThrData * const thr)
         delvz = vztmp - v[j][2];
         dot = delx*delvx + dely*delvy + delz*delvz;
         wd = 1.0 - r/cut[itype][jtype];
-        randnum = rng.gaussian();
+        if (rngstyle == PHILOX) {
+          if (tag[i] < tag[j]) philox.reset(tag[i],tag[j],ntimestep);
+          else philox.reset(tag[j],tag[i],ntimestep);
+          randnum = philox.gaussian();
+        } else randnum = rng.gaussian();
 
         // drag force = -gamma * wd^2 * (delx dot delv) / r
         // random force = sigma * wd * rnd * dtinvsqrt;
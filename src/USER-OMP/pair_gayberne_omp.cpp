@@ -46,12 +46,23 @@ void PairGayBerneOMP::compute(int eflag, int vflag)
   const int nthreads = comm->nthreads;
   const int inum = list->inum;
 
+  grow_cache();
+
 #if defined(_OPENMP)
 #pragma omp parallel default(none) shared(eflag,vflag)
 #endif
   {
     int ifrom, ito, tid;
 
+    // matrices of each ellipsoid are computed once, not once per neighbor
+
+    const int * const type = atom->type;
+    loop_setup_thr(ifrom, ito, tid, nall, nthreads);
+    for (int i = ifrom; i < ito; ++i)
+      if (form[type[i]][type[i]] == ELLIPSE_ELLIPSE)
+        precompute_i(i,wcache[i]);
+    sync_threads();
+
     loop_setup_thr(ifrom, ito, tid, inum, nthreads);
     ThrData *thr = fix->get_thr(tid);
     ev_setup_thr(eflag, vflag, nall, eatom, vatom, thr);
@@ -79,9 +90,7 @@ void PairGayBerneOMP::eval(int iifrom, int iito, ThrData * const thr)
   int i,j,ii,jj,jnum,itype,jtype;
   double evdwl,one_eng,rsq,r2inv,r6inv,forcelj,factor_lj;
   double fforce[3],ttor[3],rtor[3],r12[3];
-  double a1[3][3],b1[3][3],g1[3][3],a2[3][3],b2[3][3],g2[3][3],temp[3][3];
   int *ilist,*jlist,*numneigh,**firstneigh;
-  double *iquat,*jquat;
 
   const double * const * const x = atom->x;
   double * const * const f = thr->get_f();
@@ -89,9 +98,6 @@ void PairGayBerneOMP::eval(int iifrom, int iito, ThrData * const thr)
   const int * const type = atom->type;
   const int nlocal = atom->nlocal;
   const double * const special_lj = force->special_lj;
-  const int * const ellipsoid = atom->ellipsoid;
-
-  AtomVecEllipsoid::Bonus *bonus = avec->bonus;
 
   double fxtmp,fytmp,fztmp,t1tmp,t2tmp,t3tmp;
 
@@ -106,15 +112,7 @@ void PairGayBerneOMP::eval(int iifrom, int iito, ThrData * const thr)
     i = ilist[ii];
     itype = type[i];
     fxtmp=fytmp=fztmp=t1tmp=t2tmp=t3tmp=0.0;
-
-    if (form[itype][itype] == ELLIPSE_ELLIPSE) {
-      iquat = bonus[ellipsoid[i]].quat;
-      MathExtra::quat_to_mat_trans(iquat,a1);
-      MathExtra::diag_times3(well[itype],a1,temp);
-      MathExtra::transpose_times3(a1,temp,b1);
-      MathExtra::diag_times3(shape2[itype],a1,temp);
-      MathExtra::transpose_times3(a1,temp,g1);
-    }
+    GBVars &wi = wcache[i];
 
     jlist = firstneigh[i];
     jnum = numneigh[i];
@@ -151,29 +149,19 @@ void PairGayBerneOMP::eval(int iifrom, int iito, ThrData * const thr)
           break;
 
         case SPHERE_ELLIPSE:
-          jquat = bonus[ellipsoid[j]].quat;
-          MathExtra::quat_to_mat_trans(jquat,a2);
-          MathExtra::diag_times3(well[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,b2);
-          MathExtra::diag_times3(shape2[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,g2);
-          one_eng = gayberne_lj(j,i,a2,b2,g2,r12,rsq,fforce,rtor);
+          one_eng = gayberne_lj(j,i,wcache[j].a,wcache[j].b,wcache[j].g,
+                                r12,rsq,fforce,rtor);
           ttor[0] = ttor[1] = ttor[2] = 0.0;
           break;
 
         case ELLIPSE_SPHERE:
-          one_eng = gayberne_lj(i,j,a1,b1,g1,r12,rsq,fforce,ttor);
+          one_eng = gayberne_lj(i,j,wi.a,wi.b,wi.g,r12,rsq,fforce,ttor);
           rtor[0] = rtor[1] = rtor[2] = 0.0;
           break;
 
         default:
-          jquat = bonus[ellipsoid[j]].quat;
-          MathExtra::quat_to_mat_trans(jquat,a2);
-          MathExtra::diag_times3(well[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,b2);
-          MathExtra::diag_times3(shape2[jtype],a2,temp);
-          MathExtra::transpose_times3(a2,temp,g2);
-          one_eng = gayberne_analytic(i,j,a1,a2,b1,b2,g1,g2,r12,rsq,
+          one_eng = gayberne_analytic(i,j,wi.a,wcache[j].a,wi.b,wcache[j].b,
+                                      wi.g,wcache[j].g,r12,rsq,
                                       fforce,ttor,rtor);
           break;
         }
@@ -46,12 +46,23 @@ void PairRESquaredOMP::compute(int eflag, int vflag)
   const int nthreads = comm->nthreads;
   const int inum = list->inum;
 
+  grow_cache();
+
 #if defined(_OPENMP)
 #pragma omp parallel default(none) shared(eflag,vflag)
 #endif
   {
     int ifrom, ito, tid;
 
+    // temporaries of each ellipsoid (not a LJ sphere) are computed once,
+    // not once per neighbor
+
+    const int * const type = atom->type;
+    loop_setup_thr(ifrom, ito, tid, nall, nthreads);
+    for (int i = ifrom; i < ito; ++i)
+      if (lshape[type[i]] != 0.0) precompute_i(i,wcache[i]);
+    sync_threads();
+
     loop_setup_thr(ifrom, ito, tid, inum, nthreads);
     ThrData *thr = fix->get_thr(tid);
     ev_setup_thr(eflag, vflag, nall, eatom, vatom, thr);
@@ -80,7 +91,6 @@ void PairRESquaredOMP::eval(int iifrom, int iito, ThrData * const thr)
   double evdwl,one_eng,rsq,r2inv,r6inv,forcelj,factor_lj;
   double fforce[3],ttor[3],rtor[3],r12[3];
   int *ilist,*jlist,*numneigh,**firstneigh;
-  RE2Vars wi,wj;
 
   const double * const * const x = atom->x;
   double * const * const f = thr->get_f();
@@ -102,10 +112,7 @@ void PairRESquaredOMP::eval(int iifrom, int iito, ThrData * const thr)
     i = ilist[ii];
     itype = type[i];
     fxtmp=fytmp=fztmp=t1tmp=t2tmp=t3tmp=0.0;
-
-    // not a LJ sphere
-
-    if (lshape[itype] != 0.0) precompute_i(i,wi);
+    const RE2Vars &wi = wcache[i];
 
     jlist = firstneigh[i];
     jnum = numneigh[i];
@@ -144,14 +151,13 @@ void PairRESquaredOMP::eval(int iifrom, int iito, ThrData * const thr)
           break;
 
          case SPHERE_ELLIPSE:
-          precompute_i(j,wj);
           if (NEWTON_PAIR || j < nlocal) {
-            one_eng = resquared_lj(j,i,wj,r12,rsq,fforce,rtor,true);
+            one_eng = resquared_lj(j,i,wcache[j],r12,rsq,fforce,rtor,true);
             tor[j][0] += rtor[0]*factor_lj;
             tor[j][1] += rtor[1]*factor_lj;
             tor[j][2] += rtor[2]*factor_lj;
           } else
-            one_eng = resquared_lj(j,i,wj,r12,rsq,fforce,rtor,false);
+            one_eng = resquared_lj(j,i,wcache[j],r12,rsq,fforce,rtor,false);
           break;
 
          case ELLIPSE_SPHERE:
@@ -162,8 +168,8 @@ void PairRESquaredOMP::eval(int iifrom, int iito, ThrData * const thr)
           break;
 
          default:
-          precompute_i(j,wj);
-          one_eng = resquared_analytic(i,j,wi,wj,r12,rsq,fforce,ttor,rtor);
+          one_eng = resquared_analytic(i,j,wi,wcache[j],r12,rsq,
+                                       fforce,ttor,rtor);
           t1tmp += ttor[0]*factor_lj;
           t2tmp += ttor[1]*factor_lj;
           t3tmp += ttor[2]*factor_lj;
@@ -77,8 +77,9 @@ void PairTableOMP::eval(int iifrom, int iito, ThrData * const thr)
 {
   int i,j,ii,jj,jnum,itype,jtype,itable;
   double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
-  double rsq,factor_lj,fraction,value,a,b;
+  double rsq,factor_lj,fraction,value;
   int *ilist,*jlist,*numneigh,**firstneigh;
+  const double *coeff;
   Table *tb;
 
   union_int_float_t rsq_lookup;
@@ -129,36 +130,18 @@ void PairTableOMP::eval(int iifrom, int iito, ThrData * const thr)
                             FLERR,"Pair distance < table inner cutoff"))
           return;
 
-        if (tabstyle == LOOKUP) {
-          itable = static_cast<int> ((rsq - tb->innersq) * tb->invdelta);
+        if (tabstyle != BITMAP) {
+          fraction = (rsq - tb->innersq) * tb->invdelta;
+          itable = static_cast<int> (fraction);
 
           if (check_error_thr((itable >= tlm1),tid,
                               FLERR,"Pair distance > table outer cutoff"))
             return;
 
-          fpair = factor_lj * tb->f[itable];
-        } else if (tabstyle == LINEAR) {
-          itable = static_cast<int> ((rsq - tb->innersq) * tb->invdelta);
-
-          if (check_error_thr((itable >= tlm1),tid,
-                              FLERR,"Pair distance > table outer cutoff"))
-            return;
-
-          fraction = (rsq - tb->rsq[itable]) * tb->invdelta;
-          value = tb->f[itable] + fraction*tb->df[itable];
-          fpair = factor_lj * value;
-        } else if (tabstyle == SPLINE) {
-          itable = static_cast<int> ((rsq - tb->innersq) * tb->invdelta);
-
-          if (check_error_thr((itable >= tlm1),tid,
-                              FLERR,"Pair distance > table outer cutoff"))
-            return;
-
-          b = (rsq - tb->rsq[itable]) * tb->invdelta;
-          a = 1.0 - b;
-          value = a * tb->f[itable] + b * tb->f[itable+1] +
-            ((a*a*a-a)*tb->f2[itable] + (b*b*b-b)*tb->f2[itable+1]) *
-            tb->deltasq6;
+          fraction -= itable;
+          coeff = &tb->coeff[8*itable];
+          value = coeff[0] + fraction*(coeff[1] +
+                                       fraction*(coeff[2] + fraction*coeff[3]));
           fpair = factor_lj * value;
         } else {
           rsq_lookup.f = rsq;
@@ -179,14 +162,11 @@ void PairTableOMP::eval(int iifrom, int iito, ThrData * const thr)
         }
 
         if (EFLAG) {
-          if (tabstyle == LOOKUP)
-            evdwl = tb->e[itable];
-          else if (tabstyle == LINEAR || tabstyle == BITMAP)
-            evdwl = tb->e[itable] + fraction*tb->de[itable];
+          if (tabstyle != BITMAP)
+            evdwl = coeff[4] + fraction*(coeff[5] +
+                                         fraction*(coeff[6] + fraction*coeff[7]));
           else
-            evdwl = a * tb->e[itable] + b * tb->e[itable+1] +
-              ((a*a*a-a)*tb->e2[itable] + (b*b*b-b)*tb->e2[itable+1]) *
-              tb->deltasq6;
+            evdwl = tb->e[itable] + fraction*tb->de[itable];
           evdwl *= factor_lj;
         }
 
@@ -82,7 +82,7 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   radius = rmass = NULL;
   vfrac = s0 = NULL;
   x0 = NULL;
-  ellipsoid = line = tri = NULL;
+  ellipsoid = line = tri = body = NULL;
   spin = NULL;
   eradius = ervel = erforce = NULL;
   cs = csforce = vforce = ervelforce = NULL;
@@ -114,7 +114,7 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   // customize by adding new flag
 
   static_polarizability_flag = 0;
-  sphere_flag = ellipsoid_flag = line_flag = tri_flag = 0;
+  sphere_flag = ellipsoid_flag = line_flag = tri_flag = body_flag = 0;
   peri_flag = electron_flag = 0;
   wavepacket_flag = sph_flag = 0;
 
@@ -273,7 +273,7 @@ void Atom::create_avec(const char *style, int narg, char **arg, char *suffix)
   // may have been set by old avec
   // customize by adding new flag
 
-  sphere_flag = ellipsoid_flag = line_flag = tri_flag = 0;
+  sphere_flag = ellipsoid_flag = line_flag = tri_flag = body_flag = 0;
   peri_flag = electron_flag = 0;
 
   static_polarizability_flag = 0;
@@ -470,6 +470,15 @@ void Atom::tag_extend()
 
   int itag = maxtag_all + notag_sum - notag + 1;
   for (int i = 0; i < nlocal; i++) if (tag[i] == 0) tag[i] = itag++;
+
+  // grow map array so new tags can be mapped
+  // max new tag is the same on all procs, so map_tag_max stays the same
+
+  if (map_style == 1 && map_array) {
+    int notag_all;
+    MPI_Allreduce(&notag,&notag_all,1,MPI_INT,MPI_SUM,world);
+    map_grow_array(maxtag_all + notag_all);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -197,6 +197,11 @@ class Atom : protected Pointers {
   void map_clear();
   void map_set();
   void map_one(int, int);
+  void map_erase(int);
+  void map_drop_ghost();
+  void map_new_owned(int);
+  void delete_owned(int);
+  void map_grow_array(int);
   void map_delete();
   int map_find_hash(int);
 
@@ -236,6 +241,7 @@ class Atom : protected Pointers {
   char *memstr;                   // string of array names already counted
 
   void setup_sort_bins();
+  void map_grow_hash(int);
   int next_prime(int);
 };
 
@@ -13,6 +13,7 @@
 
 #include "math.h"
 #include "atom.h"
+#include "atom_vec.h"
 #include "comm.h"
 #include "memory.h"
 #include "error.h"
@@ -91,8 +92,14 @@ void Atom::map_init()
 
 void Atom::map_clear()
 {
+  int nall = nlocal + nghost;
+  if (nall > smax) {
+    smax = nall + EXTRA;
+    memory->destroy(sametag);
+    memory->create(sametag,smax,"atom:sametag");
+  }
+
   if (map_style == 1) {
-    int nall = nlocal + nghost;
     for (int i = 0; i < nall; i++) {
       sametag[i] = -1;
       map_array[tag[i]] = -1;
@@ -100,7 +107,6 @@ void Atom::map_clear()
 
   } else {
     int previous,global,ibucket,index;
-    int nall = nlocal + nghost;
     for (int i = 0; i < nall; i++) {
       sametag[i] = -1;
 
@@ -137,7 +143,7 @@ void Atom::map_clear()
      and owned atoms take precedence over images
    this enables valid lookups of bond topology atoms
    for hash table option:
-     if hash table too small, re-init
+     if hash table too small, grow it
      global ID may already be in table if image atom was set
 ------------------------------------------------------------------------- */
 
@@ -158,7 +164,7 @@ void Atom::map_set()
 
   } else {
     int previous,global,ibucket,index;
-    if (nall > map_nhash) map_init();
+    if (map_nused + nall > map_nhash) map_grow_hash(map_nused + nall);
 
     for (int i = nall-1; i >= 0 ; i--) {
       sametag[i] = map_find_hash(tag[i]);
@@ -200,13 +206,16 @@ void Atom::map_set()
    set global to local map for one atom
    for hash table option:
      global ID may already be in table if atom was already set
-   called by Special class
+     if hash table is full, grow it
+   called by Special class and by commands that add atoms one at a time
 ------------------------------------------------------------------------- */
 
 void Atom::map_one(int global, int local)
 {
   if (map_style == 1) map_array[global] = local;
   else {
+    if (map_nused == map_nhash) map_grow_hash(map_nused+1);
+
     // search for key
     // if found it, just overwrite local value with index
 
@@ -238,6 +247,84 @@ void Atom::map_one(int global, int local)
   }
 }
 
+/* ----------------------------------------------------------------------
+   remove global to local map for one atom ID
+   for hash table option:
+     global ID may not be in table if it was never set
+   called when an owned atom is deleted, so map stays valid w/out map_init()
+------------------------------------------------------------------------- */
+
+void Atom::map_erase(int global)
+{
+  if (map_style == 1) map_array[global] = -1;
+  else {
+    // search for key
+    // if don't find it, done
+
+    int previous = -1;
+    int ibucket = global % map_nbucket;
+    int index = map_bucket[ibucket];
+    while (index > -1) {
+      if (map_hash[index].global == global) break;
+      previous = index;
+      index = map_hash[index].next;
+    }
+    if (index == -1) return;
+
+    // delete the hash entry and add it to free list
+    // special logic if entry is 1st in the bucket
+
+    if (previous == -1) map_bucket[ibucket] = map_hash[index].next;
+    else map_hash[previous].next = map_hash[index].next;
+
+    map_hash[index].next = map_free;
+    map_free = index;
+    map_nused--;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   remove 1st ghost atom from the map and from the ghost range
+   called during a run before a new owned atom is created in its slot,
+     so Comm::exchange() still clears map entries of all remaining ghosts
+   an owned atom takes precedence over its images, so its entry is kept
+   other images of a removed ghost are unmapped until the next borders()
+------------------------------------------------------------------------- */
+
+void Atom::map_drop_ghost()
+{
+  if (nghost == 0) return;
+  if (map_style && map(tag[nlocal]) == nlocal) map_erase(tag[nlocal]);
+  nghost--;
+}
+
+/* ----------------------------------------------------------------------
+   add owned atoms from nfirst to nlocal-1 to the map
+   called during a run after atoms created via map_drop_ghost() have IDs
+------------------------------------------------------------------------- */
+
+void Atom::map_new_owned(int nfirst)
+{
+  if (map_style == 0) return;
+  for (int i = nfirst; i < nlocal; i++) map_one(tag[i],i);
+}
+
+/* ----------------------------------------------------------------------
+   delete owned atom I during a run by copying last owned atom into its slot
+   the map is updated for just the 2 atoms involved
+   the vacated slot joins the ghost range,
+     so Comm::exchange() still clears map entries of all ghost atoms
+------------------------------------------------------------------------- */
+
+void Atom::delete_owned(int i)
+{
+  if (map_style) map_erase(tag[i]);
+  avec->copy(nlocal-1,i,1);
+  nlocal--;
+  nghost++;
+  if (map_style && i < nlocal) map_one(tag[i],i);
+}
+
 /* ----------------------------------------------------------------------
    free the array or hash table for global to local mapping
 ------------------------------------------------------------------------- */
@@ -281,6 +368,73 @@ int Atom::map_find_hash(int global)
   return local;
 }
 
+/* ----------------------------------------------------------------------
+   grow map array so it can hold all atom IDs up to maxtag
+   maxtag must be the same on all procs so map_tag_max stays the same
+   extra length means atoms added one at a time rarely trigger a regrow
+   called by tag_extend() and by commands that assign new atom IDs
+     before they are mapped
+------------------------------------------------------------------------- */
+
+void Atom::map_grow_array(int maxtag)
+{
+  if (map_style != 1 || map_array == NULL || maxtag <= map_tag_max) return;
+
+  int nold = map_tag_max + 1;
+  map_tag_max = maxtag + EXTRA;
+  memory->grow(map_array,map_tag_max+1,"atom:map_array");
+  for (int i = nold; i <= map_tag_max; i++) map_array[i] = -1;
+}
+
+/* ----------------------------------------------------------------------
+   grow hash table so it can hold at least n entries
+   re-insert existing entries since the bucket count changes
+------------------------------------------------------------------------- */
+
+void Atom::map_grow_hash(int n)
+{
+  int nbucket_old = map_nbucket;
+  int *bucket_old = map_bucket;
+  HashElem *hash_old = map_hash;
+
+  map_nhash = MAX(2*n,2*map_nhash);
+  map_nbucket = next_prime(map_nhash);
+
+  map_bucket = new int[map_nbucket];
+  for (int i = 0; i < map_nbucket; i++) map_bucket[i] = -1;
+
+  map_hash = new HashElem[map_nhash];
+  map_nused = 0;
+  map_free = 0;
+  for (int i = 0; i < map_nhash; i++) map_hash[i].next = i+1;
+  map_hash[map_nhash-1].next = -1;
+
+  // take one entry from free list for each old entry
+  // add it as 1st entry in its new bucket
+
+  if (hash_old) {
+    int global,ibucket,index,m;
+    for (int j = 0; j < nbucket_old; j++) {
+      index = bucket_old[j];
+      while (index > -1) {
+        global = hash_old[index].global;
+        ibucket = global % map_nbucket;
+        m = map_free;
+        map_free = map_hash[m].next;
+        map_hash[m].global = global;
+        map_hash[m].local = hash_old[index].local;
+        map_hash[m].next = map_bucket[ibucket];
+        map_bucket[ibucket] = m;
+        map_nused++;
+        index = hash_old[index].next;
+      }
+    }
+  }
+
+  delete [] bucket_old;
+  delete [] hash_old;
+}
+
 /* ----------------------------------------------------------------------
    return next prime larger than n
 ------------------------------------------------------------------------- */
@@ -23,6 +23,9 @@
 #include "domain.h"
 #include "force.h"
 #include "update.h"
+#include "input.h"
+#include "variable.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -30,6 +33,7 @@ using namespace LAMMPS_NS;
 
 enum{NONE,UNIFORM,USER,DYNAMIC};
 enum{X,Y,Z};
+enum{NOWEIGHT,TIME,VAR};
 
 //#define BALANCE_DEBUG 1
 
@@ -46,6 +50,13 @@ Balance::Balance(LAMMPS *lmp) : Pointers(lmp)
   user_xsplit = user_ysplit = user_zsplit = NULL;
   dflag = 0;
 
+  wtflag = NOWEIGHT;
+  wtvarname = NULL;
+  wttime = 0.0;
+  nmax = 0;
+  weight = NULL;
+  procweight = allprocweight = NULL;
+
   fp = NULL;
   firststep = 1;
 }
@@ -61,6 +72,11 @@ Balance::~Balance()
   delete [] user_ysplit;
   delete [] user_zsplit;
 
+  delete [] wtvarname;
+  memory->destroy(weight);
+  memory->destroy(procweight);
+  memory->destroy(allprocweight);
+
   if (dflag) {
     delete [] bdim;
     delete [] count;
@@ -169,6 +185,10 @@ void Balance::command(int narg, char **arg)
       if (thresh < 1.0) error->all(FLERR,"Illegal balance command");
       iarg += 4;
 
+    } else if (strcmp(arg[iarg],"weight") == 0) {
+      if (wtflag != NOWEIGHT) error->all(FLERR,"Illegal balance command");
+      iarg += weight_setup(narg-iarg,&arg[iarg]);
+
     } else if (strcmp(arg[iarg],"out") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal balance command");
       if (outflag) error->all(FLERR,"Illegal balance command");
@@ -219,6 +239,10 @@ void Balance::command(int narg, char **arg)
   domain->reset_box();
   if (domain->triclinic) domain->lamda2x(atom->nlocal);
 
+  // per-particle weights of the current owned particles
+
+  set_weights();
+
   // imbinit = initial imbalance
   // use current splits instead of nlocal since atoms may not be in sub-box
 
@@ -275,6 +299,17 @@ void Balance::command(int narg, char **arg)
 
   if (outflag && me == 0) dumpout(update->ntimestep,fp);
 
+  // weights do not migrate with particles,
+  //   so weighted final imbalance is computed from the new splits
+
+  int maxfinal;
+  double imbfinal;
+  if (wtflag) {
+    domain->x2lamda(atom->nlocal);
+    imbfinal = imbalance_splits(maxfinal);
+    domain->lamda2x(atom->nlocal);
+  }
+
   // reset comm->uniform flag if necessary
 
   if (comm->uniform) {
@@ -317,8 +352,7 @@ void Balance::command(int narg, char **arg)
 
   // imbfinal = final imbalance based on final nlocal
 
-  int maxfinal;
-  double imbfinal = imbalance_nlocal(maxfinal);
+  if (!wtflag) imbfinal = imbalance_nlocal(maxfinal);
 
   if (me == 0) {
     if (screen) {
@@ -369,17 +403,118 @@ void Balance::command(int narg, char **arg)
   }
 }
 
+/* ----------------------------------------------------------------------
+   parse weight keyword, called from command or by fix balance
+   arg[0] = "weight"
+   return # of args used
+------------------------------------------------------------------------- */
+
+int Balance::weight_setup(int narg, char **arg)
+{
+  if (narg < 3) error->all(FLERR,"Illegal balance weight");
+
+  if (strcmp(arg[1],"time") == 0) {
+    wtflag = TIME;
+    wtfactor = force->numeric(arg[2]);
+    if (wtfactor <= 0.0 || wtfactor > 1.0)
+      error->all(FLERR,"Illegal balance weight");
+  } else if (strcmp(arg[1],"var") == 0) {
+    wtflag = VAR;
+    delete [] wtvarname;
+    int n = strlen(arg[2]) + 1;
+    wtvarname = new char[n];
+    strcpy(wtvarname,arg[2]);
+  } else error->all(FLERR,"Illegal balance weight");
+
+  memory->destroy(procweight);
+  memory->destroy(allprocweight);
+  memory->create(procweight,nprocs,"balance:procweight");
+  memory->create(allprocweight,nprocs,"balance:allprocweight");
+
+  return 3;
+}
+
+/* ----------------------------------------------------------------------
+   set weight of each owned particle
+   TIME: each particle gets the pair+bond+kspace time its proc spent
+     since the last call, per particle, normalized to an average of 1,
+     and blended with a weight of 1 by wtfactor
+     uniform weights if no time was measured, e.g. before the 1st run
+   VAR: weights are the values of an atom-style variable
+   must be called again whenever particles move to other procs
+------------------------------------------------------------------------- */
+
+void Balance::set_weights()
+{
+  if (wtflag == NOWEIGHT) return;
+
+  int nlocal = atom->nlocal;
+  if (atom->nmax > nmax) {
+    memory->destroy(weight);
+    nmax = atom->nmax;
+    memory->create(weight,nmax,"balance:weight");
+  }
+
+  if (wtflag == TIME) {
+    double cost = timer->array[TIME_PAIR] + timer->array[TIME_BOND] +
+      timer->array[TIME_KSPACE];
+
+    // timer is reset at the start of each run
+
+    double delta = cost - wttime;
+    if (delta < 0.0) delta = cost;
+    wttime = cost;
+
+    double one[2],all[2];
+    one[0] = delta;
+    one[1] = nlocal;
+    MPI_Allreduce(one,all,2,MPI_DOUBLE,MPI_SUM,world);
+
+    double wt = 1.0;
+    if (all[0] > 0.0 && nlocal)
+      wt = wtfactor * (delta/nlocal) / (all[0]/all[1]) + (1.0-wtfactor);
+    for (int i = 0; i < nlocal; i++) weight[i] = wt;
+
+  } else {
+    int ivar = input->variable->find(wtvarname);
+    if (ivar < 0)
+      error->all(FLERR,"Variable name for balance weight does not exist");
+    if (input->variable->atomstyle(ivar) == 0)
+      error->all(FLERR,"Variable for balance weight is invalid style");
+    input->variable->compute_atom(ivar,0,weight,1,0);
+
+    int flag = 0;
+    for (int i = 0; i < nlocal; i++)
+      if (weight[i] < 0.0) flag = 1;
+    int flagall;
+    MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_SUM,world);
+    if (flagall)
+      error->all(FLERR,"Balance weight variable returned a negative weight");
+  }
+}
+
 /* ----------------------------------------------------------------------
    calculate imbalance based on nlocal
    return max = max atom per proc
    return imbalance factor = max atom per proc / ave atom per proc
+   if weighted, imbalance factor = max weight per proc / ave weight per proc
+     and weights must be current
 ------------------------------------------------------------------------- */
 
 double Balance::imbalance_nlocal(int &max)
 {
   MPI_Allreduce(&atom->nlocal,&max,1,MPI_INT,MPI_MAX,world);
   double imbalance = 1.0;
-  if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
+
+  if (wtflag) {
+    double wtlocal = 0.0;
+    for (int i = 0; i < atom->nlocal; i++) wtlocal += weight[i];
+    double wtmax,wttotal;
+    MPI_Allreduce(&wtlocal,&wtmax,1,MPI_DOUBLE,MPI_MAX,world);
+    MPI_Allreduce(&wtlocal,&wttotal,1,MPI_DOUBLE,MPI_SUM,world);
+    if (wttotal > 0.0) imbalance = wtmax / (wttotal / nprocs);
+  } else if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
+
   return imbalance;
 }
 
@@ -389,6 +524,8 @@ double Balance::imbalance_nlocal(int &max)
    map atoms to 3d grid of procs
    return max = max atom per proc
    return imbalance factor = max atom per proc / ave atom per proc
+   if weighted, imbalance factor = max weight per proc / ave weight per proc
+     and weights must be current
 ------------------------------------------------------------------------- */
 
 double Balance::imbalance_splits(int &max)
@@ -407,18 +544,33 @@ double Balance::imbalance_splits(int &max)
   int nlocal = atom->nlocal;
   int ix,iy,iz;
 
+  if (wtflag)
+    for (int i = 0; i < nprocs; i++) procweight[i] = 0.0;
+
   for (int i = 0; i < nlocal; i++) {
     ix = binary(x[i][0],nx,xsplit);
     iy = binary(x[i][1],ny,ysplit);
     iz = binary(x[i][2],nz,zsplit);
     proccount[iz*nx*ny + iy*nx + ix]++;
+    if (wtflag) procweight[iz*nx*ny + iy*nx + ix] += weight[i];
   }
 
   MPI_Allreduce(proccount,allproccount,nprocs,MPI_INT,MPI_SUM,world);
   max = 0;
   for (int i = 0; i < nprocs; i++) max = MAX(max,allproccount[i]);
   double imbalance = 1.0;
-  if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
+
+  if (wtflag) {
+    MPI_Allreduce(procweight,allprocweight,nprocs,MPI_DOUBLE,MPI_SUM,world);
+    double wtmax = 0.0;
+    double wttotal = 0.0;
+    for (int i = 0; i < nprocs; i++) {
+      wtmax = MAX(wtmax,allprocweight[i]);
+      wttotal += allprocweight[i];
+    }
+    if (wttotal > 0.0) imbalance = wtmax / (wttotal / nprocs);
+  } else if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
+
   return imbalance;
 }
 
@@ -442,14 +594,14 @@ void Balance::static_setup(char *str)
   int max = MAX(comm->procgrid[0],comm->procgrid[1]);
   max = MAX(max,comm->procgrid[2]);
 
-  count = new bigint[max];
-  onecount = new bigint[max];
-  sum = new bigint[max+1];
-  target = new bigint[max+1];
+  count = new double[max];
+  onecount = new double[max];
+  sum = new double[max+1];
+  target = new double[max+1];
   lo = new double[max+1];
   hi = new double[max+1];
-  losum = new bigint[max+1];
-  hisum = new bigint[max+1];
+  losum = new double[max+1];
+  hisum = new double[max+1];
 
   rho = 0;
 }
@@ -482,10 +634,19 @@ int Balance::dynamic()
   double *split;
 
   // no balancing if no atoms
+  // total = total weight of all atoms, same as natoms if unweighted
 
   bigint natoms = atom->natoms;
   if (natoms == 0) return 0;
 
+  double total = natoms;
+  if (wtflag) {
+    double wtlocal = 0.0;
+    for (i = 0; i < atom->nlocal; i++) wtlocal += weight[i];
+    MPI_Allreduce(&wtlocal,&total,1,MPI_DOUBLE,MPI_SUM,world);
+    if (total == 0.0) return 0;
+  }
+
   // set delta for 1d balancing = root of threshhold
   // root = # of dimensions being balanced on
 
@@ -513,18 +674,21 @@ int Balance::dynamic()
     tally(bdim[idim],np,split);
 
     // target[i] = desired sum at split I
+    // round to whole atoms if unweighted
 
-    for (i = 0; i < np; i++)
-      target[i] = static_cast<int> (1.0*natoms/np * i + 0.5);
-    target[np] = natoms;
+    for (i = 0; i < np; i++) {
+      if (wtflag) target[i] = total/np * i;
+      else target[i] = static_cast<int> (1.0*natoms/np * i + 0.5);
+    }
+    target[np] = total;
 
     // lo[i] = closest split <= split[i] with a sum <= target
     // hi[i] = closest split >= split[i] with a sum >= target
 
     lo[0] = hi[0] = 0.0;
     lo[np] = hi[np] = 1.0;
-    losum[0] = hisum[0] = 0;
-    losum[np] = hisum[np] = natoms;
+    losum[0] = hisum[0] = 0.0;
+    losum[np] = hisum[np] = total;
 
     for (i = 1; i < np; i++) {
       for (j = i; j >= 0; j--)
@@ -637,14 +801,14 @@ int Balance::dynamic()
    count atoms in each slice, based on their dim coordinate
    N = # of slices
    split = N+1 cuts between N slices
-   return updated count = particles per slice
+   return updated count = particles (or their weight) per slice
    retrun updated sum = cummulative count below each of N+1 splits
    use binary search to find which slice each atom is in
 ------------------------------------------------------------------------- */
 
 void Balance::tally(int dim, int n, double *split)
 {
-  for (int i = 0; i < n; i++) onecount[i] = 0;
+  for (int i = 0; i < n; i++) onecount[i] = 0.0;
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
@@ -652,12 +816,13 @@ void Balance::tally(int dim, int n, double *split)
 
   for (int i = 0; i < nlocal; i++) {
     index = binary(x[i][dim],n,split);
-    onecount[index]++;
+    if (wtflag) onecount[index] += weight[i];
+    else onecount[index] += 1.0;
   }
 
-  MPI_Allreduce(onecount,count,n,MPI_LMP_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(onecount,count,n,MPI_DOUBLE,MPI_SUM,world);
 
-  sum[0] = 0;
+  sum[0] = 0.0;
   for (int i = 1; i < n+1; i++)
     sum[i] = sum[i-1] + count[i-1];
 }
@@ -721,116 +886,6 @@ int Balance::adjust(int n, double *split)
   return change;
 }
 
-/* ----------------------------------------------------------------------
-   OLD code: for local diffusion method that didn't work as well as RCB
-   adjust cuts between N slices in a dim via diffusive method
-   count = atoms per slice
-   split = current N+1 cuts, with 0.0 and 1.0 at end points
-   overwrite split with new cuts
-   diffusion means slices with more atoms than their neighbors "send" atoms,
-     by moving cut closer to sender, further from receiver
-------------------------------------------------------------------------- */
-
-void Balance::old_adjust(int iter, int n, bigint *count, double *split)
-{
-  // need to allocate this if start using it again
-
-  double *cuts;
-
-  // damping factor
-
-  double damp = 0.5;
-
-  // loop over slices
-  // cut I is between 2 slices (I-1 and I) with counts
-  // cut I+1 is between 2 slices (I and I+1) with counts
-  // for a cut between 2 slices, only slice with larger count adjusts it
-  // special treatment of end slices with only 1 neighbor
-
-  bigint leftcount,mycount,rightcount;
-  double rho,target,targetleft,targetright;
-
-  for (int i = 0; i < n; i++) {
-    if (i == 0) leftcount = MAXBIGINT;
-    else leftcount = count[i-1];
-    mycount = count[i];
-    if (i == n-1) rightcount = MAXBIGINT;
-    else rightcount = count[i+1];
-
-    // middle slice is <= both left and right, so do nothing
-    // special case if 2 slices both have count = 0 -> no change in cut
-
-    if (mycount <= leftcount && mycount <= rightcount) {
-      if (leftcount == 0) cuts[i] = split[i];
-      if (rightcount == 0) cuts[i+1] = split[i+1];
-      continue;
-    }
-
-    // rho = density of atoms in the slice
-
-    rho = mycount / (split[i+1] - split[i]);
-
-    // middle slice has more atoms than left or right slice
-    // send atoms in that dir
-
-    if (mycount > leftcount) {
-      target = damp * 0.5*(mycount-leftcount);
-      cuts[i] = split[i] + target/rho;
-    }
-    if (mycount > rightcount) {
-      target = damp * 0.5*(mycount-rightcount);
-      cuts[i+1] = split[i+1] - target/rho;
-    }
-
-    /*
-    // middle slice has more atoms then left or right slice
-    // if delta from middle to top slice > delta between top and bottom slice
-    //   then send atoms both dirs to bring all 3 slices to same count
-    // else bottom slice is very low, so send atoms only in that dir
-
-    if (mycount > leftcount && mycount > rightcount) {
-      if (mycount-MAX(leftcount,rightcount) >= fabs(leftcount-rightcount)) {
-        if (leftcount <= rightcount) {
-          targetleft = damp *
-            (rightcount-leftcount + (mycount-rightcount)/3.0);
-          targetright = damp * (mycount-rightcount)/3.0;
-          cuts[i] = split[i] + targetleft/rho;
-          cuts[i+1] = split[i+1] - targetright/rho;
-        } else {
-          targetleft = damp * (mycount-leftcount)/3.0;
-          targetright = damp *
-            (leftcount-rightcount + (mycount-leftcount)/3.0);
-          cuts[i] = split[i] + targetleft/rho;
-          cuts[i+1] = split[i+1] - targetright/rho;
-        }
-      } else if (leftcount < rightcount) {
-        target = damp * 0.5*(mycount-leftcount);
-        cuts[i] = split[i] + target/rho;
-        cuts[i+1] = split[i+1];
-      } else if (rightcount < leftcount) {
-        target = damp * 0.5*(mycount-rightcount);
-        cuts[i+1] = split[i+1] - target/rho;
-        cuts[i] = split[i];
-      }
-
-    // middle slice has more atoms than only left or right slice
-    // send atoms only in that dir
-
-    } else if (mycount > leftcount) {
-      target = damp * 0.5*(mycount-leftcount);
-      cuts[i] = split[i] + target/rho;
-    } else if (mycount > rightcount) {
-      target = damp * 0.5*(mycount-rightcount);
-      cuts[i+1] = split[i+1] - target/rho;
-    }
-    */
-  }
-
-  // overwrite adjustable splits with new cuts
-
-  for (int i = 1; i < n; i++) split[i] = cuts[i];
-}
-
 /* ----------------------------------------------------------------------
    binary search for where value falls in N-length vec
    note that vec actually has N+1 values, but ignore last one
@@ -991,13 +1046,13 @@ void Balance::debug_output(int idim, int m, int np, double *split)
   printf("Dimension %s, Iteration %d\n",dim,m);
 
   printf("  Count:");
-  for (i = 0; i < np; i++) printf(" " BIGINT_FORMAT,count[i]);
+  for (i = 0; i < np; i++) printf(" %g",count[i]);
   printf("\n");
   printf("  Sum:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,sum[i]);
+  for (i = 0; i <= np; i++) printf(" %g",sum[i]);
   printf("\n");
   printf("  Target:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,target[i]);
+  for (i = 0; i <= np; i++) printf(" %g",target[i]);
   printf("\n");
   printf("  Actual cut:");
   for (i = 0; i <= np; i++)
@@ -1010,19 +1065,19 @@ void Balance::debug_output(int idim, int m, int np, double *split)
   for (i = 0; i <= np; i++) printf(" %g",lo[i]);
   printf("\n");
   printf("  Low-sum:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,losum[i]);
+  for (i = 0; i <= np; i++) printf(" %g",losum[i]);
   printf("\n");
   printf("  Hi:");
   for (i = 0; i <= np; i++) printf(" %g",hi[i]);
   printf("\n");
   printf("  Hi-sum:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,hisum[i]);
+  for (i = 0; i <= np; i++) printf(" %g",hisum[i]);
   printf("\n");
   printf("  Delta:");
   for (i = 0; i < np; i++) printf(" %g",split[i+1]-split[i]);
   printf("\n");
 
-  bigint max = 0;
+  double max = 0.0;
   for (i = 0; i < np; i++) max = MAX(max,count[i]);
   printf("  Imbalance factor: %g\n",1.0*max*np/target[np]);
 }
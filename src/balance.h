@@ -32,7 +32,10 @@ class Balance : protected Pointers {
   void command(int, char **);
   void dynamic_setup(char *, int, double);
   int dynamic();
+  int weight_setup(int, char **);
+  void set_weights();
   double imbalance_nlocal(int &);
+  double imbalance_splits(int &);
   void dumpout(bigint, FILE *);
 
  private:
@@ -48,27 +51,34 @@ class Balance : protected Pointers {
 
   int ndim;                  // length of balance string bstr
   int *bdim;                 // XYZ for each character in bstr
-  bigint *count;             // counts for slices in one dim
-  bigint *onecount;          // work vector of counts in one dim
-  bigint *sum;               // cummulative count for slices in one dim
-  bigint *target;            // target sum for slices in one dim
+  double *count;             // counts for slices in one dim
+  double *onecount;          // work vector of counts in one dim
+  double *sum;               // cummulative count for slices in one dim
+  double *target;            // target sum for slices in one dim
   double *lo,*hi;            // lo/hi split coords that bound each target
-  bigint *losum,*hisum;      // cummulative counts at lo/hi coords
+  double *losum,*hisum;      // cummulative counts at lo/hi coords
   int rho;                   // 0 for geometric recursion
                              // 1 for density weighted recursion
 
   int *proccount;            // particle count per processor
   int *allproccount;
 
+  int wtflag;                // NOWEIGHT for particle counts, else TIME or VAR
+  double wtfactor;           // fraction of time weight, rest is count
+  char *wtvarname;           // atom-style variable with per-atom weights
+  double wttime;             // pair+bond+kspace time at last set_weights()
+  int nmax;                  // length of weight vector
+  double *weight;            // weight of each owned particle
+  double *procweight;        // weight per processor
+  double *allprocweight;
+
   int outflag;               // for output of balance results to file
   FILE *fp;
   int firststep;
 
   void static_setup(char *);
-  double imbalance_splits(int &);
   void tally(int, int, double *);
   int adjust(int, double *);
-  void old_adjust(int, int, bigint *, double *);
   int binary(double, int, double *);
   void debug_output(int, int, int, double *);
 };
@@ -107,6 +117,23 @@ E: Lost atoms via balance: original %ld current %ld
 
 This should not occur.  Report the problem to the developers.
 
+E: Illegal balance weight
+
+The weight keyword must be followed by "time" with a factor between
+0.0 and 1.0, or by "var" and the name of an atom-style variable.
+
+E: Variable name for balance weight does not exist
+
+Self-explanatory.
+
+E: Variable for balance weight is invalid style
+
+Only atom-style variables can be used.
+
+E: Balance weight variable returned a negative weight
+
+The cost of a particle must be 0.0 or larger.
+
 E: Balance produced bad splits
 
 This should not occur.  It means two or more cutting plane locations
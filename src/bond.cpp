@@ -16,6 +16,7 @@
 #include "atom.h"
 #include "comm.h"
 #include "force.h"
+#include "compute.h"
 #include "suffix.h"
 #include "atom_masks.h"
 #include "memory.h"
@@ -39,6 +40,9 @@ Bond::Bond(LAMMPS *lmp) : Pointers(lmp)
   eatom = NULL;
   vatom = NULL;
 
+  ntally = 0;
+  tallylist = NULL;
+
   datamask = ALL_MASK;
   datamask_ext = ALL_MASK;
 }
@@ -49,6 +53,39 @@ Bond::~Bond()
 {
   memory->destroy(eatom);
   memory->destroy(vatom);
+  memory->sfree(tallylist);
+}
+
+/* ----------------------------------------------------------------------
+   register a compute to be called back from ev_tally()
+   ok to call more than once for the same compute
+   bond_hybrid also registers the compute with its sub-styles
+------------------------------------------------------------------------- */
+
+void Bond::add_tally_callback(Compute *ptr)
+{
+  if (suffix_flag & (Suffix::GPU | Suffix::CUDA | Suffix::OMP))
+    error->all(FLERR,"Tally compute is not supported by accelerated bond styles");
+
+  for (int i = 0; i < ntally; i++)
+    if (tallylist[i] == ptr) return;
+
+  tallylist = (Compute **)
+    memory->srealloc(tallylist,(ntally+1)*sizeof(Compute *),"bond:tallylist");
+  tallylist[ntally++] = ptr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Bond::del_tally_callback(Compute *ptr)
+{
+  int i;
+  for (i = 0; i < ntally; i++)
+    if (tallylist[i] == ptr) break;
+  if (i == ntally) return;
+
+  for (; i < ntally-1; i++) tallylist[i] = tallylist[i+1];
+  ntally--;
 }
 
 /* ----------------------------------------------------------------------
@@ -199,6 +236,11 @@ void Bond::ev_tally(int i, int j, int nlocal, int newton_bond,
       }
     }
   }
+
+  if (ntally)
+    for (int k = 0; k < ntally; k++)
+      tallylist[k]->bond_tally_callback(i,j,nlocal,newton_bond,
+                                        ebond,fbond,delx,dely,delz);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -47,9 +47,17 @@ class Bond : protected Pointers {
   virtual unsigned int data_mask() {return datamask;}
   virtual unsigned int data_mask_ext() {return datamask_ext;}
 
+  // computes which are called back from ev_tally()
+
+  virtual void add_tally_callback(class Compute *);
+  virtual void del_tally_callback(class Compute *);
+
  protected:
   int suffix_flag;             // suffix compatibility flag
 
+  int ntally;                  // # of computes called back on tally
+  class Compute **tallylist;   // list of those computes
+
   int evflag;
   int eflag_either,eflag_global,eflag_atom;
   int vflag_either,vflag_global,vflag_atom;
@@ -75,4 +83,9 @@ E: All bond coeffs are not set
 All bond coefficients must be set in the data file or by the
 bond_coeff command before running a simulation.
 
+E: Tally compute is not supported by accelerated bond styles
+
+Accelerated bond styles tally energy and virial in their own
+routines, which do not call back to the compute.
+
 */
@@ -341,6 +341,22 @@ double BondHybrid::single(int type, double rsq, int i, int j)
   return styles[map[type]]->single(type,rsq,i,j);
 }
 
+/* ----------------------------------------------------------------------
+   register compute with each sub-style, which do the tallying
+------------------------------------------------------------------------- */
+
+void BondHybrid::add_tally_callback(Compute *ptr)
+{
+  for (int m = 0; m < nstyles; m++) styles[m]->add_tally_callback(ptr);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BondHybrid::del_tally_callback(Compute *ptr)
+{
+  for (int m = 0; m < nstyles; m++) styles[m]->del_tally_callback(ptr);
+}
+
 /* ----------------------------------------------------------------------
    memory usage
 ------------------------------------------------------------------------- */
@@ -45,6 +45,9 @@ class BondHybrid : public Bond {
   double single(int, double, int, int);
   double memory_usage();
 
+  void add_tally_callback(class Compute *);
+  void del_tally_callback(class Compute *);
+
  private:
   int *map;                     // which style each bond type points to
 
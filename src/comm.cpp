@@ -116,6 +116,17 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
     maxsendlist[i] = BUFMIN;
     memory->create(sendlist[i],BUFMIN,"comm:sendlist[i]");
   }
+
+  // persistent requests are created on first forward/reverse comm
+
+  plan_flag = 0;
+  maxplan = 0;
+  plan_x = plan_f = NULL;
+  forward_recv_request = forward_send_request = NULL;
+  reverse_recv_request = reverse_send_request = NULL;
+  plan_soffset = plan_roffset = NULL;
+  plan_send = plan_recv = NULL;
+  maxplan_send = maxplan_recv = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -143,6 +154,16 @@ Comm::~Comm()
 
   memory->destroy(buf_send);
   memory->destroy(buf_recv);
+
+  free_plan();
+  delete [] forward_recv_request;
+  delete [] forward_send_request;
+  delete [] reverse_recv_request;
+  delete [] reverse_send_request;
+  memory->destroy(plan_soffset);
+  memory->destroy(plan_roffset);
+  memory->destroy(plan_send);
+  memory->destroy(plan_recv);
 }
 
 /* ----------------------------------------------------------------------
@@ -346,6 +367,10 @@ void Comm::init()
   if (force->newton == 0) maxreverse = 0;
   if (force->pair) maxreverse = MAX(maxreverse,force->pair->comm_reverse_off);
 
+  // sizes or x/f only flags may have changed
+
+  plan_flag = 0;
+
   // memory for multi-style communication
 
   if (style == MULTI && multilo == NULL) {
@@ -656,121 +681,148 @@ int Comm::updown(int dim, int dir, int loc,
 /* ----------------------------------------------------------------------
    forward communication of atom coords every timestep
    other per-atom attributes may also be sent via pack/unpack routines
+   the 2 swaps of each left/right pair in a dim do not send each other's
+     ghosts, so both are posted before waiting on either
 ------------------------------------------------------------------------- */
 
 void Comm::forward_comm(int dummy)
 {
-  int n;
-  MPI_Request request;
+  int n,iswap,ipair,last;
+  int sendflag[2];
   MPI_Status status;
   AtomVec *avec = atom->avec;
   double **x = atom->x;
   double *buf;
 
-  // exchange data with another proc
+  if (!plan_flag || x != plan_x || atom->f != plan_f) setup_plan();
+
+  // exchange data with other procs via persistent requests
   // if other proc is self, just copy
-  // if comm_x_only set, exchange or copy directly to x, don't unpack
+  // if comm_x_only set, recv directly into x, don't unpack
+  // if pack size differs from the persistent request, send it directly,
+  //   other proc has already posted its recv
 
-  for (int iswap = 0; iswap < nswap; iswap++) {
-    if (sendproc[iswap] != me) {
-      if (comm_x_only) {
-        if (size_forward_recv[iswap]) buf = x[firstrecv[iswap]];
-        else buf = NULL;
-        if (size_forward_recv[iswap])
-          MPI_Irecv(buf,size_forward_recv[iswap],MPI_DOUBLE,
-                    recvproc[iswap],0,world,&request);
-        n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
-                            buf_send,pbc_flag[iswap],pbc[iswap]);
-        if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
-        if (size_forward_recv[iswap]) MPI_Wait(&request,&status);
-      } else if (ghost_velocity) {
-        if (size_forward_recv[iswap])
-          MPI_Irecv(buf_recv,size_forward_recv[iswap],MPI_DOUBLE,
-                    recvproc[iswap],0,world,&request);
-        n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
-                                buf_send,pbc_flag[iswap],pbc[iswap]);
-        if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
-        if (size_forward_recv[iswap]) MPI_Wait(&request,&status);
-        avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf_recv);
-      } else {
-        if (size_forward_recv[iswap])
-          MPI_Irecv(buf_recv,size_forward_recv[iswap],MPI_DOUBLE,
-                    recvproc[iswap],0,world,&request);
-        n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
-                            buf_send,pbc_flag[iswap],pbc[iswap]);
-        if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
-        if (size_forward_recv[iswap]) MPI_Wait(&request,&status);
-        avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf_recv);
-      }
+  for (ipair = 0; ipair < nswap; ipair += 2) {
+    last = ipair + 2;
 
-    } else {
-      if (comm_x_only) {
-        if (sendnum[iswap])
+    for (iswap = ipair; iswap < last; iswap++)
+      if (sendproc[iswap] != me && size_forward_recv[iswap])
+        MPI_Start(&forward_recv_request[iswap]);
+
+    for (iswap = ipair; iswap < last; iswap++) {
+      sendflag[iswap-ipair] = 0;
+      if (sendproc[iswap] != me) {
+        buf = &plan_send[plan_soffset[iswap]];
+        if (ghost_velocity)
+          n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
+                                  buf,pbc_flag[iswap],pbc[iswap]);
+        else
           n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
-                              x[firstrecv[iswap]],pbc_flag[iswap],
-                              pbc[iswap]);
-      } else if (ghost_velocity) {
-        n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
-                                buf_send,pbc_flag[iswap],pbc[iswap]);
-        avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf_send);
+                              buf,pbc_flag[iswap],pbc[iswap]);
+        if (n && n == sendnum[iswap]*size_forward) {
+          MPI_Start(&forward_send_request[iswap]);
+          sendflag[iswap-ipair] = 1;
+        } else if (n) MPI_Send(buf,n,MPI_DOUBLE,sendproc[iswap],iswap,world);
+
       } else {
-        n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
-                            buf_send,pbc_flag[iswap],pbc[iswap]);
-        avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf_send);
+        if (comm_x_only) {
+          if (sendnum[iswap])
+            n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                                x[firstrecv[iswap]],pbc_flag[iswap],
+                                pbc[iswap]);
+        } else if (ghost_velocity) {
+          n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
+                                  buf_send,pbc_flag[iswap],pbc[iswap]);
+          avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf_send);
+        } else {
+          n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                              buf_send,pbc_flag[iswap],pbc[iswap]);
+          avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf_send);
+        }
       }
     }
+
+    for (iswap = ipair; iswap < last; iswap++) {
+      if (sendproc[iswap] == me) continue;
+      if (size_forward_recv[iswap]) {
+        MPI_Wait(&forward_recv_request[iswap],&status);
+        buf = &plan_recv[plan_roffset[iswap]];
+        if (ghost_velocity)
+          avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf);
+        else if (!comm_x_only)
+          avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf);
+      }
+      if (sendflag[iswap-ipair]) MPI_Wait(&forward_send_request[iswap],&status);
+    }
   }
 }
 
 /* ----------------------------------------------------------------------
    reverse communication of forces on atoms every timestep
    other per-atom attributes may also be sent via pack/unpack routines
+   left/right swap pairs are done together, as in forward_comm()
 ------------------------------------------------------------------------- */
 
 void Comm::reverse_comm()
 {
-  int n;
-  MPI_Request request;
+  int n,iswap,ipair,last;
+  int sendflag[2];
   MPI_Status status;
   AtomVec *avec = atom->avec;
   double **f = atom->f;
   double *buf;
 
-  // exchange data with another proc
+  if (!plan_flag || atom->x != plan_x || f != plan_f) setup_plan();
+
+  // exchange data with other procs via persistent requests
   // if other proc is self, just copy
-  // if comm_f_only set, exchange or copy directly from f, don't pack
+  // if comm_f_only set, send or copy directly from f, don't pack
+
+  for (ipair = nswap-2; ipair >= 0; ipair -= 2) {
+    last = ipair + 2;
+
+    for (iswap = ipair; iswap < last; iswap++)
+      if (sendproc[iswap] != me && size_reverse_recv[iswap])
+        MPI_Start(&reverse_recv_request[iswap]);
+
+    for (iswap = ipair; iswap < last; iswap++) {
+      sendflag[iswap-ipair] = 0;
+      if (sendproc[iswap] != me) {
+        if (comm_f_only) {
+          if (size_reverse_send[iswap]) {
+            MPI_Start(&reverse_send_request[iswap]);
+            sendflag[iswap-ipair] = 1;
+          }
+        } else {
+          buf = &plan_send[plan_soffset[iswap]];
+          n = avec->pack_reverse(recvnum[iswap],firstrecv[iswap],buf);
+          if (n && n == size_reverse_send[iswap]) {
+            MPI_Start(&reverse_send_request[iswap]);
+            sendflag[iswap-ipair] = 1;
+          } else if (n)
+            MPI_Send(buf,n,MPI_DOUBLE,recvproc[iswap],iswap,world);
+        }
 
-  for (int iswap = nswap-1; iswap >= 0; iswap--) {
-    if (sendproc[iswap] != me) {
-      if (comm_f_only) {
-        if (size_reverse_recv[iswap])
-          MPI_Irecv(buf_recv,size_reverse_recv[iswap],MPI_DOUBLE,
-                    sendproc[iswap],0,world,&request);
-        if (size_reverse_send[iswap]) buf = f[firstrecv[iswap]];
-        else buf = NULL;
-        if (size_reverse_send[iswap])
-          MPI_Send(buf,size_reverse_send[iswap],MPI_DOUBLE,
-                   recvproc[iswap],0,world);
-        if (size_reverse_recv[iswap]) MPI_Wait(&request,&status);
       } else {
-        if (size_reverse_recv[iswap])
-          MPI_Irecv(buf_recv,size_reverse_recv[iswap],MPI_DOUBLE,
-                    sendproc[iswap],0,world,&request);
-        n = avec->pack_reverse(recvnum[iswap],firstrecv[iswap],buf_send);
-        if (n) MPI_Send(buf_send,n,MPI_DOUBLE,recvproc[iswap],0,world);
-        if (size_reverse_recv[iswap]) MPI_Wait(&request,&status);
+        if (comm_f_only) {
+          if (sendnum[iswap])
+            avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
+                                 f[firstrecv[iswap]]);
+        } else {
+          n = avec->pack_reverse(recvnum[iswap],firstrecv[iswap],buf_send);
+          avec->unpack_reverse(sendnum[iswap],sendlist[iswap],buf_send);
+        }
       }
-      avec->unpack_reverse(sendnum[iswap],sendlist[iswap],buf_recv);
+    }
 
-    } else {
-      if (comm_f_only) {
-        if (sendnum[iswap])
-            avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
-                                f[firstrecv[iswap]]);
-      } else {
-        n = avec->pack_reverse(recvnum[iswap],firstrecv[iswap],buf_send);
-        avec->unpack_reverse(sendnum[iswap],sendlist[iswap],buf_send);
+    for (iswap = ipair; iswap < last; iswap++) {
+      if (sendproc[iswap] == me) continue;
+      if (size_reverse_recv[iswap]) {
+        MPI_Wait(&reverse_recv_request[iswap],&status);
+        avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
+                             &plan_recv[plan_roffset[iswap]]);
       }
+      if (sendflag[iswap-ipair]) MPI_Wait(&reverse_send_request[iswap],&status);
     }
   }
 }
@@ -1065,6 +1117,10 @@ void Comm::borders()
   max = MAX(maxforward*rmax,maxreverse*smax);
   if (max > maxrecv) grow_recv(max);
 
+  // swaps have changed, persistent requests must be set up again
+
+  plan_flag = 0;
+
   // reset global->local map
 
   if (map_style) atom->map_set();
@@ -1072,74 +1128,94 @@ void Comm::borders()
 
 /* ----------------------------------------------------------------------
    forward communication invoked by a Pair
+   left/right swap pairs are done together, as in forward_comm()
 ------------------------------------------------------------------------- */
 
 void Comm::forward_comm_pair(Pair *pair)
 {
-  int iswap,n;
+  int iswap,ipair,last,n;
   double *buf;
-  MPI_Request request;
+  MPI_Request request[2];
   MPI_Status status;
 
-  for (iswap = 0; iswap < nswap; iswap++) {
-
-    // pack buffer
+  if (!plan_flag || atom->x != plan_x || atom->f != plan_f) setup_plan();
 
-    n = pair->pack_comm(sendnum[iswap],sendlist[iswap],
-                        buf_send,pbc_flag[iswap],pbc[iswap]);
+  for (ipair = 0; ipair < nswap; ipair += 2) {
+    last = ipair + 2;
 
-    // exchange with another proc
+    // pack buffers
+    // exchange with other procs
     // if self, set recv buffer to send buffer
 
-    if (sendproc[iswap] != me) {
-      if (recvnum[iswap])
-        MPI_Irecv(buf_recv,n*recvnum[iswap],MPI_DOUBLE,recvproc[iswap],0,
-                  world,&request);
-      if (sendnum[iswap])
-        MPI_Send(buf_send,n*sendnum[iswap],MPI_DOUBLE,sendproc[iswap],0,world);
-      if (recvnum[iswap]) MPI_Wait(&request,&status);
-      buf = buf_recv;
-    } else buf = buf_send;
+    for (iswap = ipair; iswap < last; iswap++) {
+      buf = &plan_send[plan_soffset[iswap]];
+      n = pair->pack_comm(sendnum[iswap],sendlist[iswap],
+                          buf,pbc_flag[iswap],pbc[iswap]);
+      if (sendproc[iswap] != me) {
+        if (recvnum[iswap])
+          MPI_Irecv(&plan_recv[plan_roffset[iswap]],n*recvnum[iswap],
+                    MPI_DOUBLE,recvproc[iswap],iswap,world,
+                    &request[iswap-ipair]);
+        if (sendnum[iswap])
+          MPI_Send(buf,n*sendnum[iswap],MPI_DOUBLE,sendproc[iswap],iswap,
+                   world);
+      } else pair->unpack_comm(recvnum[iswap],firstrecv[iswap],buf);
+    }
 
-    // unpack buffer
+    // unpack buffers
 
-    pair->unpack_comm(recvnum[iswap],firstrecv[iswap],buf);
+    for (iswap = ipair; iswap < last; iswap++)
+      if (sendproc[iswap] != me && recvnum[iswap]) {
+        MPI_Wait(&request[iswap-ipair],&status);
+        pair->unpack_comm(recvnum[iswap],firstrecv[iswap],
+                          &plan_recv[plan_roffset[iswap]]);
+      }
   }
 }
 
 /* ----------------------------------------------------------------------
    reverse communication invoked by a Pair
+   left/right swap pairs are done together, as in reverse_comm()
 ------------------------------------------------------------------------- */
 
 void Comm::reverse_comm_pair(Pair *pair)
 {
-  int iswap,n;
+  int iswap,ipair,last,n;
   double *buf;
-  MPI_Request request;
+  MPI_Request request[2];
   MPI_Status status;
 
-  for (iswap = nswap-1; iswap >= 0; iswap--) {
+  if (!plan_flag || atom->x != plan_x || atom->f != plan_f) setup_plan();
 
-    // pack buffer
-
-    n = pair->pack_reverse_comm(recvnum[iswap],firstrecv[iswap],buf_send);
+  for (ipair = nswap-2; ipair >= 0; ipair -= 2) {
+    last = ipair + 2;
 
-    // exchange with another proc
+    // pack buffers
+    // exchange with other procs
     // if self, set recv buffer to send buffer
 
-    if (sendproc[iswap] != me) {
-      if (sendnum[iswap])
-        MPI_Irecv(buf_recv,n*sendnum[iswap],MPI_DOUBLE,sendproc[iswap],0,
-                  world,&request);
-      if (recvnum[iswap])
-        MPI_Send(buf_send,n*recvnum[iswap],MPI_DOUBLE,recvproc[iswap],0,world);
-      if (sendnum[iswap]) MPI_Wait(&request,&status);
-      buf = buf_recv;
-    } else buf = buf_send;
+    for (iswap = ipair; iswap < last; iswap++) {
+      buf = &plan_send[plan_soffset[iswap]];
+      n = pair->pack_reverse_comm(recvnum[iswap],firstrecv[iswap],buf);
+      if (sendproc[iswap] != me) {
+        if (sendnum[iswap])
+          MPI_Irecv(&plan_recv[plan_roffset[iswap]],n*sendnum[iswap],
+                    MPI_DOUBLE,sendproc[iswap],iswap,world,
+                    &request[iswap-ipair]);
+        if (recvnum[iswap])
+          MPI_Send(buf,n*recvnum[iswap],MPI_DOUBLE,recvproc[iswap],iswap,
+                   world);
+      } else pair->unpack_reverse_comm(sendnum[iswap],sendlist[iswap],buf);
+    }
 
-    // unpack buffer
+    // unpack buffers
 
-    pair->unpack_reverse_comm(sendnum[iswap],sendlist[iswap],buf);
+    for (iswap = ipair; iswap < last; iswap++)
+      if (sendproc[iswap] != me && sendnum[iswap]) {
+        MPI_Wait(&request[iswap-ipair],&status);
+        pair->unpack_reverse_comm(sendnum[iswap],sendlist[iswap],
+                                  &plan_recv[plan_roffset[iswap]]);
+      }
   }
 }
 
@@ -1483,6 +1559,125 @@ void Comm::free_multi()
   memory->destroy(multihi);
 }
 
+/* ----------------------------------------------------------------------
+   create persistent requests for each swap with another proc
+   each swap gets its own region of the plan buffers, sized for the
+     largest forward/reverse comm, so paired swaps do not overlap
+   forward recvs go directly into x and reverse sends come directly
+     from f if only x,f are communicated
+   tag = swap index, since the 2 swaps of a pair may be with the same proc
+------------------------------------------------------------------------- */
+
+void Comm::setup_plan()
+{
+  int iswap;
+
+  free_plan();
+
+  if (nswap > maxplan) {
+    delete [] forward_recv_request;
+    delete [] forward_send_request;
+    delete [] reverse_recv_request;
+    delete [] reverse_send_request;
+    memory->destroy(plan_soffset);
+    memory->destroy(plan_roffset);
+    maxplan = maxswap;
+    forward_recv_request = new MPI_Request[maxplan];
+    forward_send_request = new MPI_Request[maxplan];
+    reverse_recv_request = new MPI_Request[maxplan];
+    reverse_send_request = new MPI_Request[maxplan];
+    memory->create(plan_soffset,maxplan,"comm:plan_soffset");
+    memory->create(plan_roffset,maxplan,"comm:plan_roffset");
+    for (iswap = 0; iswap < maxplan; iswap++) {
+      forward_recv_request[iswap] = forward_send_request[iswap] =
+        MPI_REQUEST_NULL;
+      reverse_recv_request[iswap] = reverse_send_request[iswap] =
+        MPI_REQUEST_NULL;
+    }
+  }
+
+  // per-swap offsets into plan buffers
+  // self swaps also use plan_send in forward/reverse_comm_pair()
+
+  int nforward = MAX(maxforward,size_forward);
+  int nreverse = MAX(maxreverse,size_reverse);
+  int soffset = 0;
+  int roffset = 0;
+  for (iswap = 0; iswap < nswap; iswap++) {
+    plan_soffset[iswap] = soffset;
+    plan_roffset[iswap] = roffset;
+    soffset += MAX(nforward*sendnum[iswap],nreverse*recvnum[iswap]);
+    if (sendproc[iswap] != me)
+      roffset += MAX(nforward*recvnum[iswap],nreverse*sendnum[iswap]);
+  }
+
+  if (soffset > maxplan_send) {
+    maxplan_send = static_cast<int> (BUFFACTOR * soffset);
+    memory->destroy(plan_send);
+    memory->create(plan_send,maxplan_send,"comm:plan_send");
+  }
+  if (roffset > maxplan_recv) {
+    maxplan_recv = static_cast<int> (BUFFACTOR * roffset);
+    memory->destroy(plan_recv);
+    memory->create(plan_recv,maxplan_recv,"comm:plan_recv");
+  }
+
+  // create persistent requests
+
+  double **x = atom->x;
+  double **f = atom->f;
+  double *buf;
+
+  for (iswap = 0; iswap < nswap; iswap++) {
+    if (sendproc[iswap] == me) continue;
+
+    if (size_forward_recv[iswap]) {
+      if (comm_x_only) buf = x[firstrecv[iswap]];
+      else buf = &plan_recv[plan_roffset[iswap]];
+      MPI_Recv_init(buf,size_forward_recv[iswap],MPI_DOUBLE,
+                    recvproc[iswap],iswap,world,&forward_recv_request[iswap]);
+    }
+    if (sendnum[iswap])
+      MPI_Send_init(&plan_send[plan_soffset[iswap]],
+                    sendnum[iswap]*size_forward,MPI_DOUBLE,
+                    sendproc[iswap],iswap,world,&forward_send_request[iswap]);
+
+    if (size_reverse_recv[iswap])
+      MPI_Recv_init(&plan_recv[plan_roffset[iswap]],size_reverse_recv[iswap],
+                    MPI_DOUBLE,sendproc[iswap],iswap,world,
+                    &reverse_recv_request[iswap]);
+    if (size_reverse_send[iswap]) {
+      if (comm_f_only) buf = f[firstrecv[iswap]];
+      else buf = &plan_send[plan_soffset[iswap]];
+      MPI_Send_init(buf,size_reverse_send[iswap],MPI_DOUBLE,
+                    recvproc[iswap],iswap,world,&reverse_send_request[iswap]);
+    }
+  }
+
+  plan_x = x;
+  plan_f = f;
+  plan_flag = 1;
+}
+
+/* ----------------------------------------------------------------------
+   free persistent requests
+------------------------------------------------------------------------- */
+
+void Comm::free_plan()
+{
+  for (int iswap = 0; iswap < maxplan; iswap++) {
+    if (forward_recv_request[iswap] != MPI_REQUEST_NULL)
+      MPI_Request_free(&forward_recv_request[iswap]);
+    if (forward_send_request[iswap] != MPI_REQUEST_NULL)
+      MPI_Request_free(&forward_send_request[iswap]);
+    if (reverse_recv_request[iswap] != MPI_REQUEST_NULL)
+      MPI_Request_free(&reverse_recv_request[iswap]);
+    if (reverse_send_request[iswap] != MPI_REQUEST_NULL)
+      MPI_Request_free(&reverse_send_request[iswap]);
+  }
+  plan_flag = 0;
+}
+
 /* ----------------------------------------------------------------------
    set communication style
    invoked from input script by communicate command
@@ -1669,5 +1864,7 @@ bigint Comm::memory_usage()
     bytes += memory->usage(sendlist[i],maxsendlist[i]);
   bytes += memory->usage(buf_send,maxsend+BUFEXTRA);
   bytes += memory->usage(buf_recv,maxrecv);
+  bytes += memory->usage(plan_send,maxplan_send);
+  bytes += memory->usage(plan_recv,maxplan_recv);
   return bytes;
 }
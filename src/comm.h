@@ -110,6 +110,18 @@ class Comm : protected Pointers {
   int maxsend,maxrecv;              // current size of send/recv buffer
   int maxforward,maxreverse;        // max # of datums in forward/reverse comm
 
+  // persistent requests for forward_comm() and reverse_comm()
+  // set up on first use after borders(), since swaps are fixed until then
+
+  int plan_flag;                    // 1 if persistent requests are current
+  int maxplan;                      // # of swaps requests are allocated for
+  double **plan_x,**plan_f;         // x,f arrays the requests point into
+  MPI_Request *forward_recv_request,*forward_send_request;
+  MPI_Request *reverse_recv_request,*reverse_send_request;
+  int *plan_soffset,*plan_roffset;  // offset of each swap in plan buffers
+  double *plan_send,*plan_recv;     // per-swap send/recv buffers
+  int maxplan_send,maxplan_recv;    // current size of plan buffers
+
   int updown(int, int, int, double, int, double *);
                                             // compare cutoff to procs
   virtual void grow_send(int,int);          // reallocate send buffer
@@ -120,6 +132,8 @@ class Comm : protected Pointers {
   virtual void allocate_multi(int);         // allocate multi arrays
   virtual void free_swap();                 // free swap arrays
   virtual void free_multi();                // free multi arrays
+  void setup_plan();                        // create persistent requests
+  void free_plan();                         // free persistent requests
 };
 
 }
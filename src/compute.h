@@ -109,6 +109,14 @@ class Compute : protected Pointers {
 
   virtual void reset_extra_compute_fix(const char *);
 
+  // called back by Pair and Bond for computes registered with them
+
+  virtual void pair_setup_callback(int, int) {}
+  virtual void pair_tally_callback(int, int, int, int, double, double,
+                                   double, double, double, double) {}
+  virtual void bond_tally_callback(int, int, int, int, double,
+                                   double, double, double, double) {}
+
   void addstep(bigint);
   int matchstep(bigint);
   void clearstep();
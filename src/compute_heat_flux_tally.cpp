@@ -0,0 +1,278 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "string.h"
+#include "compute_heat_flux_tally.h"
+#include "atom.h"
+#include "update.h"
+#include "comm.h"
+#include "force.h"
+#include "pair.h"
+#include "bond.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define EPSILON 1.0e-6
+
+/* ---------------------------------------------------------------------- */
+
+ComputeHeatFluxTally::ComputeHeatFluxTally(LAMMPS *lmp, int narg, char **arg) :
+  Compute(lmp, narg, arg)
+{
+  if (narg != 3) error->all(FLERR,"Illegal compute heat/flux/tally command");
+
+  vector_flag = 1;
+  size_vector = 6;
+  extvector = 1;
+
+  // energy must be tallied on steps this compute is invoked
+  // per-atom energy and virial are summed from ghost atoms
+
+  peflag = 1;
+  timeflag = 1;
+  comm_reverse = 7;
+
+  nmax = 0;
+  evatom = NULL;
+
+  vector = new double[6];
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputeHeatFluxTally::~ComputeHeatFluxTally()
+{
+  // force is NULL if pair and bond styles have already been deleted
+
+  if (force && force->pair) force->pair->del_tally_callback(this);
+  if (force && force->bond) force->bond->del_tally_callback(this);
+
+  memory->destroy(evatom);
+  delete [] vector;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::init()
+{
+  if (force->pair == NULL)
+    error->all(FLERR,"Compute heat/flux/tally requires a pair style be defined");
+  if (strstr(update->integrate_style,"respa"))
+    error->all(FLERR,"Compute heat/flux/tally does not support run_style respa");
+
+  // only pair and bond styles call back to this compute
+
+  if (force->angle || force->dihedral || force->improper)
+    error->all(FLERR,"Compute heat/flux/tally does not support angle, "
+               "dihedral, or improper styles");
+  if (force->kspace)
+    error->all(FLERR,"Compute heat/flux/tally does not support kspace styles");
+
+  // (re)register since pair or bond style may have been redefined
+
+  force->pair->add_tally_callback(this);
+  if (force->bond) force->bond->add_tally_callback(this);
+}
+
+/* ----------------------------------------------------------------------
+   called by top-level Pair::ev_setup() at start of each force evaluation
+   ntotal includes ghosts if either newton flag is set
+------------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::pair_setup_callback(int eflag, int vflag)
+{
+  if (atom->nmax > nmax) {
+    memory->destroy(evatom);
+    nmax = atom->nmax;
+    memory->create(evatom,nmax,7,"heat/flux/tally:evatom");
+  }
+
+  int ntotal = atom->nlocal;
+  if (force->newton) ntotal += atom->nghost;
+
+  for (int i = 0; i < ntotal; i++)
+    for (int m = 0; m < 7; m++) evatom[i][m] = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   called by Pair::ev_tally() for each pairwise interaction
+   each atom gets half of the pair energy and half of the pair virial,
+     same as the per-atom energy and virial of the pair style would
+------------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::pair_tally_callback(int i, int j, int nlocal,
+                                               int newton_pair,
+                                               double evdwl, double ecoul,
+                                               double fpair, double delx,
+                                               double dely, double delz)
+{
+  double epairhalf = 0.5 * (evdwl + ecoul);
+
+  double v[6];
+  v[0] = 0.5*delx*delx*fpair;
+  v[1] = 0.5*dely*dely*fpair;
+  v[2] = 0.5*delz*delz*fpair;
+  v[3] = 0.5*delx*dely*fpair;
+  v[4] = 0.5*delx*delz*fpair;
+  v[5] = 0.5*dely*delz*fpair;
+
+  if (newton_pair || i < nlocal) tally(i,epairhalf,v);
+  if (newton_pair || j < nlocal) tally(j,epairhalf,v);
+}
+
+/* ----------------------------------------------------------------------
+   called by Bond::ev_tally() for each bond
+------------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::bond_tally_callback(int i, int j, int nlocal,
+                                               int newton_bond,
+                                               double ebond, double fbond,
+                                               double delx, double dely,
+                                               double delz)
+{
+  double ebondhalf = 0.5 * ebond;
+
+  double v[6];
+  v[0] = 0.5*delx*delx*fbond;
+  v[1] = 0.5*dely*dely*fbond;
+  v[2] = 0.5*delz*delz*fbond;
+  v[3] = 0.5*delx*dely*fbond;
+  v[4] = 0.5*delx*delz*fbond;
+  v[5] = 0.5*dely*delz*fbond;
+
+  if (newton_bond || i < nlocal) tally(i,ebondhalf,v);
+  if (newton_bond || j < nlocal) tally(j,ebondhalf,v);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::tally(int i, double eng, double *v)
+{
+  double *one = evatom[i];
+  one[0] += eng;
+  one[1] += v[0];
+  one[2] += v[1];
+  one[3] += v[2];
+  one[4] += v[3];
+  one[5] += v[4];
+  one[6] += v[5];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::compute_vector()
+{
+  invoked_vector = update->ntimestep;
+  if (update->eflag_global != invoked_vector)
+    error->all(FLERR,"Energy was not tallied on needed timestep");
+
+  // communicate ghost energy and virial between neighbor procs
+
+  if (force->newton) comm->reverse_comm_compute(this);
+
+  // heat flux vector = jc[3] + jv[3]
+  // jc[3] = convective portion of heat flux = sum_i (ke_i + pe_i) v_i[3]
+  // jv[3] = virial portion of heat flux = sum_i (virial_tensor_i . v_i[3])
+  // pe_i and virial_tensor_i were tallied during the force computation,
+  //   but use the velocities at the end of the step
+  // normalization by volume is not included
+
+  double **v = atom->v;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  double mvv2e = force->mvv2e;
+  double jc[3] = {0.0,0.0,0.0};
+  double jv[3] = {0.0,0.0,0.0};
+  double etally = 0.0;
+  double eng,*w;
+
+  for (int i = 0; i < nlocal; i++) {
+    etally += evatom[i][0];
+    if (mask[i] & groupbit) {
+      eng = v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+      if (rmass) eng *= 0.5*mvv2e*rmass[i];
+      else eng *= 0.5*mvv2e*mass[type[i]];
+      eng += evatom[i][0];
+      jc[0] += eng*v[i][0];
+      jc[1] += eng*v[i][1];
+      jc[2] += eng*v[i][2];
+      w = &evatom[i][1];
+      jv[0] += w[0]*v[i][0] + w[3]*v[i][1] + w[4]*v[i][2];
+      jv[1] += w[3]*v[i][0] + w[1]*v[i][1] + w[5]*v[i][2];
+      jv[2] += w[4]*v[i][0] + w[5]*v[i][1] + w[2]*v[i][2];
+    }
+  }
+
+  // sum across all procs
+  // 1st 3 terms are total heat flux
+  // 2nd 3 terms are just convective portion
+  // last 2 terms are tallied energy and pair + bond energy, which differ
+  //   if the pair or bond style adds energy outside of ev_tally()
+
+  double epot = force->pair->eng_vdwl + force->pair->eng_coul;
+  if (force->bond) epot += force->bond->energy;
+
+  double data[8] = {jc[0]+jv[0],jc[1]+jv[1],jc[2]+jv[2],jc[0],jc[1],jc[2],
+                    etally,epot};
+  double all[8];
+  MPI_Allreduce(data,all,8,MPI_DOUBLE,MPI_SUM,world);
+
+  if (fabs(all[6]-all[7]) > EPSILON*(fabs(all[6])+fabs(all[7])) + EPSILON)
+    error->all(FLERR,"Compute heat/flux/tally energy does not match "
+               "pair and bond energy");
+
+  for (int m = 0; m < 6; m++) vector[m] = all[m];
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ComputeHeatFluxTally::pack_reverse_comm(int n, int first, double *buf)
+{
+  int i,k,m,last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++)
+    for (k = 0; k < 7; k++) buf[m++] = evatom[i][k];
+  return 7;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeHeatFluxTally::unpack_reverse_comm(int n, int *list, double *buf)
+{
+  int i,j,k,m;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    for (k = 0; k < 7; k++) evatom[j][k] += buf[m++];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local atom-based array
+------------------------------------------------------------------------- */
+
+double ComputeHeatFluxTally::memory_usage()
+{
+  double bytes = nmax*7 * sizeof(double);
+  return bytes;
+}
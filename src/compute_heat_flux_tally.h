@@ -0,0 +1,94 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(heat/flux/tally,ComputeHeatFluxTally)
+
+#else
+
+#ifndef LMP_COMPUTE_HEAT_FLUX_TALLY_H
+#define LMP_COMPUTE_HEAT_FLUX_TALLY_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputeHeatFluxTally : public Compute {
+ public:
+  ComputeHeatFluxTally(class LAMMPS *, int, char **);
+  ~ComputeHeatFluxTally();
+  void init();
+  void compute_vector();
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+  double memory_usage();
+
+  void pair_setup_callback(int, int);
+  void pair_tally_callback(int, int, int, int, double, double,
+                           double, double, double, double);
+  void bond_tally_callback(int, int, int, int, double,
+                           double, double, double, double);
+
+ private:
+  int nmax;
+  double **evatom;         // per-atom energy and virial from callbacks
+
+  void tally(int, double, double *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Compute heat/flux/tally requires a pair style be defined
+
+Self-explanatory.
+
+E: Compute heat/flux/tally does not support run_style respa
+
+The tallies are reset once per force evaluation, which is not
+compatible with rRESPA.
+
+E: Compute heat/flux/tally does not support angle, dihedral, or improper styles
+
+Only the pair and bond styles pass their interactions to this compute.
+Use compute heat/flux instead.
+
+E: Compute heat/flux/tally does not support kspace styles
+
+The long-range energy and virial are not split into per-atom
+contributions for this compute.  Use compute heat/flux instead.
+
+E: Compute heat/flux/tally energy does not match pair and bond energy
+
+The pair or bond style adds energy that is not tallied via its
+ev_tally() routine, e.g. the embedding energy of EAM.  Use compute
+heat/flux instead.
+
+E: Energy was not tallied on needed timestep
+
+You are using a thermo keyword that requires potentials to
+have tallied energy, but they didn't on this timestep.  See the
+variable doc page for ideas on how to make this work.
+
+*/
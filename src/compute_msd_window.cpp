@@ -0,0 +1,381 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   order-n multiple-origin MSD
+   Dubbeldam, Ford, Ellis, Snurr, Mol Sim, 35, 1084 (2009)
+------------------------------------------------------------------------- */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "compute_msd_window.h"
+#include "fix_msd_window.h"
+#include "atom.h"
+#include "update.h"
+#include "group.h"
+#include "domain.h"
+#include "modify.h"
+#include "comm.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ComputeMSDWindow::ComputeMSDWindow(LAMMPS *lmp, int narg, char **arg) :
+  Compute(lmp, narg, arg)
+{
+  if (narg < 6) error->all(FLERR,"Illegal compute msd/window command");
+
+  nevery = atoi(arg[3]);
+  nblock = atoi(arg[4]);
+  nlevel = atoi(arg[5]);
+  if (nevery <= 0 || nblock < 2 || nlevel <= 0)
+    error->all(FLERR,"Illegal compute msd/window command");
+
+  bigint longest = 1;
+  for (int k = 1; k < nlevel; k++) {
+    longest *= nblock;
+    if (longest > MAXSMALLINT)
+      error->all(FLERR,"Compute msd/window Nblock and Nlevel are too large");
+  }
+
+  // optional args
+
+  comflag = 0;
+  molflag = 0;
+
+  int iarg = 6;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"com") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal compute msd/window command");
+      if (strcmp(arg[iarg+1],"no") == 0) comflag = 0;
+      else if (strcmp(arg[iarg+1],"yes") == 0) comflag = 1;
+      else error->all(FLERR,"Illegal compute msd/window command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"molecule") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal compute msd/window command");
+      if (strcmp(arg[iarg+1],"no") == 0) molflag = 0;
+      else if (strcmp(arg[iarg+1],"yes") == 0) molflag = 1;
+      else error->all(FLERR,"Illegal compute msd/window command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal compute msd/window command");
+  }
+
+  if (molflag && atom->molecular == 0)
+    error->all(FLERR,
+               "Compute msd/window molecule requires molecular atom style");
+
+  // one row per lag time
+  // level k stores Nblock-1 origins spaced by Nblock^k samples,
+  //   so lags on level k are j*Nblock^k samples for j = 1 to Nblock-1
+
+  nslot = nblock - 1;
+  nvalues = 3*nlevel*nslot;
+
+  array_flag = 1;
+  size_array_rows = nlevel*nslot;
+  size_array_cols = 5;
+  extarray = 0;
+
+  memory->create(sum,size_array_rows,5,"msd/window:sum");
+  memory->create(sumall,size_array_rows,5,"msd/window:sumall");
+  memory->create(array,size_array_rows,5,"msd/window:array");
+
+  bigint stride = nevery;
+  for (int k = 0; k < nlevel; k++) {
+    for (int j = 0; j < nslot; j++) {
+      int m = k*nslot + j;
+      for (int n = 0; n < 5; n++) sum[m][n] = array[m][n] = 0.0;
+      array[m][0] = (j+1) * stride;
+    }
+    stride *= nblock;
+  }
+
+  nfill = new int[nlevel];
+  head = new int[nlevel];
+  for (int k = 0; k < nlevel; k++) {
+    nfill[k] = 0;
+    head[k] = nslot-1;
+  }
+  nsample = 0;
+
+  // molecule COMs are computed by all procs
+  // history of each molecule is stored by one proc, round robin
+
+  nmolecules = nmine = 0;
+  massproc = massmol = NULL;
+  com = comall = mhist = NULL;
+
+  if (molflag) {
+    nmolecules = molecules_in_group(idlo,idhi);
+    nmine = nmolecules/comm->nprocs;
+    if (comm->me < nmolecules % comm->nprocs) nmine++;
+
+    memory->create(massproc,nmolecules,"msd/window:massproc");
+    memory->create(massmol,nmolecules,"msd/window:massmol");
+    memory->create(com,nmolecules,3,"msd/window:com");
+    memory->create(comall,nmolecules,3,"msd/window:comall");
+    memory->create(mhist,nmine,nvalues,"msd/window:mhist");
+
+    int *mask = atom->mask;
+    int *molecule = atom->molecule;
+    int *type = atom->type;
+    double *mass = atom->mass;
+    double *rmass = atom->rmass;
+    int nlocal = atom->nlocal;
+
+    int imol;
+    double massone;
+
+    for (int i = 0; i < nmolecules; i++) massproc[i] = 0.0;
+
+    for (int i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        if (rmass) massone = rmass[i];
+        else massone = mass[type[i]];
+        imol = molecule[i];
+        if (molmap) imol = molmap[imol-idlo];
+        else imol--;
+        massproc[imol] += massone;
+      }
+
+    MPI_Allreduce(massproc,massmol,nmolecules,MPI_DOUBLE,MPI_SUM,world);
+  }
+
+  // create a new fix MSD_WINDOW style
+  // id = compute-ID + MSD_WINDOW, fix group = compute group
+  // per-atom history is only needed when not averaging over molecules
+
+  int n = strlen(id) + strlen("_MSD_WINDOW") + 1;
+  id_fix = new char[n];
+  strcpy(id_fix,id);
+  strcat(id_fix,"_MSD_WINDOW");
+
+  char str1[16],str2[16];
+  sprintf(str1,"%d",nevery);
+  if (molflag) sprintf(str2,"%d",0);
+  else sprintf(str2,"%d",nvalues);
+
+  char **newarg = new char*[6];
+  newarg[0] = id_fix;
+  newarg[1] = group->names[igroup];
+  newarg[2] = (char *) "MSD_WINDOW";
+  newarg[3] = id;
+  newarg[4] = str1;
+  newarg[5] = str2;
+  modify->add_fix(6,newarg);
+  delete [] newarg;
+
+  fix = (FixMSDWindow *) modify->fix[modify->nfix-1];
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputeMSDWindow::~ComputeMSDWindow()
+{
+  // check nfix in case all fixes have already been deleted
+
+  if (modify->nfix) modify->delete_fix(id_fix);
+
+  delete [] id_fix;
+  delete [] nfill;
+  delete [] head;
+  memory->destroy(sum);
+  memory->destroy(sumall);
+  memory->destroy(array);
+  memory->destroy(massproc);
+  memory->destroy(massmol);
+  memory->destroy(com);
+  memory->destroy(comall);
+  memory->destroy(mhist);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeMSDWindow::init()
+{
+  // set fix which stores per-atom history
+
+  int ifix = modify->find_fix(id_fix);
+  if (ifix < 0) error->all(FLERR,"Could not find compute msd/window fix ID");
+  fix = (FixMSDWindow *) modify->fix[ifix];
+
+  if (molflag) {
+    int ntmp = molecules_in_group(idlo,idhi);
+    if (ntmp != nmolecules)
+      error->all(FLERR,"Molecule count changed in compute msd/window");
+  }
+
+  if (comflag) masstotal = group->mass(igroup);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeMSDWindow::compute_array()
+{
+  invoked_array = update->ntimestep;
+
+  int nrows = size_array_rows;
+  MPI_Allreduce(&sum[0][0],&sumall[0][0],5*nrows,MPI_DOUBLE,MPI_SUM,world);
+
+  for (int m = 0; m < nrows; m++) {
+    if (sumall[m][4] > 0.0) {
+      array[m][1] = sumall[m][0] / sumall[m][4];
+      array[m][2] = sumall[m][1] / sumall[m][4];
+      array[m][3] = sumall[m][2] / sumall[m][4];
+      array[m][4] = sumall[m][3] / sumall[m][4];
+    } else array[m][1] = array[m][2] = array[m][3] = array[m][4] = 0.0;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   take one sample, called by fix every Nevery steps
+   level k takes a new time origin every Nblock^k samples
+   displacements from all stored origins of those levels are accumulated,
+     then the current position replaces the oldest origin on each level
+------------------------------------------------------------------------- */
+
+void ComputeMSDWindow::sample()
+{
+  int i,k,imol;
+  double massone;
+  double unwrap[3];
+
+  int nactive = 0;
+  bigint stride = 1;
+  for (k = 0; k < nlevel; k++) {
+    if (nsample % stride) break;
+    nactive++;
+    stride *= nblock;
+  }
+
+  // cm = current center of mass of group
+
+  double cm[3];
+  if (comflag) group->xcm(igroup,masstotal,cm);
+  else cm[0] = cm[1] = cm[2] = 0.0;
+
+  double **x = atom->x;
+  int *mask = atom->mask;
+  tagint *image = atom->image;
+  int nlocal = atom->nlocal;
+
+  if (!molflag) {
+    double **hist = fix->hist;
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        domain->unmap(x[i],image[i],unwrap);
+        unwrap[0] -= cm[0];
+        unwrap[1] -= cm[1];
+        unwrap[2] -= cm[2];
+        accumulate(unwrap,hist[i],nactive);
+      }
+
+  } else {
+    int *molecule = atom->molecule;
+    int *type = atom->type;
+    double *mass = atom->mass;
+    double *rmass = atom->rmass;
+
+    for (i = 0; i < nmolecules; i++)
+      com[i][0] = com[i][1] = com[i][2] = 0.0;
+
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        imol = molecule[i];
+        if (molmap) imol = molmap[imol-idlo];
+        else imol--;
+        domain->unmap(x[i],image[i],unwrap);
+        if (rmass) massone = rmass[i];
+        else massone = mass[type[i]];
+        com[imol][0] += unwrap[0] * massone;
+        com[imol][1] += unwrap[1] * massone;
+        com[imol][2] += unwrap[2] * massone;
+      }
+
+    MPI_Allreduce(&com[0][0],&comall[0][0],3*nmolecules,
+                  MPI_DOUBLE,MPI_SUM,world);
+
+    int me = comm->me;
+    int nprocs = comm->nprocs;
+    for (i = me; i < nmolecules; i += nprocs) {
+      unwrap[0] = comall[i][0]/massmol[i] - cm[0];
+      unwrap[1] = comall[i][1]/massmol[i] - cm[1];
+      unwrap[2] = comall[i][2]/massmol[i] - cm[2];
+      accumulate(unwrap,mhist[i/nprocs],nactive);
+    }
+  }
+
+  for (k = 0; k < nactive; k++) {
+    head[k]++;
+    if (head[k] == nslot) head[k] = 0;
+    if (nfill[k] < nslot) nfill[k]++;
+  }
+  nsample++;
+}
+
+/* ----------------------------------------------------------------------
+   accumulate displacements of one atom or molecule at xnow
+   from the origins in its history h on the first nactive levels
+   then store xnow as newest origin on those levels
+------------------------------------------------------------------------- */
+
+void ComputeMSDWindow::accumulate(double *xnow, double *h, int nactive)
+{
+  int j,slot;
+  double dx,dy,dz;
+  double *hk,*xold,*one;
+
+  for (int k = 0; k < nactive; k++) {
+    hk = &h[3*k*nslot];
+    slot = head[k];
+    for (j = 0; j < nfill[k]; j++) {
+      xold = &hk[3*slot];
+      dx = xnow[0] - xold[0];
+      dy = xnow[1] - xold[1];
+      dz = xnow[2] - xold[2];
+      one = sum[k*nslot+j];
+      one[0] += dx*dx;
+      one[1] += dy*dy;
+      one[2] += dz*dz;
+      one[3] += dx*dx + dy*dy + dz*dz;
+      one[4] += 1.0;
+      if (--slot < 0) slot = nslot-1;
+    }
+
+    slot = head[k] + 1;
+    if (slot == nslot) slot = 0;
+    hk[3*slot] = xnow[0];
+    hk[3*slot+1] = xnow[1];
+    hk[3*slot+2] = xnow[2];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local data
+------------------------------------------------------------------------- */
+
+double ComputeMSDWindow::memory_usage()
+{
+  double bytes = 3*size_array_rows*5 * sizeof(double);
+  if (molflag) {
+    bytes += 2*nmolecules * sizeof(double);
+    if (molmap) bytes += (idhi-idlo+1) * sizeof(int);
+    bytes += 2*nmolecules*3 * sizeof(double);
+    bytes += nmine*nvalues * sizeof(double);
+  }
+  return bytes;
+}
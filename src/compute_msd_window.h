@@ -0,0 +1,91 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(msd/window,ComputeMSDWindow)
+
+#else
+
+#ifndef LMP_COMPUTE_MSD_WINDOW_H
+#define LMP_COMPUTE_MSD_WINDOW_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputeMSDWindow : public Compute {
+ public:
+  ComputeMSDWindow(class LAMMPS *, int, char **);
+  ~ComputeMSDWindow();
+  void init();
+  void compute_array();
+  double memory_usage();
+
+  void sample();
+
+ private:
+  int nevery,nblock,nlevel;
+  int nslot;                // # of stored origins per level = Nblock-1
+  int nvalues;              // # of history values per atom or molecule
+  int comflag,molflag;
+  char *id_fix;
+  class FixMSDWindow *fix;
+
+  bigint nsample;           // # of samples taken so far
+  int *nfill;               // # of stored origins on each level
+  int *head;                // slot of most recent origin on each level
+  double **sum,**sumall;    // accumulated dx^2,dy^2,dz^2,dr^2,count per lag
+
+  double masstotal;         // mass of group, for com option
+
+  int nmolecules,nmine;     // # of molecules in group and owned by me
+  int idlo,idhi;
+  double *massproc,*massmol;
+  double **com,**comall;
+  double **mhist;           // history of molecules owned by me
+
+  void accumulate(double *, double *, int);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Compute msd/window Nblock and Nlevel are too large
+
+The longest lag time Nblock^(Nlevel-1) samples cannot exceed the
+largest integer.
+
+E: Compute msd/window molecule requires molecular atom style
+
+Self-explanatory.
+
+E: Could not find compute msd/window fix ID
+
+Self-explanatory.
+
+E: Molecule count changed in compute msd/window
+
+Number of molecules must remain constant over time.
+
+*/
@@ -74,6 +74,38 @@ double ComputePE::compute_scalar()
   if (update->eflag_global != invoked_scalar)
     error->all(FLERR,"Energy was not tallied on needed timestep");
 
+  double one = energy_local();
+  MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
+  energy_global();
+
+  return scalar;
+}
+
+/* ----------------------------------------------------------------------
+   same as compute_scalar(), but for an energy from energy_local()
+     already summed across procs by the caller
+   allows a time integrator to reduce the energy together with
+     its own KE and virial in a single collective
+------------------------------------------------------------------------- */
+
+double ComputePE::compute_scalar_reduced(double sum)
+{
+  invoked_scalar = update->ntimestep;
+  if (update->eflag_global != invoked_scalar)
+    error->all(FLERR,"Energy was not tallied on needed timestep");
+
+  scalar = sum;
+  energy_global();
+
+  return scalar;
+}
+
+/* ----------------------------------------------------------------------
+   sum contributions to energy from forces on this proc
+------------------------------------------------------------------------- */
+
+double ComputePE::energy_local()
+{
   double one = 0.0;
   if (pairflag && force->pair)
     one += force->pair->eng_vdwl + force->pair->eng_coul + force->pair->eng_pol;
@@ -85,8 +117,15 @@ double ComputePE::compute_scalar()
     if (improperflag && force->improper) one += force->improper->energy;
   }
 
-  MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
+  return one;
+}
+
+/* ----------------------------------------------------------------------
+   add global contributions to energy summed across procs
+------------------------------------------------------------------------- */
 
+void ComputePE::energy_global()
+{
   if (kspaceflag && force->kspace) scalar += force->kspace->energy;
 
   if (pairflag && force->pair && force->pair->tail_flag) {
@@ -95,6 +134,4 @@ double ComputePE::compute_scalar()
   }
 
   if (thermoflag && modify->n_thermo_energy) scalar += modify->thermo_energy();
-
-  return scalar;
 }
@@ -30,9 +30,13 @@ class ComputePE : public Compute {
   ~ComputePE() {}
   void init() {}
   double compute_scalar();
+  double compute_scalar_reduced(double);
+  double energy_local();
 
  private:
   int pairflag,bondflag,angleflag,dihedralflag,improperflag,kspaceflag;
+
+  void energy_global();
 };
 
 }
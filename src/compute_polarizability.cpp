@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "string.h"
+#include "compute_polarizability.h"
+#include "pair_polarization.h"
+#include "atom.h"
+#include "update.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ComputePolarizability::ComputePolarizability(LAMMPS *lmp, int narg, char **arg) :
+  Compute(lmp, narg, arg)
+{
+  if (narg != 3) error->all(FLERR,"Illegal compute polarizability command");
+
+  vector_flag = 1;
+  size_vector = 9;
+  extvector = 1;
+
+  // per-molecule tensors for molecular systems
+
+  nmolecules = 0;
+  alpha = array = NULL;
+
+  if (atom->molecular) {
+    nmolecules = molecules_in_group(idlo,idhi);
+    memory->create(alpha,nmolecules,9,"polarizability:alpha");
+    memory->create(array,nmolecules,9,"polarizability:array");
+    array_flag = 1;
+    size_array_rows = nmolecules;
+    size_array_cols = 9;
+    extarray = 0;
+  }
+
+  vector = new double[9];
+
+  nmax = 0;
+  mu = NULL;
+  pair = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputePolarizability::~ComputePolarizability()
+{
+  delete [] vector;
+  memory->destroy(alpha);
+  memory->destroy(array);
+  memory->destroy(mu);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputePolarizability::init()
+{
+  pair = (PairPolarization *) force->pair_match("polarization",0);
+  if (pair == NULL)
+    error->all(FLERR,"Compute polarizability requires pair style polarization");
+
+  if (atom->molecular) {
+    int ntmp = molecules_in_group(idlo,idhi);
+    if (ntmp != nmolecules)
+      error->all(FLERR,"Molecule count changed in compute polarizability");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputePolarizability::compute_vector()
+{
+  invoked_vector = update->ntimestep;
+
+  solve();
+
+  MPI_Allreduce(one,vector,9,MPI_DOUBLE,MPI_SUM,world);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputePolarizability::compute_array()
+{
+  invoked_array = update->ntimestep;
+
+  solve();
+
+  if (nmolecules)
+    MPI_Allreduce(&alpha[0][0],&array[0][0],nmolecules*9,
+                  MPI_DOUBLE,MPI_SUM,world);
+}
+
+/* ----------------------------------------------------------------------
+   induced dipoles for unit fields along x, y, and z in one solve,
+     summed over the atoms in the group and over each molecule
+   the vector and the array of the same timestep share the solve
+   column b of a tensor is the total dipole for the field along b,
+     ordered xx,xy,xz,yx,yy,yz,zx,zy,zz
+------------------------------------------------------------------------- */
+
+void ComputePolarizability::solve()
+{
+  int i,a,b,imol;
+
+  if (invoked_vector == invoked_array) return;
+
+  if (atom->nlocal > nmax) {
+    memory->destroy(mu);
+    nmax = atom->nmax;
+    memory->create(mu,nmax,9,"polarizability:mu");
+  }
+
+  pair->solve_polarizability(mu);
+
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+
+  for (a = 0; a < 9; a++) one[a] = 0.0;
+  for (i = 0; i < nmolecules; i++)
+    for (a = 0; a < 9; a++) alpha[i][a] = 0.0;
+
+  for (i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      for (a = 0; a < 3; a++)
+        for (b = 0; b < 3; b++)
+          one[3*a+b] += mu[i][3*b+a];
+      if (nmolecules == 0) continue;
+      imol = molecule[i];
+      if (molmap) imol = molmap[imol-idlo];
+      else imol--;
+      for (a = 0; a < 3; a++)
+        for (b = 0; b < 3; b++)
+          alpha[imol][3*a+b] += mu[i][3*b+a];
+    }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local data
+------------------------------------------------------------------------- */
+
+double ComputePolarizability::memory_usage()
+{
+  double bytes = nmax*9 * sizeof(double);
+  bytes += 2*nmolecules*9 * sizeof(double);
+  if (molmap) bytes += (idhi-idlo+1) * sizeof(int);
+  return bytes;
+}
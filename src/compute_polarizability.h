@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(polarizability,ComputePolarizability)
+
+#else
+
+#ifndef LMP_COMPUTE_POLARIZABILITY_H
+#define LMP_COMPUTE_POLARIZABILITY_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputePolarizability : public Compute {
+ public:
+  ComputePolarizability(class LAMMPS *, int, char **);
+  ~ComputePolarizability();
+  void init();
+  void compute_vector();
+  void compute_array();
+  double memory_usage();
+
+ private:
+  int nmolecules;
+  int idlo,idhi;
+  int nmax;
+
+  class PairPolarization *pair;
+  double **mu;                 // dipoles for unit fields along x,y,z
+  double **alpha;              // per-molecule tensors on this proc
+  double one[9];
+
+  void solve();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Compute polarizability requires pair style polarization
+
+The dipoles are solved with the settings and dipole field tensor of
+pair_style polarization or lj/cut/coul/long/polarization, which must
+be defined, also as a sub-style of pair_style hybrid/overlay.
+
+E: Molecule count changed in compute polarizability
+
+Number of molecules must remain constant over time.
+
+*/
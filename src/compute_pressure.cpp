@@ -169,8 +169,64 @@ double ComputePressure::compute_scalar()
   if (update->vflag_global != invoked_scalar)
     error->all(FLERR,"Virial was not tallied on needed timestep");
 
-  // invoke temperature it it hasn't been already
+  if (dimension == 3) virial_compute(3,3);
+  else virial_compute(2,2);
+  return pressure_scalar();
+}
+
+/* ----------------------------------------------------------------------
+   compute pressure tensor
+   assume KE tensor has already been computed
+------------------------------------------------------------------------- */
+
+void ComputePressure::compute_vector()
+{
+  invoked_vector = update->ntimestep;
+  if (update->vflag_global != invoked_vector)
+    error->all(FLERR,"Virial was not tallied on needed timestep");
+
+  if (dimension == 3) virial_compute(6,3);
+  else virial_compute(4,2);
+  pressure_vector();
+}
+
+/* ----------------------------------------------------------------------
+   same as compute_scalar() and compute_vector(), but for a virial
+     already summed across procs by the caller
+   allows a time integrator to reduce the virial from virial_local()
+     together with its own KE tensor in a single collective
+------------------------------------------------------------------------- */
 
+double ComputePressure::compute_scalar_reduced(double *vsum)
+{
+  invoked_scalar = update->ntimestep;
+  if (update->vflag_global != invoked_scalar)
+    error->all(FLERR,"Virial was not tallied on needed timestep");
+
+  if (dimension == 3) virial_global(vsum,3,3);
+  else virial_global(vsum,2,2);
+  return pressure_scalar();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputePressure::compute_vector_reduced(double *vsum)
+{
+  invoked_vector = update->ntimestep;
+  if (update->vflag_global != invoked_vector)
+    error->all(FLERR,"Virial was not tallied on needed timestep");
+
+  if (dimension == 3) virial_global(vsum,6,3);
+  else virial_global(vsum,4,2);
+  pressure_vector();
+}
+
+/* ----------------------------------------------------------------------
+   total pressure from current virial, invoke temperature if needed
+------------------------------------------------------------------------- */
+
+double ComputePressure::pressure_scalar()
+{
   double t;
   if (keflag) {
     if (temperature->invoked_scalar != update->ntimestep)
@@ -179,16 +235,12 @@ double ComputePressure::compute_scalar()
   }
 
   if (dimension == 3) {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
-    virial_compute(3,3);
     if (keflag)
       scalar = (temperature->dof * boltz * t +
                 virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
     else
       scalar = (virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
   } else {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd);
-    virial_compute(2,2);
     if (keflag)
       scalar = (temperature->dof * boltz * t +
                 virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
@@ -200,18 +252,11 @@ double ComputePressure::compute_scalar()
 }
 
 /* ----------------------------------------------------------------------
-   compute pressure tensor
-   assume KE tensor has already been computed
+   pressure tensor from current virial, invoke temperature if needed
 ------------------------------------------------------------------------- */
 
-void ComputePressure::compute_vector()
+void ComputePressure::pressure_vector()
 {
-  invoked_vector = update->ntimestep;
-  if (update->vflag_global != invoked_vector)
-    error->all(FLERR,"Virial was not tallied on needed timestep");
-
-  // invoke temperature if it hasn't been already
-
   double *ke_tensor;
   if (keflag) {
     if (temperature->invoked_vector != update->ntimestep)
@@ -220,8 +265,6 @@ void ComputePressure::compute_vector()
   }
 
   if (dimension == 3) {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
-    virial_compute(6,3);
     if (keflag) {
       for (int i = 0; i < 6; i++)
         vector[i] = (ke_tensor[i] + virial[i]) * inv_volume * nktv2p;
@@ -229,8 +272,6 @@ void ComputePressure::compute_vector()
       for (int i = 0; i < 6; i++)
         vector[i] = virial[i] * inv_volume * nktv2p;
   } else {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd);
-    virial_compute(4,2);
     if (keflag) {
       vector[0] = (ke_tensor[0] + virial[0]) * inv_volume * nktv2p;
       vector[1] = (ke_tensor[1] + virial[1]) * inv_volume * nktv2p;
@@ -248,22 +289,48 @@ void ComputePressure::compute_vector()
 /* ---------------------------------------------------------------------- */
 
 void ComputePressure::virial_compute(int n, int ndiag)
+{
+  double v[6],vsum[6];
+
+  virial_local(v,n);
+
+  // sum virial across procs
+
+  MPI_Allreduce(v,vsum,n,MPI_DOUBLE,MPI_SUM,world);
+
+  virial_global(vsum,n,ndiag);
+}
+
+/* ----------------------------------------------------------------------
+   sum contributions to virial from forces and fixes on this proc
+------------------------------------------------------------------------- */
+
+void ComputePressure::virial_local(double *v, int n)
 {
   int i,j;
-  double v[6],*vcomponent;
+  double *vcomponent;
 
   for (i = 0; i < n; i++) v[i] = 0.0;
 
-  // sum contributions to virial from forces and fixes
-
   for (j = 0; j < nvirial; j++) {
     vcomponent = vptr[j];
     for (i = 0; i < n; i++) v[i] += vcomponent[i];
   }
+}
 
-  // sum virial across procs
+/* ----------------------------------------------------------------------
+   set virial from sum across procs and add global contributions
+------------------------------------------------------------------------- */
+
+void ComputePressure::virial_global(double *vsum, int n, int ndiag)
+{
+  int i;
+
+  if (dimension == 3)
+    inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
+  else inv_volume = 1.0 / (domain->xprd * domain->yprd);
 
-  MPI_Allreduce(v,virial,n,MPI_DOUBLE,MPI_SUM,world);
+  for (i = 0; i < n; i++) virial[i] = vsum[i];
 
   // KSpace virial contribution is already summed across procs
 
@@ -31,6 +31,9 @@ class ComputePressure : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  double compute_scalar_reduced(double *);
+  void compute_vector_reduced(double *);
+  void virial_local(double *, int);
   void reset_extra_compute_fix(const char *);
 
  protected:
@@ -45,6 +48,9 @@ class ComputePressure : public Compute {
   int fixflag,kspaceflag;
 
   void virial_compute(int, int);
+  void virial_global(double *, int, int);
+  double pressure_scalar();
+  void pressure_vector();
 };
 
 }
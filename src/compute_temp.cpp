@@ -134,3 +134,19 @@ void ComputeTemp::compute_vector()
   MPI_Allreduce(t,vector,6,MPI_DOUBLE,MPI_SUM,world);
   for (i = 0; i < 6; i++) vector[i] *= force->mvv2e;
 }
+
+/* ----------------------------------------------------------------------
+   set scalar and vector from sum of m v_a v_b already summed across
+     procs by the caller, in the order xx,yy,zz,xy,xz,yz
+   allows a time integrator to accumulate the KE tensor in its own
+     velocity update and reduce it in a single collective
+------------------------------------------------------------------------- */
+
+void ComputeTemp::compute_reduced(double *ke)
+{
+  invoked_scalar = invoked_vector = update->ntimestep;
+
+  if (dynamic) dof_compute();
+  scalar = (ke[0] + ke[1] + ke[2]) * tfactor;
+  for (int i = 0; i < 6; i++) vector[i] = ke[i] * force->mvv2e;
+}
@@ -31,6 +31,7 @@ class ComputeTemp : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  void compute_reduced(double *);
 
  protected:
   int fix_dof;
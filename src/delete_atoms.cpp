@@ -56,6 +56,12 @@ void DeleteAtoms::command(int narg, char **arg)
   else if (strcmp(arg[0],"porosity") == 0) delete_porosity(narg,arg);
   else error->all(FLERR,"Illegal delete_atoms command");
 
+  // clear map entries of owned and ghost atoms while ghosts are intact
+  // set nghost to 0 so old ghosts of deleted atoms won't be mapped
+
+  if (atom->map_style) atom->map_clear();
+  atom->nghost = 0;
+
   // delete local atoms flagged in dlist
   // reset nlocal
 
@@ -85,16 +91,11 @@ void DeleteAtoms::command(int narg, char **arg)
   }
 
   // reset atom->natoms
-  // reset atom->map if it exists
-  // set nghost to 0 so old ghosts of deleted atoms won't be mapped
+  // reset atom->map for remaining owned atoms if it exists
 
   bigint nblocal = atom->nlocal;
   MPI_Allreduce(&nblocal,&atom->natoms,1,MPI_LMP_BIGINT,MPI_SUM,world);
-  if (atom->map_style) {
-    atom->nghost = 0;
-    atom->map_init();
-    atom->map_set();
-  }
+  if (atom->map_style) atom->map_set();
 
   // print before and after atom count
 
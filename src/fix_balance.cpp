@@ -68,6 +68,7 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   // optional args
 
   int outarg = 0;
+  int wtarg = 0;
   fp = NULL;
 
   int iarg = 7;
@@ -76,6 +77,10 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix balance command");
       outarg = iarg+1;
       iarg += 2;
+    } else if (strcmp(arg[iarg],"weight") == 0) {
+      if (iarg+3 > narg) error->all(FLERR,"Illegal fix balance command");
+      wtarg = iarg;
+      iarg += 3;
     } else error->all(FLERR,"Illegal fix balance command");
   }
 
@@ -98,10 +103,17 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   if (nevery) force_reneighbor = 1;
 
   // compute initial outputs
+  // particle weights are first set when the fix balances
 
   imbfinal = imbprev = balance->imbalance_nlocal(maxperproc);
   itercount = 0;
   pending = 0;
+
+  wtflag = 0;
+  if (wtarg) {
+    balance->weight_setup(narg-wtarg,&arg[wtarg]);
+    wtflag = 1;
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -155,6 +167,7 @@ void FixBalance::setup_pre_exchange()
 
   // perform a rebalance if threshhold exceeded
 
+  balance->set_weights();
   imbnow = balance->imbalance_nlocal(maxperproc);
   if (imbnow > thresh) rebalance();
 
@@ -183,6 +196,7 @@ void FixBalance::pre_exchange()
 
   // return if imbalance < threshhold
 
+  balance->set_weights();
   imbnow = balance->imbalance_nlocal(maxperproc);
   if (imbnow <= thresh) {
     if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
@@ -217,6 +231,15 @@ void FixBalance::rebalance()
   imbprev = imbnow;
   itercount = balance->dynamic();
 
+  // weights do not migrate with particles,
+  //   so weighted final imbalance is computed from the new splits
+
+  if (wtflag) {
+    domain->x2lamda(atom->nlocal);
+    imbfinal = balance->imbalance_splits(maxperproc);
+    domain->lamda2x(atom->nlocal);
+  }
+
   // output of final result
 
   if (fp) balance->dumpout(update->ntimestep,fp);
@@ -246,7 +269,7 @@ void FixBalance::rebalance()
   // pending triggers pre_neighbor() to compute final imbalance factor
   // can only be done after atoms migrate in caller's comm->exchange()
 
-  pending = 1;
+  if (!wtflag) pending = 1;
 }
 
 /* ----------------------------------------------------------------------
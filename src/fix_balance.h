@@ -51,6 +51,7 @@ class FixBalance : public Fix {
   int maxperproc;               // max atoms on any processor
   int itercount;                // iteration count of last call to Balance
   int kspace_flag;              // 1 if KSpace solver defined
+  int wtflag;                   // 1 if particles are weighted by cost
   int pending;
 
   class Balance *balance;
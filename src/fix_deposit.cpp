@@ -327,6 +327,7 @@ void FixDeposit::pre_exchange()
              newcoord[0] >= sublo[0] && newcoord[0] < subhi[0]) flag = 1;
 
     if (flag) {
+      atom->map_drop_ghost();
       atom->avec->create_atom(ntype,coord);
       int m = atom->nlocal - 1;
       atom->type[m] = ntype;
@@ -348,18 +349,14 @@ void FixDeposit::pre_exchange()
 
   // reset global natoms
   // set tag # of new particle beyond all previous atoms
-  // if global map exists, reset it now instead of waiting for comm
-  // since deleting atoms messes up ghosts
+  // if global map exists, add new particle to it now,
+  //   it took the slot of a ghost atom that was removed from the map
 
   if (success) {
     atom->natoms += 1;
     if (atom->tag_enable) {
       atom->tag_extend();
-      if (atom->map_style) {
-        atom->nghost = 0;
-        atom->map_init();
-        atom->map_set();
-      }
+      if (flag) atom->map_new_owned(atom->nlocal-1);
     }
   }
 
@@ -83,6 +83,7 @@ FixEfield::FixEfield(LAMMPS *lmp, int narg, char **arg) :
 
   maxatom = 0;
   efield = NULL;
+  field_step = -1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -148,6 +149,10 @@ void FixEfield::init()
 
   if (strstr(update->integrate_style,"respa"))
     nlevels_respa = ((Respa *) update->integrate)->nlevels;
+
+  // force variables to be re-evaluated on the first step of a new run
+
+  field_step = -1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -181,13 +186,10 @@ void FixEfield::post_force(int vflag)
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
-  // reallocate efield array if necessary
+  // variables may already have been evaluated this step
+  //   by a polarization pair style via add_field()
 
-  if (varflag == ATOM && nlocal > maxatom) {
-    maxatom = atom->nmax;
-    memory->destroy(efield);
-    memory->create(efield,maxatom,3,"efield:efield");
-  }
+  compute_field();
 
   // fsum[0] = "potential energy" for added force
   // fsum[123] = extra force added to atoms
@@ -214,24 +216,7 @@ void FixEfield::post_force(int vflag)
         fsum[3] += fz;
       }
 
-  // variable efield, wrap with clear/add
-
   } else {
-
-    modify->clearstep_compute();
-
-    if (xstyle == EQUAL) ex = qe2f * input->variable->compute_equal(xvar);
-    else if (xstyle == ATOM && efield)
-      input->variable->compute_atom(xvar,igroup,&efield[0][0],3,0);
-    if (ystyle == EQUAL) ey = qe2f * input->variable->compute_equal(yvar);
-    else if (ystyle == ATOM && efield)
-      input->variable->compute_atom(yvar,igroup,&efield[0][1],3,0);
-    if (zstyle == EQUAL) ez = qe2f * input->variable->compute_equal(zvar);
-    else if (zstyle == ATOM && efield)
-      input->variable->compute_atom(zvar,igroup,&efield[0][2],3,0);
-
-    modify->addstep_compute(update->ntimestep + 1);
-
     for (int i = 0; i < nlocal; i++)
       if (mask[i] & groupbit) {
         if (xstyle == ATOM) fx = qe2f * q[i]*efield[i][0];
@@ -251,6 +236,79 @@ void FixEfield::post_force(int vflag)
   }
 }
 
+/* ----------------------------------------------------------------------
+   evaluate variable E-field components, at most once per timestep
+   wrap with clear/add
+------------------------------------------------------------------------- */
+
+void FixEfield::compute_field()
+{
+  if (varflag == CONSTANT) return;
+  if (field_step == update->ntimestep) return;
+  field_step = update->ntimestep;
+
+  // reallocate efield array if necessary
+
+  if (varflag == ATOM && atom->nlocal > maxatom) {
+    maxatom = atom->nmax;
+    memory->destroy(efield);
+    memory->create(efield,maxatom,3,"efield:efield");
+  }
+
+  modify->clearstep_compute();
+
+  if (xstyle == EQUAL) ex = qe2f * input->variable->compute_equal(xvar);
+  else if (xstyle == ATOM && efield)
+    input->variable->compute_atom(xvar,igroup,&efield[0][0],3,0);
+  if (ystyle == EQUAL) ey = qe2f * input->variable->compute_equal(yvar);
+  else if (ystyle == ATOM && efield)
+    input->variable->compute_atom(yvar,igroup,&efield[0][1],3,0);
+  if (zstyle == EQUAL) ez = qe2f * input->variable->compute_equal(zvar);
+  else if (zstyle == ATOM && efield)
+    input->variable->compute_atom(zvar,igroup,&efield[0][2],3,0);
+
+  modify->addstep_compute(update->ntimestep + 1);
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if any E component is an atom-style variable, else 0
+   can be called before init() has set xstyle,ystyle,zstyle
+------------------------------------------------------------------------- */
+
+int FixEfield::atom_field()
+{
+  char *str[3] = {xstr,ystr,zstr};
+  for (int m = 0; m < 3; m++) {
+    if (str[m] == NULL) continue;
+    int ivar = input->variable->find(str[m]);
+    if (ivar >= 0 && input->variable->atomstyle(ivar)) return 1;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   add scale * E (force/charge units) to ef for owned atoms in group
+   called by polarization pair styles before solving for induced dipoles
+------------------------------------------------------------------------- */
+
+void FixEfield::add_field(double **ef, double scale)
+{
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  compute_field();
+
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      if (xstyle == ATOM) ef[i][0] += scale * qe2f*efield[i][0];
+      else ef[i][0] += scale * ex;
+      if (ystyle == ATOM) ef[i][1] += scale * qe2f*efield[i][1];
+      else ef[i][1] += scale * ey;
+      if (zstyle == ATOM) ef[i][2] += scale * qe2f*efield[i][2];
+      else ef[i][2] += scale * ez;
+    }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixEfield::post_force_respa(int vflag, int ilevel, int iloop)
@@ -38,6 +38,9 @@ class FixEfield : public Fix {
   double memory_usage();
   double compute_scalar();
   double compute_vector(int);
+  void compute_field();
+  void add_field(double **, double);
+  int atom_field();
 
  private:
   double ex,ey,ez;
@@ -50,6 +53,7 @@ class FixEfield : public Fix {
 
   int maxatom;
   double **efield;
+  bigint field_step;
 
   int force_flag;
   double fsum[4],fsum_all[4];
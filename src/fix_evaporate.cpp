@@ -330,19 +330,12 @@ void FixEvaporate::pre_exchange()
 
   // delete my marked atoms
   // loop in reverse order to avoid copying marked atoms
+  // delete_owned() keeps the global map valid if it exists
 
-  AtomVec *avec = atom->avec;
-
-  for (i = nlocal-1; i >= 0; i--) {
-    if (mark[i]) {
-      avec->copy(atom->nlocal-1,i,1);
-      atom->nlocal--;
-    }
-  }
+  for (i = nlocal-1; i >= 0; i--)
+    if (mark[i]) atom->delete_owned(i);
 
   // reset global natoms and bonds, angles, etc
-  // if global map exists, reset it now instead of waiting for comm
-  // since deleting atoms messes up ghosts
 
   atom->natoms -= ndel;
   if (molflag) {
@@ -354,12 +347,6 @@ void FixEvaporate::pre_exchange()
     atom->nimpropers -= all[3];
   }
 
-  if (ndel && atom->map_style) {
-    atom->nghost = 0;
-    atom->map_init();
-    atom->map_set();
-  }
-
   // statistics
 
   ndeleted += ndel;
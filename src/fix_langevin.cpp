@@ -34,6 +34,7 @@
 #include "input.h"
 #include "variable.h"
 #include "random_mars.h"
+#include "random_philox.h"
 #include "memory.h"
 #include "error.h"
 #include "group.h"
@@ -43,6 +44,8 @@ using namespace FixConst;
 
 enum{NOBIAS,BIAS};
 enum{CONSTANT,EQUAL,ATOM};
+enum{MARS,PHILOX};
+enum{RANFORCE,RANOMEGA,RANANGMOM};
 
 #define SINERTIA 0.4          // moment of inertia prefactor for sphere
 #define EINERTIA 0.2          // moment of inertia prefactor for ellipsoid
@@ -72,7 +75,7 @@ FixLangevin::FixLangevin(LAMMPS *lmp, int narg, char **arg) :
 
   t_stop = atof(arg[4]);
   t_period = atof(arg[5]);
-  int seed = atoi(arg[6]);
+  seed = atoi(arg[6]);
 
   if (t_period <= 0.0) error->all(FLERR,"Fix langevin period must be > 0.0");
   if (seed <= 0) error->all(FLERR,"Illegal fix langevin command");
@@ -80,6 +83,7 @@ FixLangevin::FixLangevin(LAMMPS *lmp, int narg, char **arg) :
   // initialize Marsaglia RNG with processor-unique seed
 
   random = new RanMars(lmp,seed + comm->me);
+  philox = NULL;
 
   // allocate per-type arrays for force prefactors
 
@@ -93,6 +97,7 @@ FixLangevin::FixLangevin(LAMMPS *lmp, int narg, char **arg) :
   oflag = aflag = 0;
   tally = 0;
   zeroflag = 0;
+  rngstyle = MARS;
 
   int iarg = 7;
   while (iarg < narg) {
@@ -128,9 +133,25 @@ FixLangevin::FixLangevin(LAMMPS *lmp, int narg, char **arg) :
       else if (strcmp(arg[iarg+1],"yes") == 0) zeroflag = 1;
       else error->all(FLERR,"Illegal fix langevin command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"rng") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix langevin command");
+      if (strcmp(arg[iarg+1],"mars") == 0) rngstyle = MARS;
+      else if (strcmp(arg[iarg+1],"philox") == 0) rngstyle = PHILOX;
+      else error->all(FLERR,"Illegal fix langevin command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal fix langevin command");
   }
 
+  // counter-based RNG keyed by seed, atom ID, and timestep
+  // same seed on all procs, so random forces are independent of
+  //   the number of procs and the order atoms are stored in
+
+  if (rngstyle == PHILOX) {
+    if (atom->tag_enable == 0)
+      error->all(FLERR,"Fix langevin rng philox requires atom IDs");
+    philox = new RanPhilox(seed);
+  }
+
   // set temperature = NULL, user can override via fix_modify if wants bias
 
   id_temp = NULL;
@@ -150,6 +171,7 @@ FixLangevin::FixLangevin(LAMMPS *lmp, int narg, char **arg) :
 FixLangevin::~FixLangevin()
 {
   delete random;
+  delete philox;
   delete [] tstr;
   delete [] gfactor1;
   delete [] gfactor2;
@@ -280,38 +302,7 @@ void FixLangevin::post_force_no_tally()
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
-  double delta = update->ntimestep - update->beginstep;
-  if (delta != 0.0) delta /= update->endstep - update->beginstep;
-
-  // set current t_target and t_sqrt
-  // if variable temp, evaluate variable, wrap with clear/add
-  // reallocate tforce array if necessary
-
-  if (tstyle == CONSTANT) {
-    t_target = t_start + delta * (t_stop-t_start);
-    tsqrt = sqrt(t_target);
-  } else {
-    modify->clearstep_compute();
-    if (tstyle == EQUAL) {
-      t_target = input->variable->compute_equal(tvar);
-      if (t_target < 0.0)
-        error->one(FLERR,"Fix langevin variable returned negative temperature");
-      tsqrt = sqrt(t_target);
-    } else {
-      if (nlocal > maxatom2) {
-        maxatom2 = atom->nmax;
-        memory->destroy(tforce);
-        memory->create(tforce,maxatom2,"langevin:tforce");
-      }
-      input->variable->compute_atom(tvar,igroup,tforce,1,0);
-      for (int i = 0; i < nlocal; i++)
-        if (mask[i] & groupbit)
-            if (tforce[i] < 0.0)
-              error->one(FLERR,
-                         "Fix langevin variable returned negative temperature");
-    }
-    modify->addstep_compute(update->ntimestep + 1);
-  }
+  compute_target();
 
   // apply damping and thermostat to atoms in group
   // for BIAS:
@@ -323,7 +314,7 @@ void FixLangevin::post_force_no_tally()
   //   sum random force over all atoms in group
   //   subtract sum/count from each atom in group
 
-  double fran[3],fsum[3],fsumall[3];
+  double fran[3],fsum[3],fsumall[3],ran[3];
   fsum[0] = fsum[1] = fsum[2] = 0.0;
   bigint count;
 
@@ -347,9 +338,10 @@ void FixLangevin::post_force_no_tally()
           gamma2 = sqrt(rmass[i]) * sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
           gamma1 *= 1.0/ratio[type[i]];
           gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
-          fran[0] = gamma2*(random->uniform()-0.5);
-          fran[1] = gamma2*(random->uniform()-0.5);
-          fran[2] = gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          fran[0] = gamma2*(ran[0]-0.5);
+          fran[1] = gamma2*(ran[1]-0.5);
+          fran[2] = gamma2*(ran[2]-0.5);
           f[i][0] += gamma1*v[i][0] + fran[0];
           f[i][1] += gamma1*v[i][1] + fran[1];
           f[i][2] += gamma1*v[i][2] + fran[2];
@@ -369,9 +361,10 @@ void FixLangevin::post_force_no_tally()
           gamma1 *= 1.0/ratio[type[i]];
           gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
           temperature->remove_bias(i,v[i]);
-          fran[0] = gamma2*(random->uniform()-0.5);
-          fran[1] = gamma2*(random->uniform()-0.5);
-          fran[2] = gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          fran[0] = gamma2*(ran[0]-0.5);
+          fran[1] = gamma2*(ran[1]-0.5);
+          fran[2] = gamma2*(ran[2]-0.5);
           if (v[i][0] != 0.0)
             f[i][0] += gamma1*v[i][0] + fran[0];
           if (v[i][1] != 0.0)
@@ -394,9 +387,10 @@ void FixLangevin::post_force_no_tally()
           if (tstyle == ATOM) tsqrt = sqrt(tforce[i]);
           gamma1 = gfactor1[type[i]];
           gamma2 = gfactor2[type[i]] * tsqrt;
-          fran[0] = gamma2*(random->uniform()-0.5);
-          fran[1] = gamma2*(random->uniform()-0.5);
-          fran[2] = gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          fran[0] = gamma2*(ran[0]-0.5);
+          fran[1] = gamma2*(ran[1]-0.5);
+          fran[2] = gamma2*(ran[2]-0.5);
           f[i][0] += gamma1*v[i][0] + fran[0];
           f[i][1] += gamma1*v[i][1] + fran[1];
           f[i][2] += gamma1*v[i][2] + fran[2];
@@ -414,9 +408,10 @@ void FixLangevin::post_force_no_tally()
           gamma1 = gfactor1[type[i]];
           gamma2 = gfactor2[type[i]] * tsqrt;
           temperature->remove_bias(i,v[i]);
-          fran[0] = gamma2*(random->uniform()-0.5);
-          fran[1] = gamma2*(random->uniform()-0.5);
-          fran[2] = gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          fran[0] = gamma2*(ran[0]-0.5);
+          fran[1] = gamma2*(ran[1]-0.5);
+          fran[2] = gamma2*(ran[2]-0.5);
           if (v[i][0] != 0.0)
             f[i][0] += gamma1*v[i][0] + fran[0];
           if (v[i][1] != 0.0)
@@ -459,6 +454,7 @@ void FixLangevin::post_force_no_tally()
 void FixLangevin::post_force_tally()
 {
   double gamma1,gamma2;
+  double ran[3];
 
   // reallocate flangevin if necessary
 
@@ -475,38 +471,7 @@ void FixLangevin::post_force_tally()
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
-  double delta = update->ntimestep - update->beginstep;
-  if (delta != 0.0) delta /= update->endstep - update->beginstep;
-
-  // set current t_target and t_sqrt
-  // if variable temp, evaluate variable, wrap with clear/add
-  // reallocate tforce array if necessary
-
-  if (tstyle == CONSTANT) {
-    t_target = t_start + delta * (t_stop-t_start);
-    tsqrt = sqrt(t_target);
-  } else {
-    modify->clearstep_compute();
-    if (tstyle == EQUAL) {
-      t_target = input->variable->compute_equal(tvar);
-      if (t_target < 0.0)
-        error->one(FLERR,"Fix langevin variable returned negative temperature");
-      tsqrt = sqrt(t_target);
-    } else {
-      if (nlocal > maxatom2) {
-        maxatom2 = atom->nmax;
-        memory->destroy(tforce);
-        memory->create(tforce,maxatom2,"langevin:tforce");
-      }
-      input->variable->compute_atom(tvar,igroup,tforce,1,0);
-      for (int i = 0; i < nlocal; i++)
-        if (mask[i] & groupbit)
-            if (tforce[i] < 0.0)
-              error->one(FLERR,
-                         "Fix langevin variable returned negative temperature");
-    }
-    modify->addstep_compute(update->ntimestep + 1);
-  }
+  compute_target();
 
   // apply damping and thermostat to appropriate atoms
   // for BIAS:
@@ -529,9 +494,10 @@ void FixLangevin::post_force_tally()
           gamma2 = sqrt(rmass[i]) * sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
           gamma1 *= 1.0/ratio[type[i]];
           gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
-          flangevin[i][0] = gamma1*v[i][0] + gamma2*(random->uniform()-0.5);
-          flangevin[i][1] = gamma1*v[i][1] + gamma2*(random->uniform()-0.5);
-          flangevin[i][2] = gamma1*v[i][2] + gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          flangevin[i][0] = gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+          flangevin[i][1] = gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+          flangevin[i][2] = gamma1*v[i][2] + gamma2*(ran[2]-0.5);
           f[i][0] += flangevin[i][0];
           f[i][1] += flangevin[i][1];
           f[i][2] += flangevin[i][2];
@@ -548,9 +514,10 @@ void FixLangevin::post_force_tally()
           gamma1 *= 1.0/ratio[type[i]];
           gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
           temperature->remove_bias(i,v[i]);
-          flangevin[i][0] = gamma1*v[i][0] + gamma2*(random->uniform()-0.5);
-          flangevin[i][1] = gamma1*v[i][1] + gamma2*(random->uniform()-0.5);
-          flangevin[i][2] = gamma1*v[i][2] + gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          flangevin[i][0] = gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+          flangevin[i][1] = gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+          flangevin[i][2] = gamma1*v[i][2] + gamma2*(ran[2]-0.5);
           if (v[i][0] != 0.0) f[i][0] += flangevin[i][0];
           else flangevin[i][0] = 0;
           if (v[i][1] != 0.0) f[i][1] += flangevin[i][1];
@@ -569,9 +536,10 @@ void FixLangevin::post_force_tally()
           if (tstyle == ATOM) tsqrt = sqrt(tforce[i]);
           gamma1 = gfactor1[type[i]];
           gamma2 = gfactor2[type[i]] * tsqrt;
-          flangevin[i][0] = gamma1*v[i][0] + gamma2*(random->uniform()-0.5);
-          flangevin[i][1] = gamma1*v[i][1] + gamma2*(random->uniform()-0.5);
-          flangevin[i][2] = gamma1*v[i][2] + gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          flangevin[i][0] = gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+          flangevin[i][1] = gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+          flangevin[i][2] = gamma1*v[i][2] + gamma2*(ran[2]-0.5);
           f[i][0] += flangevin[i][0];
           f[i][1] += flangevin[i][1];
           f[i][2] += flangevin[i][2];
@@ -586,9 +554,10 @@ void FixLangevin::post_force_tally()
           gamma1 = gfactor1[type[i]];
           gamma2 = gfactor2[type[i]] * tsqrt;
           temperature->remove_bias(i,v[i]);
-          flangevin[i][0] = gamma1*v[i][0] + gamma2*(random->uniform()-0.5);
-          flangevin[i][1] = gamma1*v[i][1] + gamma2*(random->uniform()-0.5);
-          flangevin[i][2] = gamma1*v[i][2] + gamma2*(random->uniform()-0.5);
+          uniform3(i,RANFORCE,ran);
+          flangevin[i][0] = gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+          flangevin[i][1] = gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+          flangevin[i][2] = gamma1*v[i][2] + gamma2*(ran[2]-0.5);
           if (v[i][0] != 0.0) f[i][0] += flangevin[i][0];
           else flangevin[i][0] = 0.0;
           if (v[i][1] != 0.0) f[i][1] += flangevin[i][1];
@@ -631,7 +600,7 @@ void FixLangevin::omega_thermostat()
   // rescale gamma1/gamma2 by 10/3 & sqrt(10/3) for rotational thermostatting
 
   double tendivthree = 10.0/3.0;
-  double tran[3];
+  double tran[3],ran[3];
   double inertiaone;
   
   for (int i = 0; i < nlocal; i++) {
@@ -642,9 +611,10 @@ void FixLangevin::omega_thermostat()
       gamma2 = sqrt(inertiaone) * sqrt(80.0*boltz/t_period/dt/mvv2e) / ftm2v;
       gamma1 *= 1.0/ratio[type[i]];
       gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
-      tran[0] = gamma2*(random->uniform()-0.5);
-      tran[1] = gamma2*(random->uniform()-0.5);
-      tran[2] = gamma2*(random->uniform()-0.5);
+      uniform3(i,RANOMEGA,ran);
+      tran[0] = gamma2*(ran[0]-0.5);
+      tran[1] = gamma2*(ran[1]-0.5);
+      tran[2] = gamma2*(ran[2]-0.5);
       torque[i][0] += gamma1*omega[i][0] + tran[0];
       torque[i][1] += gamma1*omega[i][1] + tran[1];
       torque[i][2] += gamma1*omega[i][2] + tran[2];
@@ -677,7 +647,7 @@ void FixLangevin::angmom_thermostat()
   // rescale gamma1/gamma2 by 10/3 & sqrt(10/3) for rotational thermostatting
 
   double tendivthree = 10.0/3.0;
-  double inertia[3],omega[3],tran[3];
+  double inertia[3],omega[3],tran[3],ran[3];
   double *shape,*quat;
 
   for (int i = 0; i < nlocal; i++) {
@@ -694,9 +664,10 @@ void FixLangevin::angmom_thermostat()
       gamma2 = sqrt(80.0*boltz/t_period/dt/mvv2e) / ftm2v;
       gamma1 *= 1.0/ratio[type[i]];
       gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
-      tran[0] = sqrt(inertia[0])*gamma2*(random->uniform()-0.5);
-      tran[1] = sqrt(inertia[1])*gamma2*(random->uniform()-0.5);
-      tran[2] = sqrt(inertia[2])*gamma2*(random->uniform()-0.5);
+      uniform3(i,RANANGMOM,ran);
+      tran[0] = sqrt(inertia[0])*gamma2*(ran[0]-0.5);
+      tran[1] = sqrt(inertia[1])*gamma2*(ran[1]-0.5);
+      tran[2] = sqrt(inertia[2])*gamma2*(ran[2]-0.5);
       torque[i][0] += inertia[0]*gamma1*omega[0] + tran[0];
       torque[i][1] += inertia[1]*gamma1*omega[1] + tran[1];
       torque[i][2] += inertia[2]*gamma1*omega[2] + tran[2];
@@ -704,6 +675,67 @@ void FixLangevin::angmom_thermostat()
   }
 }
 
+/* ----------------------------------------------------------------------
+   set current t_target and t_sqrt
+   if variable temp, evaluate variable, wrap with clear/add
+   reallocate tforce array if necessary
+------------------------------------------------------------------------- */
+
+void FixLangevin::compute_target()
+{
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  double delta = update->ntimestep - update->beginstep;
+  if (delta != 0.0) delta /= update->endstep - update->beginstep;
+
+  if (tstyle == CONSTANT) {
+    t_target = t_start + delta * (t_stop-t_start);
+    tsqrt = sqrt(t_target);
+  } else {
+    modify->clearstep_compute();
+    if (tstyle == EQUAL) {
+      t_target = input->variable->compute_equal(tvar);
+      if (t_target < 0.0)
+        error->one(FLERR,"Fix langevin variable returned negative temperature");
+      tsqrt = sqrt(t_target);
+    } else {
+      if (nlocal > maxatom2) {
+        maxatom2 = atom->nmax;
+        memory->destroy(tforce);
+        memory->create(tforce,maxatom2,"langevin:tforce");
+      }
+      input->variable->compute_atom(tvar,igroup,tforce,1,0);
+      for (int i = 0; i < nlocal; i++)
+        if (mask[i] & groupbit)
+            if (tforce[i] < 0.0)
+              error->one(FLERR,
+                         "Fix langevin variable returned negative temperature");
+    }
+    modify->addstep_compute(update->ntimestep + 1);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   three uniform RNs for the random force or torque on atom i
+   MARS = next values of this proc's sequential stream
+   PHILOX = function of atom ID, timestep, and which dof is thermostatted
+------------------------------------------------------------------------- */
+
+void FixLangevin::uniform3(int i, int which, double *ran)
+{
+  if (rngstyle == MARS) {
+    ran[0] = random->uniform();
+    ran[1] = random->uniform();
+    ran[2] = random->uniform();
+  } else {
+    philox->reset(atom->tag[i],which,update->ntimestep);
+    ran[0] = philox->uniform();
+    ran[1] = philox->uniform();
+    ran[2] = philox->uniform();
+  }
+}
+
 /* ----------------------------------------------------------------------
    tally energy transfer to thermal reservoir
 ------------------------------------------------------------------------- */
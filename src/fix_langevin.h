@@ -42,7 +42,7 @@ class FixLangevin : public Fix {
   virtual void *extract(const char *, int &);
 
  protected:
-  int which,tally,zeroflag,oflag,aflag;
+  int which,tally,zeroflag,oflag,aflag,rngstyle,seed;
   double t_start,t_stop,t_period,t_target;
   double *gfactor1,*gfactor2,*ratio;
   double energy,energy_onestep;
@@ -61,11 +61,14 @@ class FixLangevin : public Fix {
 
   int nlevels_respa;
   class RanMars *random;
+  class RanPhilox *philox;
 
   virtual void post_force_no_tally();
   virtual void post_force_tally();
   void omega_thermostat();
   void angmom_thermostat();
+  void compute_target();
+  void uniform3(int, int, double *);
 };
 
 }
@@ -81,6 +84,11 @@ Self-explanatory.  Check the input script syntax and compare to the
 documentation for the command.  You can use -echo screen as a
 command-line option when running LAMMPS to see the offending line.
 
+E: Fix langevin rng philox requires atom IDs
+
+The counter-based random number generator is keyed by atom ID, so
+atoms must have IDs.
+
 E: Fix langevin period must be > 0.0
 
 The time window for temperature relaxation must be > 0
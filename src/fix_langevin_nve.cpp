@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "string.h"
+#include "fix_langevin_nve.h"
+#include "atom.h"
+#include "force.h"
+#include "update.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{NOBIAS,BIAS};
+enum{CONSTANT,EQUAL,ATOM};
+enum{RANFORCE,RANOMEGA,RANANGMOM};
+
+/* ---------------------------------------------------------------------- */
+
+FixLangevinNVE::FixLangevinNVE(LAMMPS *lmp, int narg, char **arg) :
+  FixLangevin(lmp, narg, arg)
+{
+  if (tally || zeroflag || oflag || aflag)
+    error->all(FLERR,
+               "Fix langevin/nve does not support tally, zero, omega, or angmom");
+
+  time_integrate = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixLangevinNVE::setmask()
+{
+  int mask = 0;
+  mask |= INITIAL_INTEGRATE;
+  mask |= FINAL_INTEGRATE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLangevinNVE::init()
+{
+  FixLangevin::init();
+
+  if (which == BIAS)
+    error->all(FLERR,"Fix langevin/nve does not support a temperature bias");
+  if (strstr(update->integrate_style,"respa"))
+    error->all(FLERR,"Fix langevin/nve does not support run_style respa");
+
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+}
+
+/* ----------------------------------------------------------------------
+   same as fix nve, f already includes the Langevin force added
+   by setup() or by the previous final_integrate()
+------------------------------------------------------------------------- */
+
+void FixLangevinNVE::initial_integrate(int vflag)
+{
+  double dtfm;
+
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+
+  if (rmass) {
+    for (int i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        dtfm = dtf / rmass[i];
+        v[i][0] += dtfm * f[i][0];
+        v[i][1] += dtfm * f[i][1];
+        v[i][2] += dtfm * f[i][2];
+        x[i][0] += dtv * v[i][0];
+        x[i][1] += dtv * v[i][1];
+        x[i][2] += dtv * v[i][2];
+      }
+
+  } else {
+    for (int i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        dtfm = dtf / mass[type[i]];
+        v[i][0] += dtfm * f[i][0];
+        v[i][1] += dtfm * f[i][1];
+        v[i][2] += dtfm * f[i][2];
+        x[i][0] += dtv * v[i][0];
+        x[i][1] += dtv * v[i][1];
+        x[i][2] += dtv * v[i][2];
+      }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   add damping and random force to f, then 2nd half-step update of v,
+   in a single pass over the atoms
+   equivalent to fix langevin + fix nve when no other fix modifies f
+     after fix langevin
+------------------------------------------------------------------------- */
+
+void FixLangevinNVE::final_integrate()
+{
+  double gamma1,gamma2,dtfm;
+  double ran[3];
+
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+
+  compute_target();
+
+  double boltz = force->boltz;
+  double dt = update->dt;
+  double mvv2e = force->mvv2e;
+  double ftm2v = force->ftm2v;
+
+  if (rmass) {
+    for (int i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        if (tstyle == ATOM) tsqrt = sqrt(tforce[i]);
+        gamma1 = -rmass[i] / t_period / ftm2v;
+        gamma2 = sqrt(rmass[i]) * sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
+        gamma1 *= 1.0/ratio[type[i]];
+        gamma2 *= 1.0/sqrt(ratio[type[i]]) * tsqrt;
+        uniform3(i,RANFORCE,ran);
+        f[i][0] += gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+        f[i][1] += gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+        f[i][2] += gamma1*v[i][2] + gamma2*(ran[2]-0.5);
+        dtfm = dtf / rmass[i];
+        v[i][0] += dtfm * f[i][0];
+        v[i][1] += dtfm * f[i][1];
+        v[i][2] += dtfm * f[i][2];
+      }
+
+  } else {
+    for (int i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) {
+        if (tstyle == ATOM) tsqrt = sqrt(tforce[i]);
+        gamma1 = gfactor1[type[i]];
+        gamma2 = gfactor2[type[i]] * tsqrt;
+        uniform3(i,RANFORCE,ran);
+        f[i][0] += gamma1*v[i][0] + gamma2*(ran[0]-0.5);
+        f[i][1] += gamma1*v[i][1] + gamma2*(ran[1]-0.5);
+        f[i][2] += gamma1*v[i][2] + gamma2*(ran[2]-0.5);
+        dtfm = dtf / mass[type[i]];
+        v[i][0] += dtfm * f[i][0];
+        v[i][1] += dtfm * f[i][1];
+        v[i][2] += dtfm * f[i][2];
+      }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLangevinNVE::reset_dt()
+{
+  FixLangevin::reset_dt();
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+}
@@ -0,0 +1,68 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(langevin/nve,FixLangevinNVE)
+
+#else
+
+#ifndef LMP_FIX_LANGEVIN_NVE_H
+#define LMP_FIX_LANGEVIN_NVE_H
+
+#include "fix_langevin.h"
+
+namespace LAMMPS_NS {
+
+class FixLangevinNVE : public FixLangevin {
+ public:
+  FixLangevinNVE(class LAMMPS *, int, char **);
+  int setmask();
+  void init();
+  virtual void initial_integrate(int);
+  virtual void final_integrate();
+  void reset_dt();
+
+ protected:
+  double dtv,dtf;
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix langevin/nve does not support tally, zero, omega, or angmom
+
+These options need a separate pass over the atoms, which is what the
+fused fix avoids.  Use fix langevin with fix nve instead.
+
+E: Fix langevin/nve does not support a temperature bias
+
+Removing a velocity bias requires the temperature compute to be
+invoked between the force and velocity updates.  Use fix langevin
+with fix nve instead.
+
+E: Fix langevin/nve does not support run_style respa
+
+Self-explanatory.
+
+*/
@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "string.h"
+#include "fix_msd_window.h"
+#include "compute_msd_window.h"
+#include "atom.h"
+#include "update.h"
+#include "modify.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+/* ----------------------------------------------------------------------
+   internal fix created by compute msd/window
+   stores per-atom position history so it migrates with atoms
+   triggers the compute to sample positions every Nevery steps
+   args = ID group MSD_WINDOW compute-ID Nevery Nvalues
+------------------------------------------------------------------------- */
+
+FixMSDWindow::FixMSDWindow(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (narg != 6) error->all(FLERR,"Illegal fix MSD_WINDOW command");
+
+  int n = strlen(arg[3]) + 1;
+  id_compute = new char[n];
+  strcpy(id_compute,arg[3]);
+
+  nevery = atoi(arg[4]);
+  nvalues = atoi(arg[5]);
+  if (nevery <= 0 || nvalues < 0)
+    error->all(FLERR,"Illegal fix MSD_WINDOW command");
+
+  compute = NULL;
+  laststep = -1;
+
+  // perform initial allocation of atom-based array
+  // register with Atom class
+  // history is not stored in restart files, so no restart callback
+
+  hist = NULL;
+  if (nvalues) {
+    grow_arrays(atom->nmax);
+    atom->add_callback(0);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMSDWindow::~FixMSDWindow()
+{
+  // unregister callbacks to this fix from Atom class
+
+  if (nvalues) atom->delete_callback(id,0);
+
+  delete [] id_compute;
+  memory->destroy(hist);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMSDWindow::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSDWindow::init()
+{
+  int icompute = modify->find_compute(id_compute);
+  if (icompute < 0)
+    error->all(FLERR,"Could not find fix MSD_WINDOW compute ID");
+  compute = (ComputeMSDWindow *) modify->compute[icompute];
+}
+
+/* ----------------------------------------------------------------------
+   also sample at start of run, so the initial state is a time origin
+   skip if already sampled on this step at the end of a previous run
+------------------------------------------------------------------------- */
+
+void FixMSDWindow::setup(int vflag)
+{
+  if (update->ntimestep % nevery == 0) end_of_step();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMSDWindow::end_of_step()
+{
+  if (update->ntimestep == laststep) return;
+  laststep = update->ntimestep;
+  compute->sample();
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local atom-based array
+------------------------------------------------------------------------- */
+
+double FixMSDWindow::memory_usage()
+{
+  double bytes = atom->nmax*nvalues * sizeof(double);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   allocate atom-based array
+------------------------------------------------------------------------- */
+
+void FixMSDWindow::grow_arrays(int nmax)
+{
+  memory->grow(hist,nmax,nvalues,"msd/window:hist");
+}
+
+/* ----------------------------------------------------------------------
+   copy values within local atom-based array
+------------------------------------------------------------------------- */
+
+void FixMSDWindow::copy_arrays(int i, int j)
+{
+  memcpy(hist[j],hist[i],nvalues*sizeof(double));
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based array for exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixMSDWindow::pack_exchange(int i, double *buf)
+{
+  for (int m = 0; m < nvalues; m++) buf[m] = hist[i][m];
+  return nvalues;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based array from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixMSDWindow::unpack_exchange(int nlocal, double *buf)
+{
+  for (int m = 0; m < nvalues; m++) hist[nlocal][m] = buf[m];
+  return nvalues;
+}
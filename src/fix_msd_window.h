@@ -0,0 +1,68 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(MSD_WINDOW,FixMSDWindow)
+
+#else
+
+#ifndef LMP_FIX_MSD_WINDOW_H
+#define LMP_FIX_MSD_WINDOW_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMSDWindow : public Fix {
+ public:
+  double **hist;           // per-atom positions at past time origins
+
+  FixMSDWindow(class LAMMPS *, int, char **);
+  ~FixMSDWindow();
+  int setmask();
+  void init();
+  void setup(int);
+  void end_of_step();
+
+  double memory_usage();
+  void grow_arrays(int);
+  void copy_arrays(int, int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+
+ private:
+  int nvalues;
+  bigint laststep;
+  char *id_compute;
+  class ComputeMSDWindow *compute;
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Could not find fix MSD_WINDOW compute ID
+
+The compute msd/window which created this fix has been deleted.
+
+*/
@@ -839,11 +839,16 @@ void FixNH::final_integrate()
 
   // compute new T,P
   // compute appropriately coupled elements of mvv_current
+  // KE tensor must be recomputed, it is still flagged as current
+  //   from initial_integrate() on this timestep
 
   t_current = temperature->compute_scalar();
   if (pstat_flag) {
     if (pstyle == ISO) pressure->compute_scalar();
-    else pressure->compute_vector();
+    else {
+      temperature->compute_vector();
+      pressure->compute_vector();
+    }
     couple();
     pressure->addstep(update->ntimestep+1);
   }
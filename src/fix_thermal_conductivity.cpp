@@ -25,6 +25,7 @@
 #include "force.h"
 #include "domain.h"
 #include "modify.h"
+#include "merge_candidates.h"
 #include "error.h"
 
 using namespace LAMMPS_NS;
@@ -32,6 +33,10 @@ using namespace FixConst;
 
 #define BIG 1.0e10
 
+// candidate = value,proc,index in proc's list,vx,vy,vz,mass
+
+#define NCAND 7
+
 /* ---------------------------------------------------------------------- */
 
 FixThermalConductivity::FixThermalConductivity(LAMMPS *lmp,
@@ -82,6 +87,12 @@ FixThermalConductivity::FixThermalConductivity(LAMMPS *lmp,
   ke_lo = new double[nswap+1];
   ke_hi = new double[nswap+1];
 
+  cand_mine = new double[2*nswap*NCAND];
+  cand_all = new double[2*nswap*NCAND];
+  MPI_Type_contiguous(2*nswap*NCAND,MPI_DOUBLE,&cand_type);
+  MPI_Type_commit(&cand_type);
+  MPI_Op_create(MergeCandidates::op<NCAND>,1,&merge_op);
+
   e_exchange = 0.0;
 }
 
@@ -93,6 +104,10 @@ FixThermalConductivity::~FixThermalConductivity()
   delete [] index_hi;
   delete [] ke_lo;
   delete [] ke_hi;
+  delete [] cand_mine;
+  delete [] cand_all;
+  MPI_Op_free(&merge_op);
+  MPI_Type_free(&cand_type);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -142,13 +157,8 @@ void FixThermalConductivity::init()
 
 void FixThermalConductivity::end_of_step()
 {
-  int i,j,m,insert;
+  int i,m,insert;
   double coord,ke;
-  MPI_Status status;
-  struct {
-    double value;
-    int proc;
-  } mine[2],all[2];
 
   // if box changes, recompute bounds of 2 slabs in edim
 
@@ -222,104 +232,85 @@ void FixThermalConductivity::end_of_step()
       }
     }
 
-  // loop over nswap pairs
-  // pair 2 global atoms at beginning of sorted lo/hi slab lists via Allreduce
-  // BIG values are for procs with no atom to contribute
-  // use negative of hottest KE since is doing a MINLOC
-  // MINLOC also communicates which procs own them
+  // pack up to nswap candidates from each of the 2 sorted lists,
+  //   with velocity and mass so no further comm is needed for the swaps
+  // BIG values are for procs with fewer than nswap atoms to contribute
+  // use negative of hottest KE so both lists are sorted by smallest value
+  // a single reduction merges the lists of all procs,
+  //   so every proc knows the nswap global pairs and which procs own them
+
+  double *c;
+
+  for (m = 0; m < nswap; m++) {
+    c = &cand_mine[m*NCAND];
+    if (m < nlo) {
+      i = index_lo[m];
+      c[0] = -ke_lo[m];
+      c[3] = v[i][0];
+      c[4] = v[i][1];
+      c[5] = v[i][2];
+      if (rmass) c[6] = rmass[i];
+      else c[6] = mass[type[i]];
+    } else c[0] = BIG;
+    c[1] = me;
+    c[2] = m;
+
+    c = &cand_mine[(nswap+m)*NCAND];
+    if (m < nhi) {
+      i = index_hi[m];
+      c[0] = ke_hi[m];
+      c[3] = v[i][0];
+      c[4] = v[i][1];
+      c[5] = v[i][2];
+      if (rmass) c[6] = rmass[i];
+      else c[6] = mass[type[i]];
+    } else c[0] = BIG;
+    c[1] = me;
+    c[2] = m;
+  }
+
+  MPI_Allreduce(cand_mine,cand_all,1,cand_type,merge_op,world);
+
+  // loop over nswap pairs of hottest lo and coldest hi atoms
   // exchange kinetic energy between the 2 particles
-  // if I own both particles just swap, else point2point comm of velocities
+  // owning procs update their atom, all procs tally the same energy
 
-  double sbuf[4],rbuf[4],vcm[3];
+  double *clo,*chi,vcm[3];
   double eswap = 0.0;
 
-  mine[0].proc = mine[1].proc = me;
-  int ilo = 0;
-  int ihi = 0;
-
   for (m = 0; m < nswap; m++) {
-    if (ilo < nlo) mine[0].value = -ke_lo[ilo];
-    else mine[0].value = BIG;
-    if (ihi < nhi) mine[1].value = ke_hi[ihi];
-    else mine[1].value = BIG;
-
-    MPI_Allreduce(mine,all,2,MPI_DOUBLE_INT,MPI_MINLOC,world);
-    if (all[0].value == BIG || all[1].value == BIG) continue;
-
-    if (me == all[0].proc && me == all[1].proc) {
-      i = index_lo[ilo++];
-      j = index_hi[ihi++];
-      sbuf[0] = v[j][0];
-      sbuf[1] = v[j][1];
-      sbuf[2] = v[j][2];
-      if (rmass) sbuf[3] = rmass[j];
-      else sbuf[3] = mass[type[j]];
-      rbuf[0] = v[i][0];
-      rbuf[1] = v[i][1];
-      rbuf[2] = v[i][2];
-      if (rmass) rbuf[3] = rmass[i];
-      else rbuf[3] = mass[type[i]];
-      vcm[0] = (sbuf[3]*sbuf[0] + rbuf[3]*rbuf[0]) / (sbuf[3] + rbuf[3]);
-      vcm[1] = (sbuf[3]*sbuf[1] + rbuf[3]*rbuf[1]) / (sbuf[3] + rbuf[3]);
-      vcm[2] = (sbuf[3]*sbuf[2] + rbuf[3]*rbuf[2]) / (sbuf[3] + rbuf[3]);
-      v[j][0] = 2.0 * vcm[0] - sbuf[0];
-      v[j][1] = 2.0 * vcm[1] - sbuf[1];
-      v[j][2] = 2.0 * vcm[2] - sbuf[2];
-      eswap += sbuf[3] * (vcm[0] * (vcm[0] - sbuf[0]) +
-                          vcm[1] * (vcm[1] - sbuf[1]) +
-                          vcm[2] * (vcm[2] - sbuf[2]));
-      v[i][0] = 2.0 * vcm[0] - rbuf[0];
-      v[i][1] = 2.0 * vcm[1] - rbuf[1];
-      v[i][2] = 2.0 * vcm[2] - rbuf[2];
-      eswap -= rbuf[3] * (vcm[0] * (vcm[0] - rbuf[0]) +
-                          vcm[1] * (vcm[1] - rbuf[1]) +
-                          vcm[2] * (vcm[2] - rbuf[2]));
-
-    } else if (me == all[0].proc) {
-      j = index_lo[ilo++];
-      sbuf[0] = v[j][0];
-      sbuf[1] = v[j][1];
-      sbuf[2] = v[j][2];
-      if (rmass) sbuf[3] = rmass[j];
-      else sbuf[3] = mass[type[j]];
-      MPI_Sendrecv(sbuf,4,MPI_DOUBLE,all[1].proc,0,
-                   rbuf,4,MPI_DOUBLE,all[1].proc,0,world,&status);
-      vcm[0] = (sbuf[3]*sbuf[0] + rbuf[3]*rbuf[0]) / (sbuf[3] + rbuf[3]);
-      vcm[1] = (sbuf[3]*sbuf[1] + rbuf[3]*rbuf[1]) / (sbuf[3] + rbuf[3]);
-      vcm[2] = (sbuf[3]*sbuf[2] + rbuf[3]*rbuf[2]) / (sbuf[3] + rbuf[3]);
-      v[j][0] = 2.0 * vcm[0] - sbuf[0];
-      v[j][1] = 2.0 * vcm[1] - sbuf[1];
-      v[j][2] = 2.0 * vcm[2] - sbuf[2];
-      eswap -= sbuf[3] * (vcm[0] * (vcm[0] - sbuf[0]) +
-                          vcm[1] * (vcm[1] - sbuf[1]) +
-                          vcm[2] * (vcm[2] - sbuf[2]));
-
-    } else if (me == all[1].proc) {
-      j = index_hi[ihi++];
-      sbuf[0] = v[j][0];
-      sbuf[1] = v[j][1];
-      sbuf[2] = v[j][2];
-      if (rmass) sbuf[3] = rmass[j];
-      else sbuf[3] = mass[type[j]];
-      MPI_Sendrecv(sbuf,4,MPI_DOUBLE,all[0].proc,0,
-                   rbuf,4,MPI_DOUBLE,all[0].proc,0,world,&status);
-      vcm[0] = (sbuf[3]*sbuf[0] + rbuf[3]*rbuf[0]) / (sbuf[3] + rbuf[3]);
-      vcm[1] = (sbuf[3]*sbuf[1] + rbuf[3]*rbuf[1]) / (sbuf[3] + rbuf[3]);
-      vcm[2] = (sbuf[3]*sbuf[2] + rbuf[3]*rbuf[2]) / (sbuf[3] + rbuf[3]);
-      v[j][0] = 2.0 * vcm[0] - sbuf[0];
-      v[j][1] = 2.0 * vcm[1] - sbuf[1];
-      v[j][2] = 2.0 * vcm[2] - sbuf[2];
-      eswap += sbuf[3] * (vcm[0] * (vcm[0] - sbuf[0]) +
-                          vcm[1] * (vcm[1] - sbuf[1]) +
-                          vcm[2] * (vcm[2] - sbuf[2]));
+    clo = &cand_all[m*NCAND];
+    chi = &cand_all[(nswap+m)*NCAND];
+    if (clo[0] == BIG || chi[0] == BIG) break;
+
+    vcm[0] = (chi[6]*chi[3] + clo[6]*clo[3]) / (chi[6] + clo[6]);
+    vcm[1] = (chi[6]*chi[4] + clo[6]*clo[4]) / (chi[6] + clo[6]);
+    vcm[2] = (chi[6]*chi[5] + clo[6]*clo[5]) / (chi[6] + clo[6]);
+
+    if (static_cast<int> (clo[1]) == me) {
+      i = index_lo[static_cast<int> (clo[2])];
+      v[i][0] = 2.0 * vcm[0] - clo[3];
+      v[i][1] = 2.0 * vcm[1] - clo[4];
+      v[i][2] = 2.0 * vcm[2] - clo[5];
+    }
+    if (static_cast<int> (chi[1]) == me) {
+      i = index_hi[static_cast<int> (chi[2])];
+      v[i][0] = 2.0 * vcm[0] - chi[3];
+      v[i][1] = 2.0 * vcm[1] - chi[4];
+      v[i][2] = 2.0 * vcm[2] - chi[5];
     }
+
+    eswap += chi[6] * (vcm[0] * (vcm[0] - chi[3]) +
+                       vcm[1] * (vcm[1] - chi[4]) +
+                       vcm[2] * (vcm[2] - chi[5]));
+    eswap -= clo[6] * (vcm[0] * (vcm[0] - clo[3]) +
+                       vcm[1] * (vcm[1] - clo[4]) +
+                       vcm[2] * (vcm[2] - clo[5]));
   }
 
   // tally energy exchange from all swaps
 
-  double eswap_all;
-  MPI_Allreduce(&eswap,&eswap_all,1,MPI_DOUBLE,MPI_SUM,world);
-  e_exchange += force->mvv2e * eswap_all;
+  e_exchange += force->mvv2e * eswap;
 }
 
 /* ---------------------------------------------------------------------- */
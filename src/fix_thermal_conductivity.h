@@ -44,6 +44,10 @@ class FixThermalConductivity : public Fix {
   int nlo,nhi;
   int *index_lo,*index_hi;
   double *ke_lo,*ke_hi;
+
+  double *cand_mine,*cand_all;      // packed candidates for swap selection
+  MPI_Datatype cand_type;           // all candidates as one element
+  MPI_Op merge_op;                  // reduction that merges candidate lists
 };
 
 }
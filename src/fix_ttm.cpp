@@ -29,6 +29,7 @@
 #include "region.h"
 #include "respa.h"
 #include "comm.h"
+#include "neighbor.h"
 #include "random_mars.h"
 #include "memory.h"
 #include "error.h"
@@ -37,6 +38,10 @@ using namespace LAMMPS_NS;
 using namespace FixConst;
 
 #define MAXLINE 1024
+#define OFFSET 16384
+
+#define MIN(A,B) ((A) < (B) ? (A) : (B))
+#define MAX(A,B) ((A) > (B) ? (A) : (B))
 
 /* ---------------------------------------------------------------------- */
 
@@ -113,23 +118,19 @@ FixTTM::FixTTM(LAMMPS *lmp, int narg, char **arg) :
   gfactor2 = new double[atom->ntypes+1];
 
   // allocate 3d grid variables
+  // each proc stores only the grid nodes it owns within its sub-domain,
+  //   plus ghost nodes reached by its atoms and the diffusion stencil
 
   total_nnodes = nxnodes*nynodes*nznodes;
 
-  memory->create(nsum,nxnodes,nynodes,nznodes,"ttm:nsum");
-  memory->create(nsum_all,nxnodes,nynodes,nznodes,"ttm:nsum_all");
-  memory->create(T_initial_set,nxnodes,nynodes,nznodes,"ttm:T_initial_set");
-  memory->create(sum_vsq,nxnodes,nynodes,nznodes,"ttm:sum_vsq");
-  memory->create(sum_mass_vsq,nxnodes,nynodes,nznodes,"ttm:sum_mass_vsq");
-  memory->create(sum_vsq_all,nxnodes,nynodes,nznodes,"ttm:sum_vsq_all");
-  memory->create(sum_mass_vsq_all,nxnodes,nynodes,nznodes,
-                 "ttm:sum_mass_vsq_all");
-  memory->create(T_electron_old,nxnodes,nynodes,nznodes,"ttm:T_electron_old");
-  memory->create(T_electron,nxnodes,nynodes,nznodes,"ttm:T_electron");
-  memory->create(net_energy_transfer,nxnodes,nynodes,nznodes,
-                 "TTM:net_energy_transfer");
-  memory->create(net_energy_transfer_all,nxnodes,nynodes,nznodes,
-                 "TTM:net_energy_transfer_all");
+  T_electron = T_electron_old = NULL;
+  net_energy_transfer = nsum = sum_mass_vsq = NULL;
+  nswap = 0;
+  swap = NULL;
+  buf1 = buf2 = NULL;
+
+  grid_bounds(lo_in,hi_in,lo_out,hi_out);
+  allocate_grid();
 
   flangevin = NULL;
   grow_arrays(atom->nmax);
@@ -146,9 +147,14 @@ FixTTM::FixTTM(LAMMPS *lmp, int narg, char **arg) :
   atom->add_callback(1);
 
   // set initial electron temperatures from user input file
-
-  if (me == 0) read_initial_electron_temperatures();
-  MPI_Bcast(&T_electron[0][0][0],total_nnodes,MPI_DOUBLE,0,world);
+  // proc 0 reads the full grid, each proc keeps its own portion
+
+  double *T_global;
+  memory->create(T_global,total_nnodes,"ttm:T_global");
+  if (comm->me == 0) read_initial_electron_temperatures(T_global);
+  MPI_Bcast(T_global,total_nnodes,MPI_DOUBLE,0,world);
+  copy_from_global(T_electron,T_global);
+  memory->destroy(T_global);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -162,18 +168,8 @@ FixTTM::~FixTTM()
   delete [] gfactor1;
   delete [] gfactor2;
 
-  memory->destroy(nsum);
-  memory->destroy(nsum_all);
-  memory->destroy(T_initial_set);
-  memory->destroy(sum_vsq);
-  memory->destroy(sum_mass_vsq);
-  memory->destroy(sum_vsq_all);
-  memory->destroy(sum_mass_vsq_all);
-  memory->destroy(T_electron_old);
-  memory->destroy(T_electron);
   memory->destroy(flangevin);
-  memory->destroy(net_energy_transfer);
-  memory->destroy(net_energy_transfer_all);
+  deallocate_grid();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -206,10 +202,10 @@ void FixTTM::init()
       sqrt(24.0*force->boltz*gamma_p/update->dt/force->mvv2e) / force->ftm2v;
   }
 
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++)
-        net_energy_transfer_all[ixnode][iynode][iznode] = 0;
+  for (int ixnode = lo_out[0]; ixnode <= hi_out[0]; ixnode++)
+    for (int iynode = lo_out[1]; iynode <= hi_out[1]; iynode++)
+      for (int iznode = lo_out[2]; iznode <= hi_out[2]; iznode++)
+        net_energy_transfer[ixnode][iynode][iznode] = 0;
 
   if (strstr(update->integrate_style,"respa"))
     nlevels_respa = ((Respa *) update->integrate)->nlevels;
@@ -219,6 +215,10 @@ void FixTTM::init()
 
 void FixTTM::setup(int vflag)
 {
+  // sub-domains may have changed since the grid was last partitioned
+
+  reset_grid();
+
   if (strstr(update->integrate_style,"verlet"))
     post_force_setup(vflag);
   else {
@@ -240,24 +240,17 @@ void FixTTM::post_force(int vflag)
   int nlocal = atom->nlocal;
 
   double gamma1,gamma2;
+  int ixnode,iynode,iznode;
+
+  // sub-domains can change when atoms migrate, e.g. via fix balance
+
+  if (neighbor->ago == 0) reset_grid();
 
   // apply damping and thermostat to all atoms in fix group
 
   for (int i = 0; i < nlocal; i++) {
     if (mask[i] & groupbit) {
-
-      double xscale = (x[i][0] - domain->boxlo[0])/domain->xprd;
-      double yscale = (x[i][1] - domain->boxlo[1])/domain->yprd;
-      double zscale = (x[i][2] - domain->boxlo[2])/domain->zprd;
-      int ixnode = static_cast<int>(xscale*nxnodes);
-      int iynode = static_cast<int>(yscale*nynodes);
-      int iznode = static_cast<int>(zscale*nznodes);
-      while (ixnode > nxnodes-1) ixnode -= nxnodes;
-      while (iynode > nynodes-1) iynode -= nynodes;
-      while (iznode > nznodes-1) iznode -= nznodes;
-      while (ixnode < 0) ixnode += nxnodes;
-      while (iynode < 0) iynode += nynodes;
-      while (iznode < 0) iznode += nznodes;
+      atom_node(x[i],ixnode,iynode,iznode);
 
       if (T_electron[ixnode][iynode][iznode] < 0)
         error->all(FLERR,"Electronic temperature dropped below zero");
@@ -324,17 +317,17 @@ void FixTTM::reset_dt()
 
 /* ----------------------------------------------------------------------
    read in initial electron temperatures from a user-specified file
+   store them in the global grid T_global
    only called by proc 0
 ------------------------------------------------------------------------- */
 
-void FixTTM::read_initial_electron_temperatures()
+void FixTTM::read_initial_electron_temperatures(double *T_global)
 {
   char line[MAXLINE];
 
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++)
-        T_initial_set[ixnode][iynode][iznode] = 0;
+  int *T_initial_set;
+  memory->create(T_initial_set,total_nnodes,"ttm:T_initial_set");
+  for (int i = 0; i < total_nnodes; i++) T_initial_set[i] = 0;
 
   // read initial electron temperature values from file
 
@@ -344,15 +337,19 @@ void FixTTM::read_initial_electron_temperatures()
     if (fgets(line,MAXLINE,fpr) == NULL) break;
     sscanf(line,"%d %d %d %lg",&ixnode,&iynode,&iznode,&T_tmp);
     if (T_tmp < 0.0) error->one(FLERR,"Fix ttm electron temperatures must be > 0.0");
-    T_electron[ixnode][iynode][iznode] = T_tmp;
-    T_initial_set[ixnode][iynode][iznode] = 1;
+    if (ixnode < 0 || ixnode >= nxnodes || iynode < 0 || iynode >= nynodes ||
+        iznode < 0 || iznode >= nznodes)
+      error->one(FLERR,"Fix ttm node index out of range in temperature file");
+    int m = (ixnode*nynodes + iynode)*nznodes + iznode;
+    T_global[m] = T_tmp;
+    T_initial_set[m] = 1;
   }
 
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++)
-        if (T_initial_set[ixnode][iynode][iznode] == 0)
-          error->one(FLERR,"Initial temperatures not all set in fix ttm");
+  for (int i = 0; i < total_nnodes; i++)
+    if (T_initial_set[i] == 0)
+      error->one(FLERR,"Initial temperatures not all set in fix ttm");
+
+  memory->destroy(T_initial_set);
 
   // close file
 
@@ -370,34 +367,24 @@ void FixTTM::end_of_step()
   int *type = atom->type;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
+  int ixnode,iynode,iznode;
 
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++)
+  for (ixnode = lo_out[0]; ixnode <= hi_out[0]; ixnode++)
+    for (iynode = lo_out[1]; iynode <= hi_out[1]; iynode++)
+      for (iznode = lo_out[2]; iznode <= hi_out[2]; iznode++)
         net_energy_transfer[ixnode][iynode][iznode] = 0;
 
   for (int i = 0; i < nlocal; i++)
     if (mask[i] & groupbit) {
-      double xscale = (x[i][0] - domain->boxlo[0])/domain->xprd;
-      double yscale = (x[i][1] - domain->boxlo[1])/domain->yprd;
-      double zscale = (x[i][2] - domain->boxlo[2])/domain->zprd;
-      int ixnode = static_cast<int>(xscale*nxnodes);
-      int iynode = static_cast<int>(yscale*nynodes);
-      int iznode = static_cast<int>(zscale*nznodes);
-      while (ixnode > nxnodes-1) ixnode -= nxnodes;
-      while (iynode > nynodes-1) iynode -= nynodes;
-      while (iznode > nznodes-1) iznode -= nznodes;
-      while (ixnode < 0) ixnode += nxnodes;
-      while (iynode < 0) iynode += nynodes;
-      while (iznode < 0) iznode += nznodes;
+      atom_node(x[i],ixnode,iynode,iznode);
       net_energy_transfer[ixnode][iynode][iznode] +=
         (flangevin[i][0]*v[i][0] + flangevin[i][1]*v[i][1] +
          flangevin[i][2]*v[i][2]);
     }
 
-  MPI_Allreduce(&net_energy_transfer[0][0][0],
-                &net_energy_transfer_all[0][0][0],
-                total_nnodes,MPI_DOUBLE,MPI_SUM,world);
+  // sum contributions to ghost nodes into the procs that own them
+
+  reverse_comm_grid(net_energy_transfer);
 
   double dx = domain->xprd/nxnodes;
   double dy = domain->yprd/nynodes;
@@ -421,32 +408,30 @@ void FixTTM::end_of_step()
       error->warning(FLERR,"Too many inner timesteps in fix ttm",0);
   }
 
+  // each proc only updates the nodes it owns
+  // ghost node values are refreshed after every inner step,
+  //   so they are current for the next stencil and for post_force()
+
   for (int ith_inner_timestep = 0; ith_inner_timestep < num_inner_timesteps;
        ith_inner_timestep++) {
 
-    for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-      for (int iynode = 0; iynode < nynodes; iynode++)
-        for (int iznode = 0; iznode < nznodes; iznode++)
+    for (ixnode = lo_out[0]; ixnode <= hi_out[0]; ixnode++)
+      for (iynode = lo_out[1]; iynode <= hi_out[1]; iynode++)
+        for (iznode = lo_out[2]; iznode <= hi_out[2]; iznode++)
           T_electron_old[ixnode][iynode][iznode] =
             T_electron[ixnode][iynode][iznode];
 
     // compute new electron T profile
 
-    for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-      for (int iynode = 0; iynode < nynodes; iynode++)
-        for (int iznode = 0; iznode < nznodes; iznode++) {
+    for (ixnode = lo_in[0]; ixnode <= hi_in[0]; ixnode++)
+      for (iynode = lo_in[1]; iynode <= hi_in[1]; iynode++)
+        for (iznode = lo_in[2]; iznode <= hi_in[2]; iznode++) {
           int right_xnode = ixnode + 1;
           int right_ynode = iynode + 1;
           int right_znode = iznode + 1;
-          if (right_xnode == nxnodes) right_xnode = 0;
-          if (right_ynode == nynodes) right_ynode = 0;
-          if (right_znode == nznodes) right_znode = 0;
           int left_xnode = ixnode - 1;
           int left_ynode = iynode - 1;
           int left_znode = iznode - 1;
-          if (left_xnode == -1) left_xnode = nxnodes - 1;
-          if (left_ynode == -1) left_ynode = nynodes - 1;
-          if (left_znode == -1) left_znode = nznodes - 1;
           T_electron[ixnode][iynode][iznode] =
             T_electron_old[ixnode][iynode][iznode] +
             inner_dt/(electronic_specific_heat*electronic_density) *
@@ -460,8 +445,10 @@ void FixTTM::end_of_step()
               (T_electron_old[ixnode][iynode][right_znode] +
                T_electron_old[ixnode][iynode][left_znode] -
                2*T_electron_old[ixnode][iynode][iznode])/dz/dz) -
-              (net_energy_transfer_all[ixnode][iynode][iznode])/del_vol);
+              (net_energy_transfer[ixnode][iynode][iznode])/del_vol);
         }
+
+    forward_comm_grid(T_electron);
   }
 
   // output nodal temperatures for current timestep
@@ -470,15 +457,11 @@ void FixTTM::end_of_step()
 
     // compute atomic Ta for each grid point
 
-    for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-      for (int iynode = 0; iynode < nynodes; iynode++)
-        for (int iznode = 0; iznode < nznodes; iznode++) {
-          nsum[ixnode][iynode][iznode] = 0;
-          nsum_all[ixnode][iynode][iznode] = 0;
-          sum_vsq[ixnode][iynode][iznode] = 0.0;
+    for (ixnode = lo_out[0]; ixnode <= hi_out[0]; ixnode++)
+      for (iynode = lo_out[1]; iynode <= hi_out[1]; iynode++)
+        for (iznode = lo_out[2]; iznode <= hi_out[2]; iznode++) {
+          nsum[ixnode][iynode][iznode] = 0.0;
           sum_mass_vsq[ixnode][iynode][iznode] = 0.0;
-          sum_vsq_all[ixnode][iynode][iznode] = 0.0;
-          sum_mass_vsq_all[ixnode][iynode][iznode] = 0.0;
         }
 
     double massone;
@@ -486,64 +469,59 @@ void FixTTM::end_of_step()
       if (mask[i] & groupbit) {
         if (rmass) massone = rmass[i];
         else massone = mass[type[i]];
-        double xscale = (x[i][0] - domain->boxlo[0])/domain->xprd;
-        double yscale = (x[i][1] - domain->boxlo[1])/domain->yprd;
-        double zscale = (x[i][2] - domain->boxlo[2])/domain->zprd;
-        int ixnode = static_cast<int>(xscale*nxnodes);
-        int iynode = static_cast<int>(yscale*nynodes);
-        int iznode = static_cast<int>(zscale*nznodes);
-        while (ixnode > nxnodes-1) ixnode -= nxnodes;
-        while (iynode > nynodes-1) iynode -= nynodes;
-        while (iznode > nznodes-1) iznode -= nznodes;
-        while (ixnode < 0) ixnode += nxnodes;
-        while (iynode < 0) iynode += nynodes;
-        while (iznode < 0) iznode += nznodes;
+        atom_node(x[i],ixnode,iynode,iznode);
         double vsq = v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
-        nsum[ixnode][iynode][iznode] += 1;
-        sum_vsq[ixnode][iynode][iznode] += vsq;
+        nsum[ixnode][iynode][iznode] += 1.0;
         sum_mass_vsq[ixnode][iynode][iznode] += massone*vsq;
       }
 
-    MPI_Allreduce(&nsum[0][0][0],&nsum_all[0][0][0],total_nnodes,
-                  MPI_INT,MPI_SUM,world);
-    MPI_Allreduce(&sum_vsq[0][0][0],&sum_vsq_all[0][0][0],total_nnodes,
-                  MPI_DOUBLE,MPI_SUM,world);
-    MPI_Allreduce(&sum_mass_vsq[0][0][0],&sum_mass_vsq_all[0][0][0],
-                  total_nnodes,MPI_DOUBLE,MPI_SUM,world);
-
-    if (me == 0) {
-      fprintf(fp,BIGINT_FORMAT,update->ntimestep);
+    reverse_comm_grid(nsum);
+    reverse_comm_grid(sum_mass_vsq);
+
+    // pack T_a and T_e of owned nodes and collect them on proc 0
+
+    double *local,*global = NULL;
+    memory->create(local,2*ngridin,"ttm:local");
+    if (comm->me == 0) memory->create(global,2*total_nnodes,"ttm:global");
+
+    int n = 0;
+    for (ixnode = lo_in[0]; ixnode <= hi_in[0]; ixnode++)
+      for (iynode = lo_in[1]; iynode <= hi_in[1]; iynode++)
+        for (iznode = lo_in[2]; iznode <= hi_in[2]; iznode++) {
+          local[n] = 0.0;
+          if (nsum[ixnode][iynode][iznode] > 0.0)
+            local[n] = sum_mass_vsq[ixnode][iynode][iznode]/
+              (3.0*force->boltz*nsum[ixnode][iynode][iznode]/force->mvv2e);
+          local[n+1] = T_electron[ixnode][iynode][iznode];
+          n += 2;
+        }
 
-      double T_a;
-      for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-        for (int iynode = 0; iynode < nynodes; iynode++)
-          for (int iznode = 0; iznode < nznodes; iznode++) {
-            T_a = 0;
-            if (nsum_all[ixnode][iynode][iznode] > 0)
-              T_a = sum_mass_vsq_all[ixnode][iynode][iznode]/
-                (3.0*force->boltz*nsum_all[ixnode][iynode][iznode]/force->mvv2e);
-            fprintf(fp," %f",T_a);
-          }
+    gather_grid(2,local,global);
 
+    if (comm->me == 0) {
+      fprintf(fp,BIGINT_FORMAT,update->ntimestep);
+      for (int m = 0; m < total_nnodes; m++) fprintf(fp," %f",global[2*m]);
       fprintf(fp,"\t");
-      for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-        for (int iynode = 0; iynode < nynodes; iynode++)
-          for (int iznode = 0; iznode < nznodes; iznode++)
-            fprintf(fp,"%f ",T_electron[ixnode][iynode][iznode]);
+      for (int m = 0; m < total_nnodes; m++) fprintf(fp,"%f ",global[2*m+1]);
       fprintf(fp,"\n");
     }
+
+    memory->destroy(local);
+    memory->destroy(global);
   }
 }
 
 /* ----------------------------------------------------------------------
-   memory usage of 3d grid
+   memory usage of local 3d grid and its communication buffers
 ------------------------------------------------------------------------- */
 
 double FixTTM::memory_usage()
 {
   double bytes = 0.0;
-  bytes += 5*total_nnodes * sizeof(int);
-  bytes += 14*total_nnodes * sizeof(double);
+  bytes += 5*ngridout * sizeof(double);
+  for (int i = 0; i < nswap; i++)
+    bytes += (swap[i].npack + swap[i].nunpack) * sizeof(int);
+  bytes += 2*nbuf * sizeof(double);
   return bytes;
 }
 
@@ -556,6 +534,41 @@ void FixTTM::grow_arrays(int ngrow)
 
 }
 
+/* ----------------------------------------------------------------------
+   copy values within local atom-based array
+------------------------------------------------------------------------- */
+
+void FixTTM::copy_arrays(int i, int j)
+{
+  flangevin[j][0] = flangevin[i][0];
+  flangevin[j][1] = flangevin[i][1];
+  flangevin[j][2] = flangevin[i][2];
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based array for exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixTTM::pack_exchange(int i, double *buf)
+{
+  buf[0] = flangevin[i][0];
+  buf[1] = flangevin[i][1];
+  buf[2] = flangevin[i][2];
+  return 3;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based array from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixTTM::unpack_exchange(int nlocal, double *buf)
+{
+  flangevin[nlocal][0] = buf[0];
+  flangevin[nlocal][1] = buf[1];
+  flangevin[nlocal][2] = buf[2];
+  return 3;
+}
+
 /* ----------------------------------------------------------------------
   return the energy of the electronic subsystem or the net_energy transfer
    between the subsystems
@@ -571,19 +584,24 @@ double FixTTM::compute_vector(int n)
   double dz = domain->zprd/nznodes;
   double del_vol = dx*dy*dz;
 
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++) {
+  for (int ixnode = lo_in[0]; ixnode <= hi_in[0]; ixnode++)
+    for (int iynode = lo_in[1]; iynode <= hi_in[1]; iynode++)
+      for (int iznode = lo_in[2]; iznode <= hi_in[2]; iznode++) {
         e_energy +=
           T_electron[ixnode][iynode][iznode]*electronic_specific_heat*
           electronic_density*del_vol;
         transfer_energy +=
-          net_energy_transfer_all[ixnode][iynode][iznode]*update->dt;
+          net_energy_transfer[ixnode][iynode][iznode]*update->dt;
   }
 
-  if (n == 0) return e_energy;
-  if (n == 1) return transfer_energy;
-  return 0.0;
+  double one = 0.0;
+  if (n == 0) one = e_energy;
+  else if (n == 1) one = transfer_energy;
+  else return 0.0;
+
+  double all;
+  MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
+  return all;
 }
 
 /* ----------------------------------------------------------------------
@@ -592,23 +610,25 @@ double FixTTM::compute_vector(int n)
 
 void FixTTM::write_restart(FILE *fp)
 {
-  double *rlist;
-  memory->create(rlist,nxnodes*nynodes*nznodes+1,"TTM:rlist");
+  double *local,*rlist = NULL;
+  memory->create(local,ngridin,"TTM:local");
+  if (comm->me == 0) memory->create(rlist,total_nnodes+1,"TTM:rlist");
 
   int n = 0;
-  rlist[n++] = seed;
-
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++)
-        rlist[n++] =  T_electron[ixnode][iynode][iznode];
+  for (int ixnode = lo_in[0]; ixnode <= hi_in[0]; ixnode++)
+    for (int iynode = lo_in[1]; iynode <= hi_in[1]; iynode++)
+      for (int iznode = lo_in[2]; iznode <= hi_in[2]; iznode++)
+        local[n++] = T_electron[ixnode][iynode][iznode];
 
   if (comm->me == 0) {
-    int size = n * sizeof(double);
+    rlist[0] = seed;
+    gather_grid(1,local,&rlist[1]);
+    int size = (total_nnodes+1) * sizeof(double);
     fwrite(&size,sizeof(int),1,fp);
-    fwrite(rlist,sizeof(double),n,fp);
-  }
+    fwrite(rlist,sizeof(double),total_nnodes+1,fp);
+  } else gather_grid(1,local,NULL);
 
+  memory->destroy(local);
   memory->destroy(rlist);
 }
 
@@ -618,17 +638,13 @@ void FixTTM::write_restart(FILE *fp)
 
 void FixTTM::restart(char *buf)
 {
-  int n = 0;
   double *rlist = (double *) buf;
 
   // the seed must be changed from the initial seed
 
-  seed = static_cast<int> (0.5*rlist[n++]);
+  seed = static_cast<int> (0.5*rlist[0]);
 
-  for (int ixnode = 0; ixnode < nxnodes; ixnode++)
-    for (int iynode = 0; iynode < nynodes; iynode++)
-      for (int iznode = 0; iznode < nznodes; iznode++)
-        T_electron[ixnode][iynode][iznode] = rlist[n++];
+  copy_from_global(T_electron,&rlist[1]);
 
   delete random;
   random = new RanMars(lmp,seed+comm->me);
@@ -683,3 +699,476 @@ int FixTTM::size_restart(int nlocal)
 {
   return 4;
 }
+
+/* ----------------------------------------------------------------------
+   compute extent of grid nodes owned by this proc and of its ghost nodes
+   owned nodes are those whose lower corner lies in my sub-domain
+   ghost nodes cover atoms up to 1/2 skin outside my sub-domain,
+     plus one extra layer for the diffusion stencil
+   ghost indices are not wrapped, they can be < 0 or >= # of nodes
+------------------------------------------------------------------------- */
+
+void FixTTM::grid_bounds(int *inlo, int *inhi, int *outlo, int *outhi)
+{
+  int nnodes[3] = {nxnodes,nynodes,nznodes};
+  double *split[3] = {comm->xsplit,comm->ysplit,comm->zsplit};
+  double *boxlo = domain->boxlo;
+  double *prd = domain->prd;
+  double *sublo = domain->sublo;
+  double *subhi = domain->subhi;
+  double dist = 0.5*neighbor->skin;
+
+  for (int dim = 0; dim < 3; dim++) {
+    int myloc = comm->myloc[dim];
+    inlo[dim] = static_cast<int> (split[dim][myloc] * nnodes[dim]);
+    inhi[dim] = static_cast<int> (split[dim][myloc+1] * nnodes[dim]) - 1;
+
+    // add/subtract OFFSET to avoid int(-0.75) = 0 when want it to be -1
+
+    int lo = static_cast<int>
+      ((sublo[dim]-dist-boxlo[dim])/prd[dim] * nnodes[dim] + OFFSET) - OFFSET;
+    int hi = static_cast<int>
+      ((subhi[dim]+dist-boxlo[dim])/prd[dim] * nnodes[dim] + OFFSET) - OFFSET;
+    outlo[dim] = MIN(lo,inlo[dim]-1);
+    outhi[dim] = MAX(hi,inhi[dim]+1);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   allocate local grid arrays and build ghost node communication pattern
+------------------------------------------------------------------------- */
+
+void FixTTM::allocate_grid()
+{
+  ngridin = (hi_in[0]-lo_in[0]+1) * (hi_in[1]-lo_in[1]+1) *
+    (hi_in[2]-lo_in[2]+1);
+  ngridout = (hi_out[0]-lo_out[0]+1) * (hi_out[1]-lo_out[1]+1) *
+    (hi_out[2]-lo_out[2]+1);
+
+  memory->create3d_offset(T_electron,lo_out[0],hi_out[0],lo_out[1],hi_out[1],
+                          lo_out[2],hi_out[2],"ttm:T_electron");
+  memory->create3d_offset(T_electron_old,lo_out[0],hi_out[0],
+                          lo_out[1],hi_out[1],lo_out[2],hi_out[2],
+                          "ttm:T_electron_old");
+  memory->create3d_offset(net_energy_transfer,lo_out[0],hi_out[0],
+                          lo_out[1],hi_out[1],lo_out[2],hi_out[2],
+                          "ttm:net_energy_transfer");
+  memory->create3d_offset(nsum,lo_out[0],hi_out[0],lo_out[1],hi_out[1],
+                          lo_out[2],hi_out[2],"ttm:nsum");
+  memory->create3d_offset(sum_mass_vsq,lo_out[0],hi_out[0],
+                          lo_out[1],hi_out[1],lo_out[2],hi_out[2],
+                          "ttm:sum_mass_vsq");
+
+  for (int ixnode = lo_out[0]; ixnode <= hi_out[0]; ixnode++)
+    for (int iynode = lo_out[1]; iynode <= hi_out[1]; iynode++)
+      for (int iznode = lo_out[2]; iznode <= hi_out[2]; iznode++) {
+        T_electron[ixnode][iynode][iznode] = 0.0;
+        net_energy_transfer[ixnode][iynode][iznode] = 0.0;
+      }
+
+  setup_grid_comm();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixTTM::deallocate_grid()
+{
+  memory->destroy3d_offset(T_electron,lo_out[0],lo_out[1],lo_out[2]);
+  memory->destroy3d_offset(T_electron_old,lo_out[0],lo_out[1],lo_out[2]);
+  memory->destroy3d_offset(net_energy_transfer,lo_out[0],lo_out[1],lo_out[2]);
+  memory->destroy3d_offset(nsum,lo_out[0],lo_out[1],lo_out[2]);
+  memory->destroy3d_offset(sum_mass_vsq,lo_out[0],lo_out[1],lo_out[2]);
+
+  for (int i = 0; i < nswap; i++) {
+    memory->destroy(swap[i].packlist);
+    memory->destroy(swap[i].unpacklist);
+  }
+  memory->sfree(swap);
+  swap = NULL;
+  nswap = 0;
+
+  memory->destroy(buf1);
+  memory->destroy(buf2);
+}
+
+/* ----------------------------------------------------------------------
+   re-partition the grid if sub-domain boundaries moved
+   electron temperatures are carried over via a one-time global reduction
+------------------------------------------------------------------------- */
+
+void FixTTM::reset_grid()
+{
+  int inlo[3],inhi[3],outlo[3],outhi[3];
+  grid_bounds(inlo,inhi,outlo,outhi);
+
+  int change = 0;
+  for (int dim = 0; dim < 3; dim++)
+    if (inlo[dim] != lo_in[dim] || inhi[dim] != hi_in[dim] ||
+        outlo[dim] != lo_out[dim] || outhi[dim] != hi_out[dim]) change = 1;
+
+  int anychange;
+  MPI_Allreduce(&change,&anychange,1,MPI_INT,MPI_MAX,world);
+  if (!anychange) return;
+
+  double *T_one,*T_global;
+  memory->create(T_one,total_nnodes,"ttm:T_one");
+  memory->create(T_global,total_nnodes,"ttm:T_global");
+  for (int i = 0; i < total_nnodes; i++) T_one[i] = 0.0;
+
+  for (int ixnode = lo_in[0]; ixnode <= hi_in[0]; ixnode++)
+    for (int iynode = lo_in[1]; iynode <= hi_in[1]; iynode++)
+      for (int iznode = lo_in[2]; iznode <= hi_in[2]; iznode++)
+        T_one[(ixnode*nynodes + iynode)*nznodes + iznode] =
+          T_electron[ixnode][iynode][iznode];
+
+  MPI_Allreduce(T_one,T_global,total_nnodes,MPI_DOUBLE,MPI_SUM,world);
+
+  deallocate_grid();
+  for (int dim = 0; dim < 3; dim++) {
+    lo_in[dim] = inlo[dim];
+    hi_in[dim] = inhi[dim];
+    lo_out[dim] = outlo[dim];
+    hi_out[dim] = outhi[dim];
+  }
+  allocate_grid();
+
+  copy_from_global(T_electron,T_global);
+
+  memory->destroy(T_one);
+  memory->destroy(T_global);
+}
+
+/* ----------------------------------------------------------------------
+   set owned and ghost nodes of a local grid from a global grid
+   global grid is ordered with z fastest, x slowest
+------------------------------------------------------------------------- */
+
+void FixTTM::copy_from_global(double ***local, double *global)
+{
+  int ix,iy,iz;
+
+  for (int ixnode = lo_out[0]; ixnode <= hi_out[0]; ixnode++) {
+    ix = (ixnode % nxnodes + nxnodes) % nxnodes;
+    for (int iynode = lo_out[1]; iynode <= hi_out[1]; iynode++) {
+      iy = (iynode % nynodes + nynodes) % nynodes;
+      for (int iznode = lo_out[2]; iznode <= hi_out[2]; iznode++) {
+        iz = (iznode % nznodes + nznodes) % nznodes;
+        local[ixnode][iynode][iznode] = global[(ix*nynodes + iy)*nznodes + iz];
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   collect nvalues per owned node from all procs into global grid on proc 0
+   local = values of my owned nodes, in x,y,z loop order
+   global = only used on proc 0, ordered with z fastest, x slowest
+------------------------------------------------------------------------- */
+
+void FixTTM::gather_grid(int nvalues, double *local, double *global)
+{
+  int me = comm->me;
+  int nprocs = comm->nprocs;
+  MPI_Status status;
+
+  int bounds[6];
+  bounds[0] = lo_in[0]; bounds[1] = hi_in[0];
+  bounds[2] = lo_in[1]; bounds[3] = hi_in[1];
+  bounds[4] = lo_in[2]; bounds[5] = hi_in[2];
+
+  if (me != 0) {
+    MPI_Send(bounds,6,MPI_INT,0,0,world);
+    MPI_Send(local,nvalues*ngridin,MPI_DOUBLE,0,0,world);
+    return;
+  }
+
+  double *buf;
+  int nmax = ngridin;
+  memory->create(buf,nvalues*nmax,"ttm:gather");
+
+  for (int iproc = 0; iproc < nprocs; iproc++) {
+    double *values = local;
+    if (iproc) {
+      MPI_Recv(bounds,6,MPI_INT,iproc,0,world,&status);
+      int n = (bounds[1]-bounds[0]+1) * (bounds[3]-bounds[2]+1) *
+        (bounds[5]-bounds[4]+1);
+      if (n > nmax) {
+        nmax = n;
+        memory->destroy(buf);
+        memory->create(buf,nvalues*nmax,"ttm:gather");
+      }
+      MPI_Recv(buf,nvalues*n,MPI_DOUBLE,iproc,0,world,&status);
+      values = buf;
+    }
+
+    int m = 0;
+    for (int ixnode = bounds[0]; ixnode <= bounds[1]; ixnode++)
+      for (int iynode = bounds[2]; iynode <= bounds[3]; iynode++)
+        for (int iznode = bounds[4]; iznode <= bounds[5]; iznode++) {
+          int offset = nvalues * ((ixnode*nynodes + iynode)*nznodes + iznode);
+          for (int k = 0; k < nvalues; k++) global[offset+k] = values[m++];
+        }
+  }
+
+  memory->destroy(buf);
+}
+
+/* ----------------------------------------------------------------------
+   grid node that atom with coords xi is assigned to
+   node is first found in the global periodic grid as in serial,
+     then converted to the copy of that node stored by this proc
+------------------------------------------------------------------------- */
+
+void FixTTM::atom_node(double *xi, int &ixnode, int &iynode, int &iznode)
+{
+  double xscale = (xi[0] - domain->boxlo[0])/domain->xprd;
+  double yscale = (xi[1] - domain->boxlo[1])/domain->yprd;
+  double zscale = (xi[2] - domain->boxlo[2])/domain->zprd;
+  ixnode = static_cast<int>(xscale*nxnodes);
+  iynode = static_cast<int>(yscale*nynodes);
+  iznode = static_cast<int>(zscale*nznodes);
+  while (ixnode > nxnodes-1) ixnode -= nxnodes;
+  while (iynode > nynodes-1) iynode -= nynodes;
+  while (iznode > nznodes-1) iznode -= nznodes;
+  while (ixnode < 0) ixnode += nxnodes;
+  while (iynode < 0) iynode += nynodes;
+  while (iznode < 0) iznode += nznodes;
+
+  if (ixnode > hi_out[0]) ixnode -= nxnodes;
+  else if (ixnode < lo_out[0]) ixnode += nxnodes;
+  if (iynode > hi_out[1]) iynode -= nynodes;
+  else if (iynode < lo_out[1]) iynode += nynodes;
+  if (iznode > hi_out[2]) iznode -= nznodes;
+  else if (iznode < lo_out[2]) iznode += nznodes;
+
+  if (ixnode < lo_out[0] || ixnode > hi_out[0] ||
+      iynode < lo_out[1] || iynode > hi_out[1] ||
+      iznode < lo_out[2] || iznode > hi_out[2])
+    error->one(FLERR,"Out of range atoms - cannot compute fix ttm");
+}
+
+/* ----------------------------------------------------------------------
+   create swap stencil for own/ghost node communication
+   swaps cover all 3 dimensions and both directions
+   swaps cover multiple iterations in a direction if ghost nodes
+     are owned by a proc further away than the nearest neighbor
+   same swap list used by forward and reverse communication
+------------------------------------------------------------------------- */
+
+void FixTTM::setup_grid_comm()
+{
+  int me = comm->me;
+  MPI_Status status;
+
+  int nsent,sendfirst,sendlast,recvfirst,recvlast;
+  int sendplanes,recvplanes,notdoneme,notdone;
+  int ghostlo,ghosthi,nplanes;
+  int lo[3],hi[3];
+
+  int maxswap = 6;
+  swap = (Swap *) memory->smalloc(maxswap*sizeof(Swap),"ttm:swap");
+  nswap = 0;
+
+  for (int dim = 0; dim < 3; dim++) {
+    int proclo = comm->procneigh[dim][0];
+    int prochi = comm->procneigh[dim][1];
+
+    // planes in lower dims already include ghosts, planes in higher dims don't
+
+    for (int d = 0; d < 3; d++) {
+      lo[d] = d < dim ? lo_out[d] : lo_in[d];
+      hi[d] = d < dim ? hi_out[d] : hi_in[d];
+    }
+
+    // ghostlo/ghosthi = # of my lower/upper planes needed by proclo/prochi
+
+    nplanes = lo_in[dim] - lo_out[dim];
+    if (proclo != me)
+      MPI_Sendrecv(&nplanes,1,MPI_INT,proclo,0,
+                   &ghosthi,1,MPI_INT,prochi,0,world,&status);
+    else ghosthi = nplanes;
+
+    nplanes = hi_out[dim] - hi_in[dim];
+    if (prochi != me)
+      MPI_Sendrecv(&nplanes,1,MPI_INT,prochi,0,
+                   &ghostlo,1,MPI_INT,proclo,0,world,&status);
+    else ghostlo = nplanes;
+
+    // send own planes to lower proc, recv ghost planes from upper proc
+
+    nsent = 0;
+    sendfirst = lo_in[dim];
+    sendlast = hi_in[dim];
+    recvfirst = hi_in[dim]+1;
+    notdone = 1;
+
+    while (notdone) {
+      if (nswap == maxswap) {
+        maxswap += 6;
+        swap = (Swap *)
+          memory->srealloc(swap,maxswap*sizeof(Swap),"ttm:swap");
+      }
+
+      swap[nswap].sendproc = proclo;
+      swap[nswap].recvproc = prochi;
+      sendplanes = MIN(sendlast-sendfirst+1,ghostlo-nsent);
+      lo[dim] = sendfirst;
+      hi[dim] = sendfirst+sendplanes-1;
+      swap[nswap].npack = indices(swap[nswap].packlist,lo,hi);
+
+      if (proclo != me)
+        MPI_Sendrecv(&sendplanes,1,MPI_INT,proclo,0,
+                     &recvplanes,1,MPI_INT,prochi,0,world,&status);
+      else recvplanes = sendplanes;
+
+      lo[dim] = recvfirst;
+      hi[dim] = recvfirst+recvplanes-1;
+      swap[nswap].nunpack = indices(swap[nswap].unpacklist,lo,hi);
+
+      nsent += sendplanes;
+      sendfirst += sendplanes;
+      sendlast += recvplanes;
+      recvfirst += recvplanes;
+      nswap++;
+
+      if (nsent < ghostlo) notdoneme = 1;
+      else notdoneme = 0;
+      MPI_Allreduce(&notdoneme,&notdone,1,MPI_INT,MPI_SUM,world);
+    }
+
+    // send own planes to upper proc, recv ghost planes from lower proc
+
+    nsent = 0;
+    sendfirst = lo_in[dim];
+    sendlast = hi_in[dim];
+    recvlast = lo_in[dim]-1;
+    notdone = 1;
+
+    while (notdone) {
+      if (nswap == maxswap) {
+        maxswap += 6;
+        swap = (Swap *)
+          memory->srealloc(swap,maxswap*sizeof(Swap),"ttm:swap");
+      }
+
+      swap[nswap].sendproc = prochi;
+      swap[nswap].recvproc = proclo;
+      sendplanes = MIN(sendlast-sendfirst+1,ghosthi-nsent);
+      lo[dim] = sendlast-sendplanes+1;
+      hi[dim] = sendlast;
+      swap[nswap].npack = indices(swap[nswap].packlist,lo,hi);
+
+      if (prochi != me)
+        MPI_Sendrecv(&sendplanes,1,MPI_INT,prochi,0,
+                     &recvplanes,1,MPI_INT,proclo,0,world,&status);
+      else recvplanes = sendplanes;
+
+      lo[dim] = recvlast-recvplanes+1;
+      hi[dim] = recvlast;
+      swap[nswap].nunpack = indices(swap[nswap].unpacklist,lo,hi);
+
+      nsent += sendplanes;
+      sendfirst -= recvplanes;
+      sendlast -= sendplanes;
+      recvlast -= recvplanes;
+      nswap++;
+
+      if (nsent < ghosthi) notdoneme = 1;
+      else notdoneme = 0;
+      MPI_Allreduce(&notdoneme,&notdone,1,MPI_INT,MPI_SUM,world);
+    }
+  }
+
+  // nbuf = max of any pack/unpack
+
+  nbuf = 1;
+  for (int i = 0; i < nswap; i++) {
+    nbuf = MAX(nbuf,swap[i].npack);
+    nbuf = MAX(nbuf,swap[i].nunpack);
+  }
+  memory->create(buf1,nbuf,"ttm:buf1");
+  memory->create(buf2,nbuf,"ttm:buf2");
+}
+
+/* ----------------------------------------------------------------------
+   create 1d list of offsets into 3d array section (lo:hi in each dim)
+   3d array is allocated over the ghost extent with z fastest
+------------------------------------------------------------------------- */
+
+int FixTTM::indices(int *&list, int *lo, int *hi)
+{
+  int nmax = (hi[0]-lo[0]+1) * (hi[1]-lo[1]+1) * (hi[2]-lo[2]+1);
+  if (nmax < 0) nmax = 0;
+  memory->create(list,MAX(nmax,1),"ttm:list");
+
+  int ny = hi_out[1]-lo_out[1]+1;
+  int nz = hi_out[2]-lo_out[2]+1;
+
+  int n = 0;
+  for (int ix = lo[0]; ix <= hi[0]; ix++)
+    for (int iy = lo[1]; iy <= hi[1]; iy++)
+      for (int iz = lo[2]; iz <= hi[2]; iz++)
+        list[n++] = ((ix-lo_out[0])*ny + (iy-lo_out[1]))*nz + (iz-lo_out[2]);
+
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   use swap list in forward order to set all ghost node values
+   from the procs that own them
+------------------------------------------------------------------------- */
+
+void FixTTM::forward_comm_grid(double ***grid)
+{
+  int me = comm->me;
+  MPI_Request request;
+  MPI_Status status;
+  double *data = &grid[lo_out[0]][lo_out[1]][lo_out[2]];
+  double *buf;
+  int i;
+
+  for (int m = 0; m < nswap; m++) {
+    if (swap[m].sendproc == me) buf = buf2;
+    else buf = buf1;
+    for (i = 0; i < swap[m].npack; i++) buf[i] = data[swap[m].packlist[i]];
+
+    if (swap[m].sendproc != me) {
+      MPI_Irecv(buf2,swap[m].nunpack,MPI_DOUBLE,
+                swap[m].recvproc,0,world,&request);
+      MPI_Send(buf1,swap[m].npack,MPI_DOUBLE,swap[m].sendproc,0,world);
+      MPI_Wait(&request,&status);
+    }
+
+    for (i = 0; i < swap[m].nunpack; i++) data[swap[m].unpacklist[i]] = buf2[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   use swap list in reverse order to sum ghost node values
+   into the procs that own them
+------------------------------------------------------------------------- */
+
+void FixTTM::reverse_comm_grid(double ***grid)
+{
+  int me = comm->me;
+  MPI_Request request;
+  MPI_Status status;
+  double *data = &grid[lo_out[0]][lo_out[1]][lo_out[2]];
+  double *buf;
+  int i;
+
+  for (int m = nswap-1; m >= 0; m--) {
+    if (swap[m].recvproc == me) buf = buf2;
+    else buf = buf1;
+    for (i = 0; i < swap[m].nunpack; i++) buf[i] = data[swap[m].unpacklist[i]];
+
+    if (swap[m].recvproc != me) {
+      MPI_Irecv(buf2,swap[m].npack,MPI_DOUBLE,
+                swap[m].sendproc,0,world,&request);
+      MPI_Send(buf1,swap[m].nunpack,MPI_DOUBLE,swap[m].recvproc,0,world);
+      MPI_Wait(&request,&status);
+    }
+
+    for (i = 0; i < swap[m].npack; i++) data[swap[m].packlist[i]] += buf2[i];
+  }
+}
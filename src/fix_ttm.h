@@ -45,6 +45,9 @@ class FixTTM : public Fix {
   int maxsize_restart();
   double memory_usage();
   void grow_arrays(int);
+  void copy_arrays(int, int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
   double compute_vector(int);
 
  private:
@@ -55,19 +58,47 @@ class FixTTM : public Fix {
   class RanMars *random;
   FILE *fp,*fpr;
   int nxnodes,nynodes,nznodes,total_nnodes;
-  int ***nsum;
-  int ***nsum_all,***T_initial_set;
   double *gfactor1,*gfactor2,*ratio;
   double **flangevin;
-  double ***T_electron,***T_electron_old;
-  double ***sum_vsq,***sum_mass_vsq;
-  double ***sum_vsq_all,***sum_mass_vsq_all;
-  double ***net_energy_transfer,***net_energy_transfer_all;
   double electronic_specific_heat,electronic_density;
   double electronic_thermal_conductivity;
   double gamma_p,gamma_s,v_0,v_0_sq;
 
-  void read_initial_electron_temperatures();
+  // local portion of the grid, indexed by unwrapped global node indices
+  // in = nodes I own, out = owned + ghost nodes
+
+  int lo_in[3],hi_in[3],lo_out[3],hi_out[3];
+  int ngridin,ngridout;
+  double ***T_electron,***T_electron_old;
+  double ***net_energy_transfer;
+  double ***nsum,***sum_mass_vsq;
+
+  struct Swap {
+    int sendproc;       // proc to send to for forward comm
+    int recvproc;       // proc to recv from for forward comm
+    int npack;          // # of nodes to pack, i.e. send
+    int nunpack;        // # of nodes to unpack, i.e. recv
+    int *packlist;      // 3d array offsets to pack
+    int *unpacklist;    // 3d array offsets to unpack
+  };
+
+  int nswap;
+  Swap *swap;
+  int nbuf;
+  double *buf1,*buf2;
+
+  void read_initial_electron_temperatures(double *);
+  void grid_bounds(int *, int *, int *, int *);
+  void allocate_grid();
+  void deallocate_grid();
+  void reset_grid();
+  void setup_grid_comm();
+  int indices(int *&, int *, int *);
+  void copy_from_global(double ***, double *);
+  void gather_grid(int, double *, double *);
+  void atom_node(double *, int &, int &, int &);
+  void forward_comm_grid(double ***);
+  void reverse_comm_grid(double ***);
 };
 
 }
@@ -145,10 +176,22 @@ E: Fix ttm electron temperatures must be > 0.0
 
 Self-explanatory.
 
+E: Fix ttm node index out of range in temperature file
+
+The node indices in the initial temperature file must be between 0
+and the number of nodes - 1 in each dimension.
+
 E: Initial temperatures not all set in fix ttm
 
 Self-explantory.
 
+E: Out of range atoms - cannot compute fix ttm
+
+One or more atoms are assigned to a grid node this processor does not
+store.  This typically means atoms have moved too far outside their
+processor sub-domain, e.g. because the neighbor skin is too small for
+how far atoms move between reneighborings.
+
 W: Too many inner timesteps in fix ttm
 
 Self-explanatory.
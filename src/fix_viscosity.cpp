@@ -24,6 +24,7 @@
 #include "atom.h"
 #include "domain.h"
 #include "modify.h"
+#include "merge_candidates.h"
 #include "error.h"
 
 using namespace LAMMPS_NS;
@@ -33,6 +34,10 @@ using namespace FixConst;
 
 #define BIG 1.0e10
 
+// candidate = value,proc,index in proc's list,velocity,mass
+
+#define NCAND 5
+
 /* ---------------------------------------------------------------------- */
 
 FixViscosity::FixViscosity(LAMMPS *lmp, int narg, char **arg) :
@@ -91,6 +96,12 @@ FixViscosity::FixViscosity(LAMMPS *lmp, int narg, char **arg) :
   pos_delta = new double[nswap+1];
   neg_delta = new double[nswap+1];
 
+  cand_mine = new double[2*nswap*NCAND];
+  cand_all = new double[2*nswap*NCAND];
+  MPI_Type_contiguous(2*nswap*NCAND,MPI_DOUBLE,&cand_type);
+  MPI_Type_commit(&cand_type);
+  MPI_Op_create(MergeCandidates::op<NCAND>,1,&merge_op);
+
   p_exchange = 0.0;
 }
 
@@ -102,6 +113,10 @@ FixViscosity::~FixViscosity()
   delete [] neg_index;
   delete [] pos_delta;
   delete [] neg_delta;
+  delete [] cand_mine;
+  delete [] cand_all;
+  MPI_Op_free(&merge_op);
+  MPI_Type_free(&cand_type);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -152,11 +167,6 @@ void FixViscosity::end_of_step()
 {
   int i,m,insert;
   double coord,delta;
-  MPI_Status status;
-  struct {
-    double value;
-    int proc;
-  } mine[2],all[2];
 
   // if box changes, recompute bounds of 2 slabs in pdim
 
@@ -226,77 +236,71 @@ void FixViscosity::end_of_step()
       }
     }
 
-  // loop over nswap pairs
-  // find 2 global atoms with smallest delta in bottom/top slabs
-  // BIG values are for procs with no atom to contribute
-  // MINLOC also communicates which procs own them
-  // exchange momenta between the 2 particles
-  // if I own both particles just swap, else point2point comm of vel,mass
+  // pack up to nswap candidates from each of the 2 sorted lists,
+  //   with velocity and mass so no further comm is needed for the swaps
+  // BIG values are for procs with fewer than nswap atoms to contribute
+  // a single reduction merges the lists of all procs,
+  //   so every proc knows the nswap global pairs and which procs own them
 
   double *mass = atom->mass;
   double *rmass = atom->rmass;
+  double *c;
+
+  for (m = 0; m < nswap; m++) {
+    c = &cand_mine[m*NCAND];
+    if (m < npositive) {
+      i = pos_index[m];
+      c[0] = pos_delta[m];
+      c[3] = v[i][vdim];
+      if (rmass) c[4] = rmass[i];
+      else c[4] = mass[type[i]];
+    } else c[0] = BIG;
+    c[1] = me;
+    c[2] = m;
+
+    c = &cand_mine[(nswap+m)*NCAND];
+    if (m < nnegative) {
+      i = neg_index[m];
+      c[0] = neg_delta[m];
+      c[3] = v[i][vdim];
+      if (rmass) c[4] = rmass[i];
+      else c[4] = mass[type[i]];
+    } else c[0] = BIG;
+    c[1] = me;
+    c[2] = m;
+  }
 
-  int ipos,ineg;
-  double sbuf[2],rbuf[2],vcm;
+  MPI_Allreduce(cand_mine,cand_all,1,cand_type,merge_op,world);
 
+  // loop over nswap pairs with smallest delta in bottom/middle slabs
+  // exchange momenta between the 2 particles
+  // owning procs update their atom, all procs tally the same momentum
+
+  double *cpos,*cneg,vcm;
   double pswap = 0.0;
-  mine[0].proc = mine[1].proc = me;
-  int ipositive = 0;
-  int inegative = 0;
 
   for (m = 0; m < nswap; m++) {
-    if (ipositive < npositive) mine[0].value = pos_delta[ipositive];
-    else mine[0].value = BIG;
-    if (inegative < nnegative) mine[1].value = neg_delta[inegative];
-    else mine[1].value = BIG;
-
-    MPI_Allreduce(mine,all,2,MPI_DOUBLE_INT,MPI_MINLOC,world);
-
-    if (all[0].value == BIG || all[1].value == BIG) continue;
-
-    if (me == all[0].proc && me == all[1].proc) {
-      ipos = pos_index[ipositive++];
-      ineg = neg_index[inegative++];
-      rbuf[0] = v[ipos][vdim];
-      if (rmass) rbuf[1] = rmass[ipos];
-      else rbuf[1] = mass[type[ipos]];
-      sbuf[0] = v[ineg][vdim];
-      if (rmass) sbuf[1] = rmass[ineg];
-      else sbuf[1] = mass[type[ineg]];
-      vcm = (sbuf[1]*sbuf[0] + rbuf[1]*rbuf[0]) / (sbuf[1] + rbuf[1]);
-      v[ineg][vdim] = 2.0 * vcm - sbuf[0];
-      v[ipos][vdim] = 2.0 * vcm - rbuf[0];
-      pswap += rbuf[1] * (vcm - rbuf[0]) - sbuf[1] * (vcm - sbuf[0]);
-
-    } else if (me == all[0].proc) {
-      ipos = pos_index[ipositive++];
-      sbuf[0] = v[ipos][vdim];
-      if (rmass) sbuf[1] = rmass[ipos];
-      else sbuf[1] = mass[type[ipos]];
-      MPI_Sendrecv(sbuf,2,MPI_DOUBLE,all[1].proc,0,
-                   rbuf,2,MPI_DOUBLE,all[1].proc,0,world,&status);
-      vcm = (sbuf[1]*sbuf[0] + rbuf[1]*rbuf[0]) / (sbuf[1] + rbuf[1]);
-      v[ipos][vdim] = 2.0 * vcm - sbuf[0];
-      pswap += sbuf[1] * (vcm - sbuf[0]);
-
-    } else if (me == all[1].proc) {
-      ineg = neg_index[inegative++];
-      sbuf[0] = v[ineg][vdim];
-      if (rmass) sbuf[1] = rmass[ineg];
-      else sbuf[1] = mass[type[ineg]];
-      MPI_Sendrecv(sbuf,2,MPI_DOUBLE,all[0].proc,0,
-                   rbuf,2,MPI_DOUBLE,all[0].proc,0,world,&status);
-      vcm = (sbuf[1]*sbuf[0] + rbuf[1]*rbuf[0]) / (sbuf[1] + rbuf[1]);
-      v[ineg][vdim] = 2.0 * vcm - sbuf[0];
-      pswap -= sbuf[1] * (vcm - sbuf[0]);
+    cpos = &cand_all[m*NCAND];
+    cneg = &cand_all[(nswap+m)*NCAND];
+    if (cpos[0] == BIG || cneg[0] == BIG) break;
+
+    vcm = (cneg[4]*cneg[3] + cpos[4]*cpos[3]) / (cneg[4] + cpos[4]);
+
+    if (static_cast<int> (cpos[1]) == me) {
+      i = pos_index[static_cast<int> (cpos[2])];
+      v[i][vdim] = 2.0 * vcm - cpos[3];
+    }
+    if (static_cast<int> (cneg[1]) == me) {
+      i = neg_index[static_cast<int> (cneg[2])];
+      v[i][vdim] = 2.0 * vcm - cneg[3];
     }
+
+    pswap += cpos[4] * (vcm - cpos[3]) - cneg[4] * (vcm - cneg[3]);
   }
 
   // tally momentum exchange from all swaps
 
-  double pswap_all;
-  MPI_Allreduce(&pswap,&pswap_all,1,MPI_DOUBLE,MPI_SUM,world);
-  p_exchange += pswap_all;
+  p_exchange += pswap;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -45,6 +45,10 @@ class FixViscosity : public Fix {
   int npositive,nnegative;
   int *pos_index,*neg_index;
   double *pos_delta,*neg_delta;
+
+  double *cand_mine,*cand_all;      // packed candidates for swap selection
+  MPI_Datatype cand_type;           // all candidates as one element
+  MPI_Op merge_op;                  // reduction that merges candidate lists
 };
 
 }
@@ -95,12 +95,7 @@ void Irregular::migrate_atoms()
     subhi = domain->subhi_lamda;
   }
 
-  uniform = comm->uniform;
-  xsplit = comm->xsplit;
-  ysplit = comm->ysplit;
-  zsplit = comm->zsplit;
-  boxlo = domain->boxlo;
-  prd = domain->prd;
+  setup_coord2proc();
 
   // loop over atoms, flag any that are not in my sub-box
   // fill buffer with atoms leaving my box, using < and >=
@@ -180,12 +175,7 @@ int Irregular::migrate_check()
     subhi = domain->subhi_lamda;
   }
 
-  uniform = comm->uniform;
-  xsplit = comm->xsplit;
-  ysplit = comm->ysplit;
-  zsplit = comm->zsplit;
-  boxlo = domain->boxlo;
-  prd = domain->prd;
+  setup_coord2proc();
 
   // loop over atoms, check for any that are not in my sub-box
   // assign which proc it belongs to via coord2proc()
@@ -691,6 +681,21 @@ void Irregular::destroy_data()
   dplan = NULL;
 }
 
+/* ----------------------------------------------------------------------
+   set comm/domain data used by coord2proc()
+   must be called before coord2proc() whenever the box or procs change
+------------------------------------------------------------------------- */
+
+void Irregular::setup_coord2proc()
+{
+  uniform = comm->uniform;
+  xsplit = comm->xsplit;
+  ysplit = comm->ysplit;
+  zsplit = comm->zsplit;
+  boxlo = domain->boxlo;
+  prd = domain->prd;
+}
+
 /* ----------------------------------------------------------------------
    determine which proc owns atom with coord x[3]
    x will be in box (orthogonal) or lamda coords (triclinic)
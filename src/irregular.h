@@ -24,9 +24,14 @@ class Irregular : protected Pointers {
   ~Irregular();
   void migrate_atoms();
   int migrate_check();
+  int create_atom(int, int *, int *);
+  void exchange_atom(double *, int *, double *);
+  void destroy_atom();
   int create_data(int, int *);
   void exchange_data(char *, int, char *);
   void destroy_data();
+  void setup_coord2proc();
+  int coord2proc(double *, int &, int &, int &);
   bigint memory_usage();
 
  private:
@@ -82,10 +87,6 @@ class Irregular : protected Pointers {
   PlanAtom *aplan;
   PlanData *dplan;
 
-  int create_atom(int, int *, int *);
-  void exchange_atom(double *, int *, double *);
-  void destroy_atom();
-  int coord2proc(double *, int &, int &, int &);
   int binary(double, int, double *);
 
   void grow_send(int,int);          // reallocate send buffer
@@ -519,6 +519,7 @@ void LAMMPS::destroy()
   delete neighbor;
   delete comm;
   delete force;
+  force = NULL;           // so computes can tell pair is gone
   delete group;
   delete output;
   delete modify;          // modify must come after output, force, update
@@ -0,0 +1,78 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_MERGE_CANDIDATES_H
+#define LMP_MERGE_CANDIDATES_H
+
+#include "mpi.h"
+#include "string.h"
+
+namespace LAMMPS_NS {
+
+namespace MergeCandidates {
+
+  // a candidate is a record of WIDTH doubles = value,proc,index,data ...
+  // ties in value are broken by proc, then by position in the proc's list,
+  //   same as a chain of MPI_MINLOC reductions would do
+
+  static inline int less(const double *a, const double *b)
+  {
+    if (a[0] != b[0]) return a[0] < b[0];
+    if (a[1] != b[1]) return a[1] < b[1];
+    return a[2] < b[2];
+  }
+
+  // MPI_Op that merges two candidate buffers, each holding 2 lists of
+  //   candidates sorted by ascending value, and keeps the smallest of
+  //   each list in inout
+  // the datatype is the whole buffer, so each call sees complete lists
+  //   and the list length follows from its size
+
+  template <int WIDTH>
+  void op(void *in, void *inout, int *len, MPI_Datatype *dtype)
+  {
+    double *one = (double *) in;
+    double *two = (double *) inout;
+    int size;
+    MPI_Type_size(*dtype,&size);
+    int n = size / (2*WIDTH*sizeof(double));
+
+    for (int list = 0; list < *len*2; list++) {
+      double *a = &one[list*n*WIDTH];
+      double *b = &two[list*n*WIDTH];
+
+      // count how many of the n smallest come from each list
+
+      int ia = 0;
+      int ib = 0;
+      for (int m = 0; m < n; m++) {
+        if (less(&a[ia*WIDTH],&b[ib*WIDTH])) ia++;
+        else ib++;
+      }
+
+      // merge from the back so that b is overwritten only where already read
+
+      for (int m = n-1; m >= 0; m--) {
+        double *src;
+        if (ib == 0 || (ia > 0 && less(&b[(ib-1)*WIDTH],&a[(ia-1)*WIDTH])))
+          src = &a[(--ia)*WIDTH];
+        else src = &b[(--ib)*WIDTH];
+        if (src != &b[m*WIDTH]) memcpy(&b[m*WIDTH],src,WIDTH*sizeof(double));
+      }
+    }
+  }
+}
+
+}
+
+#endif
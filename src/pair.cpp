@@ -30,6 +30,7 @@
 #include "comm.h"
 #include "force.h"
 #include "kspace.h"
+#include "compute.h"
 #include "update.h"
 #include "accelerator_cuda.h"
 #include "suffix.h"
@@ -84,6 +85,9 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
   eatom = NULL;
   vatom = NULL;
 
+  ntally = 0;
+  tallylist = NULL;
+
   datamask = ALL_MASK;
   datamask_ext = ALL_MASK;
 }
@@ -94,6 +98,55 @@ Pair::~Pair()
 {
   memory->destroy(eatom);
   memory->destroy(vatom);
+  memory->sfree(tallylist);
+}
+
+/* ----------------------------------------------------------------------
+   register a compute to be called back from ev_setup() and ev_tally()
+   ok to call more than once for the same compute
+   pair_hybrid also registers the compute with its sub-styles
+------------------------------------------------------------------------- */
+
+void Pair::add_tally_callback(Compute *ptr)
+{
+  if (suffix_flag & (Suffix::GPU | Suffix::CUDA | Suffix::OMP))
+    error->all(FLERR,"Tally compute is not supported by accelerated pair styles");
+
+  // styles that take a single pair_coeff * * are many-body potentials,
+  //   some of which tally their virial only when per-atom virial is needed
+
+  if (one_coeff)
+    error->all(FLERR,"Tally compute is not supported by many-body pair styles");
+
+  for (int i = 0; i < ntally; i++)
+    if (tallylist[i] == ptr) return;
+
+  tallylist = (Compute **)
+    memory->srealloc(tallylist,(ntally+1)*sizeof(Compute *),"pair:tallylist");
+  tallylist[ntally++] = ptr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Pair::del_tally_callback(Compute *ptr)
+{
+  int i;
+  for (i = 0; i < ntally; i++)
+    if (tallylist[i] == ptr) break;
+  if (i == ntally) return;
+
+  for (; i < ntally-1; i++) tallylist[i] = tallylist[i+1];
+  ntally--;
+}
+
+/* ----------------------------------------------------------------------
+   registered computes only receive interactions tallied by ev_tally()
+   called from the other tally routines if any compute is registered
+------------------------------------------------------------------------- */
+
+void Pair::tally_unsupported()
+{
+  error->one(FLERR,"Pair style does not support tally computes");
 }
 
 /* ----------------------------------------------------------------------
@@ -582,6 +635,12 @@ void Pair::ev_setup(int eflag, int vflag)
     if (vflag_either == 0 && eflag_either == 0) evflag = 0;
   } else vflag_fdotr = 0;
 
+  // reset tally computes once per force evaluation
+  // sub-styles of pair_hybrid also call ev_setup(), so only the top level
+
+  if (ntally && this == force->pair)
+    for (i = 0; i < ntally; i++) tallylist[i]->pair_setup_callback(eflag,vflag);
+
   if (lmp->cuda) lmp->cuda->evsetup_eatom_vatom(eflag_atom,vflag_atom);
 }
 
@@ -696,6 +755,11 @@ void Pair::ev_tally(int i, int j, int nlocal, int newton_pair,
       }
     }
   }
+
+  if (ntally)
+    for (int k = 0; k < ntally; k++)
+      tallylist[k]->pair_tally_callback(i,j,nlocal,newton_pair,
+                                        evdwl,ecoul,fpair,delx,dely,delz);
 }
 
 /* ----------------------------------------------------------------------
@@ -708,6 +772,8 @@ void Pair::ev_tally_full(int i, double evdwl, double ecoul, double fpair,
 {
   double v[6];
 
+  if (ntally) tally_unsupported();
+
   if (eflag_either) {
     if (eflag_global) {
       eng_vdwl += 0.5*evdwl;
@@ -756,6 +822,8 @@ void Pair::ev_tally_xyz(int i, int j, int nlocal, int newton_pair,
 {
   double evdwlhalf,ecoulhalf,epairhalf,v[6];
 
+  if (ntally) tally_unsupported();
+
   if (eflag_either) {
     if (eflag_global) {
       if (newton_pair) {
@@ -850,6 +918,8 @@ void Pair::ev_tally_xyz_full(int i, double evdwl, double ecoul,
 {
   double evdwlhalf,ecoulhalf,epairhalf,v[6];
 
+  if (ntally) tally_unsupported();
+
   if (eflag_either) {
     if (eflag_global) {
       evdwlhalf = 0.5*evdwl;
@@ -902,6 +972,8 @@ void Pair::ev_tally3(int i, int j, int k, double evdwl, double ecoul,
 {
   double epairthird,v[6];
 
+  if (ntally) tally_unsupported();
+
   if (eflag_either) {
     if (eflag_global) {
       eng_vdwl += evdwl;
@@ -959,6 +1031,8 @@ void Pair::ev_tally4(int i, int j, int k, int m, double evdwl,
 {
   double epairfourth,v[6];
 
+  if (ntally) tally_unsupported();
+
   if (eflag_either) {
     if (eflag_global) eng_vdwl += evdwl;
     if (eflag_atom) {
@@ -1004,6 +1078,8 @@ void Pair::ev_tally_tip4p(int key, int *list, double *v,
 {
   int i,j;
 
+  if (ntally) tally_unsupported();
+
   if (eflag_either) {
     if (eflag_global) eng_coul += ecoul;
     if (eflag_atom) {
@@ -1085,6 +1161,8 @@ void Pair::v_tally(int i, double *fi, double *deli)
 {
   double v[6];
 
+  if (ntally) tally_unsupported();
+
   v[0] = 0.5*deli[0]*fi[0];
   v[1] = 0.5*deli[1]*fi[1];
   v[2] = 0.5*deli[2]*fi[2];
@@ -1106,6 +1184,8 @@ void Pair::v_tally2(int i, int j, double fpair, double *drij)
 {
   double v[6];
 
+  if (ntally) tally_unsupported();
+
   v[0] = 0.5 * drij[0]*drij[0]*fpair;
   v[1] = 0.5 * drij[1]*drij[1]*fpair;
   v[2] = 0.5 * drij[2]*drij[2]*fpair;
@@ -1129,6 +1209,8 @@ void Pair::v_tally3(int i, int j, int k,
 {
   double v[6];
 
+  if (ntally) tally_unsupported();
+
   v[0] = THIRD * (drik[0]*fi[0] + drjk[0]*fj[0]);
   v[1] = THIRD * (drik[1]*fi[1] + drjk[1]*fj[1]);
   v[2] = THIRD * (drik[2]*fi[2] + drjk[2]*fj[2]);
@@ -1155,6 +1237,8 @@ void Pair::v_tally4(int i, int j, int k, int m,
 {
   double v[6];
 
+  if (ntally) tally_unsupported();
+
   v[0] = 0.25 * (drim[0]*fi[0] + drjm[0]*fj[0] + drkm[0]*fk[0]);
   v[1] = 0.25 * (drim[1]*fi[1] + drjm[1]*fj[1] + drkm[1]*fk[1]);
   v[2] = 0.25 * (drim[2]*fi[2] + drjm[2]*fj[2] + drkm[2]*fk[2]);
@@ -1183,6 +1267,8 @@ void Pair::v_tally_tensor(int i, int j, int nlocal, int newton_pair,
 {
   double v[6];
 
+  if (ntally) tally_unsupported();
+
   v[0] = vxx;
   v[1] = vyy;
   v[2] = vzz;
@@ -103,6 +103,11 @@ class Pair : protected Pointers {
   virtual void modify_params(int, char **);
   void compute_dummy(int, int);
 
+  // computes which are called back from ev_setup() and ev_tally()
+
+  virtual void add_tally_callback(class Compute *);
+  virtual void del_tally_callback(class Compute *);
+
   // need to be public, so can be called by pair_style reaxc
 
   void v_tally(int, double *, double *);
@@ -182,6 +187,10 @@ class Pair : protected Pointers {
   int vflag_fdotr;
   int maxeatom,maxvatom;
 
+  int ntally;                          // # of computes called back on tally
+  class Compute **tallylist;           // list of those computes
+  void tally_unsupported();
+
   virtual void ev_setup(int, int);
   void ev_unset();
   void ev_tally_full(int, double, double, double, double, double, double);
@@ -283,4 +292,20 @@ E: Too few bits for lookup table
 Table size specified via pair_modify command does not work with your
 machine's floating point representation.
 
+E: Tally compute is not supported by accelerated pair styles
+
+Accelerated pair styles tally energy and virial in their own
+routines, which do not call back to the compute.
+
+E: Tally compute is not supported by many-body pair styles
+
+Many-body pair styles do not pass all their interactions to
+Pair::ev_tally().
+
+E: Pair style does not support tally computes
+
+Computes like heat/flux/tally only receive the pairwise interactions
+tallied by Pair::ev_tally().  This pair style also tallies energy or
+virial in other ways, e.g. many-body or TIP4P terms.
+
 */
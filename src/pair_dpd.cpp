@@ -18,6 +18,7 @@
 #include "math.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_dpd.h"
 #include "atom.h"
 #include "atom_vec.h"
@@ -27,6 +28,7 @@
 #include "neighbor.h"
 #include "neigh_list.h"
 #include "random_mars.h"
+#include "random_philox.h"
 #include "memory.h"
 #include "error.h"
 
@@ -39,6 +41,7 @@ using namespace LAMMPS_NS;
 PairDPD::PairDPD(LAMMPS *lmp) : Pair(lmp)
 {
   random = NULL;
+  rngstyle = MARS;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -80,6 +83,9 @@ void PairDPD::compute(int eflag, int vflag)
   double *special_lj = force->special_lj;
   int newton_pair = force->newton_pair;
   double dtinvsqrt = 1.0/sqrt(update->dt);
+  int *tag = atom->tag;
+  bigint ntimestep = update->ntimestep;
+  RanPhilox philox(seed);
 
   inum = list->inum;
   ilist = list->ilist;
@@ -120,7 +126,11 @@ void PairDPD::compute(int eflag, int vflag)
         delvz = vztmp - v[j][2];
         dot = delx*delvx + dely*delvy + delz*delvz;
         wd = 1.0 - r/cut[itype][jtype];
-        randnum = random->gaussian();
+        if (rngstyle == PHILOX) {
+          if (tag[i] < tag[j]) philox.reset(tag[i],tag[j],ntimestep);
+          else philox.reset(tag[j],tag[i],ntimestep);
+          randnum = philox.gaussian();
+        } else randnum = random->gaussian();
 
         // conservative force = a0 * wd
         // drag force = -gamma * wd^2 * (delx dot delv) / r
@@ -185,12 +195,21 @@ void PairDPD::allocate()
 
 void PairDPD::settings(int narg, char **arg)
 {
-  if (narg != 3) error->all(FLERR,"Illegal pair_style command");
+  if (narg != 3 && narg != 5) error->all(FLERR,"Illegal pair_style command");
 
   temperature = force->numeric(arg[0]);
   cut_global = force->numeric(arg[1]);
   seed = force->inumeric(arg[2]);
 
+  rngstyle = MARS;
+  if (narg == 5) {
+    if (strcmp(arg[3],"rng") != 0)
+      error->all(FLERR,"Illegal pair_style command");
+    if (strcmp(arg[4],"mars") == 0) rngstyle = MARS;
+    else if (strcmp(arg[4],"philox") == 0) rngstyle = PHILOX;
+    else error->all(FLERR,"Illegal pair_style command");
+  }
+
   // initialize Marsaglia RNG with processor-unique seed
 
   if (seed <= 0) error->all(FLERR,"Illegal pair_style command");
@@ -248,12 +267,15 @@ void PairDPD::init_style()
 {
   if (comm->ghost_velocity == 0)
     error->all(FLERR,"Pair dpd requires ghost atoms store velocity");
+  if (rngstyle == PHILOX && atom->tag_enable == 0)
+    error->all(FLERR,"Pair dpd rng philox requires atom IDs");
 
   // if newton off, forces between atoms ij will be double computed
-  // using different random numbers
+  // using different random numbers, unless they are keyed by the pair
 
-  if (force->newton_pair == 0 && comm->me == 0) error->warning(FLERR,
-      "Pair dpd needs newton pair on for momentum conservation");
+  if (force->newton_pair == 0 && rngstyle == MARS && comm->me == 0)
+    error->warning(FLERR,
+                   "Pair dpd needs newton pair on for momentum conservation");
 
   neighbor->request(this);
 }
@@ -278,6 +300,7 @@ double PairDPD::init_one(int i, int j)
 
 /* ----------------------------------------------------------------------
    proc 0 writes to restart file
+   rngstyle is not written, so the file layout is unchanged
 ------------------------------------------------------------------------- */
 
 void PairDPD::write_restart(FILE *fp)
@@ -356,7 +379,9 @@ void PairDPD::read_restart_settings(FILE *fp)
 
   // initialize Marsaglia RNG with processor-unique seed
   // same seed that pair_style command initially specified
+  // rngstyle is not stored, a restarted run uses the default
 
+  rngstyle = MARS;
   if (random) delete random;
   random = new RanMars(lmp,seed + comm->me);
 }
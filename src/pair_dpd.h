@@ -40,8 +40,10 @@ class PairDPD : public Pair {
   double single(int, int, int, int, double, double, double, double &);
 
  protected:
+  enum{MARS,PHILOX};
+
   double cut_global,temperature;
-  int seed;
+  int seed,rngstyle;
   double **cut;
   double **a0,**gamma;
   double **sigma;
@@ -67,6 +69,11 @@ E: Incorrect args for pair coefficients
 
 Self-explanatory.  Check the input script or data file.
 
+E: Pair dpd rng philox requires atom IDs
+
+The counter-based random number generator is keyed by the IDs of the
+two atoms in each pair, so atoms must have IDs.
+
 E: Pair dpd requires ghost atoms store velocity
 
 Use the communicate vel yes command to enable this.
@@ -12,6 +12,7 @@
 ------------------------------------------------------------------------- */
 
 #include "math.h"
+#include "string.h"
 #include "pair_dpd_tstat.h"
 #include "atom.h"
 #include "update.h"
@@ -19,6 +20,7 @@
 #include "neigh_list.h"
 #include "comm.h"
 #include "random_mars.h"
+#include "random_philox.h"
 #include "error.h"
 
 using namespace LAMMPS_NS;
@@ -65,6 +67,9 @@ void PairDPDTstat::compute(int eflag, int vflag)
   double *special_lj = force->special_lj;
   int newton_pair = force->newton_pair;
   double dtinvsqrt = 1.0/sqrt(update->dt);
+  int *tag = atom->tag;
+  bigint ntimestep = update->ntimestep;
+  RanPhilox philox(seed);
 
   inum = list->inum;
   ilist = list->ilist;
@@ -105,7 +110,11 @@ void PairDPDTstat::compute(int eflag, int vflag)
         delvz = vztmp - v[j][2];
         dot = delx*delvx + dely*delvy + delz*delvz;
         wd = 1.0 - r/cut[itype][jtype];
-        randnum = random->gaussian();
+        if (rngstyle == PHILOX) {
+          if (tag[i] < tag[j]) philox.reset(tag[i],tag[j],ntimestep);
+          else philox.reset(tag[j],tag[i],ntimestep);
+          randnum = philox.gaussian();
+        } else randnum = random->gaussian();
 
         // drag force = -gamma * wd^2 * (delx dot delv) / r
         // random force = sigma * wd * rnd * dtinvsqrt;
@@ -138,13 +147,22 @@ void PairDPDTstat::compute(int eflag, int vflag)
 
 void PairDPDTstat::settings(int narg, char **arg)
 {
-  if (narg != 4) error->all(FLERR,"Illegal pair_style command");
+  if (narg != 4 && narg != 6) error->all(FLERR,"Illegal pair_style command");
 
   t_start = force->numeric(arg[0]);
   t_stop = force->numeric(arg[1]);
   cut_global = force->numeric(arg[2]);
   seed = force->inumeric(arg[3]);
 
+  rngstyle = MARS;
+  if (narg == 6) {
+    if (strcmp(arg[4],"rng") != 0)
+      error->all(FLERR,"Illegal pair_style command");
+    if (strcmp(arg[5],"mars") == 0) rngstyle = MARS;
+    else if (strcmp(arg[5],"philox") == 0) rngstyle = PHILOX;
+    else error->all(FLERR,"Illegal pair_style command");
+  }
+
   temperature = t_start;
 
   // initialize Marsaglia RNG with processor-unique seed
@@ -198,6 +216,7 @@ void PairDPDTstat::coeff(int narg, char **arg)
 
 /* ----------------------------------------------------------------------
    proc 0 writes to restart file
+   rngstyle is not written, so the file layout is unchanged
 ------------------------------------------------------------------------- */
 
 void PairDPDTstat::write_restart_settings(FILE *fp)
@@ -230,7 +249,9 @@ void PairDPDTstat::read_restart_settings(FILE *fp)
 
   // initialize Marsaglia RNG with processor-unique seed
   // same seed that pair_style command initially specified
+  // rngstyle is not stored, a restarted run uses the default
 
+  rngstyle = MARS;
   if (random) delete random;
   random = new RanMars(lmp,seed + comm->me);
 }
@@ -103,6 +103,7 @@ void PairHybrid::compute(int eflag, int vflag)
     if (eflag_global) {
       eng_vdwl += styles[m]->eng_vdwl;
       eng_coul += styles[m]->eng_coul;
+      eng_pol += styles[m]->eng_pol;
     }
     if (vflag_global) {
       for (n = 0; n < 6; n++) virial[n] += styles[m]->virial[n];
@@ -703,6 +704,25 @@ void PairHybrid::modify_params(int narg, char **arg)
   for (int m = 0; m < nstyles; m++) styles[m]->modify_params(narg,arg);
 }
 
+/* ----------------------------------------------------------------------
+   register compute with PairHybrid and each sub-style
+   sub-styles do the tallying, PairHybrid calls the setup callback
+------------------------------------------------------------------------- */
+
+void PairHybrid::add_tally_callback(Compute *ptr)
+{
+  Pair::add_tally_callback(ptr);
+  for (int m = 0; m < nstyles; m++) styles[m]->add_tally_callback(ptr);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairHybrid::del_tally_callback(Compute *ptr)
+{
+  Pair::del_tally_callback(ptr);
+  for (int m = 0; m < nstyles; m++) styles[m]->del_tally_callback(ptr);
+}
+
 /* ----------------------------------------------------------------------
    extract a ptr to a particular quantity stored by pair
    pass request thru to sub-styles
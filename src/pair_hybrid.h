@@ -45,6 +45,9 @@ class PairHybrid : public Pair {
   void modify_params(int narg, char **arg);
   double memory_usage();
 
+  void add_tally_callback(class Compute *);
+  void del_tally_callback(class Compute *);
+
   void compute_inner();
   void compute_middle();
   void compute_outer(int, int);
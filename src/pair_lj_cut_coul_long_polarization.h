@@ -20,11 +20,11 @@ PairStyle(lj/cut/coul/long/polarization,PairLJCutCoulLongPolarization)
 #ifndef LMP_PAIR_LJ_CUT_COUL_LONG_POLARIZATION_H
 #define LMP_PAIR_LJ_CUT_COUL_LONG_POLARIZATION_H
 
-#include "pair.h"
+#include "pair_polarization.h"
 
 namespace LAMMPS_NS {
 
-class PairLJCutCoulLongPolarization : public Pair {
+class PairLJCutCoulLongPolarization : public PairPolarization {
  public:
   PairLJCutCoulLongPolarization(class LAMMPS *);
   virtual ~PairLJCutCoulLongPolarization();
@@ -43,17 +43,10 @@ class PairLJCutCoulLongPolarization : public Pair {
   /*void compute_inner();
   void compute_middle();
   void compute_outer(int, int);*/
-  void *extract(const char *, int &);
-
-  /* polarization stuff */
-  int pack_comm(int, int *, double *,int, int *);
-  void unpack_comm(int, int, double *);
-  /* ------------------ */
 
  protected:
   double cut_lj_global;
   double **cut_lj,**cut_ljsq;
-  double cut_coul,cut_coulsq;
   double **epsilon,**sigma;
   double **lj1,**lj2,**lj3,**lj4,**offset;
   double *cut_respa;
@@ -67,28 +60,6 @@ class PairLJCutCoulLongPolarization : public Pair {
   void allocate();
   void init_tables();
   void free_tables();
-
-  /* polarization stuff */
-  double **ef_induced;
-  double **dipole_field_matrix;
-  double **mu_induced_new,**mu_induced_old;
-  double *rank_metric;
-  double rmin;
-  int *ranked_array;
-  int nlocal_old;
-  int iterations_max;
-  void build_dipole_field_matrix();
-  int DipoleSolverIterative();
-  int damping_type;
-  int zodid;
-  int debug;
-  double polar_damp;
-  double polar_precision;
-  int fixed_iteration;
-  int polar_gs,polar_gs_ranked;
-  int use_previous;
-  double polar_gamma;
-  /* ------------------ */
 };
 
 }
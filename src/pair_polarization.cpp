@@ -0,0 +1,1681 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   Contributing author: Adam Hogan (USF)
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "pair_polarization.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+#include "mpi.h"
+#include "float.h"
+#include "domain.h"
+#include "group.h"
+#include "modify.h"
+#include "fix_efield.h"
+#include "polar_tree.h"
+
+using namespace LAMMPS_NS;
+
+enum{DAMPING_EXPONENTIAL,DAMPING_NONE};
+
+/* ---------------------------------------------------------------------- */
+
+PairPolarization::PairPolarization(LAMMPS *lmp) : Pair(lmp)
+{
+  /* check for possible errors */
+  if (atom->static_polarizability_flag==0) error->all(FLERR,"Pair style requires atom attribute polarizability");
+
+  single_enable = 0;
+  respa_enable = 0;
+
+  /* static polarizabilities, static field and dipoles of ghost atoms */
+  comm_forward = 7;
+
+  /* set defaults */
+  iterations_max = 50;
+  damping_type = DAMPING_NONE;
+  polar_damp = 2.1304;
+  zodid = 0;
+  polar_precision = 0.00000000001;
+  fixed_iteration = 0;
+
+  polar_gs = 0;
+  polar_gs_ranked = 1;
+  polar_gamma = 1.03;
+
+  use_previous = 0;
+
+  frozen_group = -1;
+
+  tree_flag = 0;
+  tree_order = 2;
+  tree_theta = 0.3;
+
+  debug = 0;
+  /* end defaults */
+
+  nfix_efield = 0;
+  fix_efield = NULL;
+  tree = NULL;
+
+  /* iterations and timings of the dipole phases for compute pair */
+  nextra = 6;
+  pvector = new double[nextra];
+  for (int m = 0; m < nextra; m++) pvector[m] = 0.0;
+
+  /* create arrays */
+  int nlocal = atom->nlocal;
+  memory->create(ef_induced,nlocal,3,"pair:ef_induced");
+  memory->create(mu_induced_new,nlocal,3,"pair:mu_induced_new");
+  memory->create(mu_induced_old,nlocal,3,"pair:mu_induced_old");
+  memory->create(ranked_array,nlocal,"pair:ranked_array");
+  memory->create(rank_metric,nlocal,"pair:rank_metric");
+  memory->create(ef_external,nlocal,3,"pair:ef_external");
+  memory->create(polar_list,nlocal,"pair:polar_list");
+  nlocal_old = nlocal;
+
+  /* the dipole field tensor is sized by the polarizable atoms only */
+  dipole_field_matrix = NULL;
+  npolar = npolar_max = 0;
+
+  /* per-atom caches of the frozen group, kept when nlocal grows */
+  frozen_groupbit = 0;
+  for (int m = 0; m < 6; m++) frozen_h[m] = 0.0;
+  nfrozen = nfrozen_all = nlocal_frozen = nmobile = 0;
+  frozen_tensor_valid = frozen_field_valid = 0;
+  frozen_tag = NULL;
+  frozen_save = NULL;
+  ef_frozen = NULL;
+  mobile_list = NULL;
+  memory->grow(frozen_tag,nlocal,"pair:frozen_tag");
+  memory->grow(frozen_save,nlocal,5,"pair:frozen_save");
+  memory->grow(ef_frozen,nlocal,3,"pair:ef_frozen");
+  memory->create(mobile_list,nlocal,"pair:mobile_list");
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairPolarization::~PairPolarization()
+{
+  if (allocated) {
+    memory->destroy(setflag);
+    memory->destroy(cutsq);
+  }
+  /* destroy all the arrays! */
+  memory->destroy(ef_induced);
+  memory->destroy(mu_induced_new);
+  memory->destroy(mu_induced_old);
+  memory->destroy(dipole_field_matrix);
+  memory->destroy(ranked_array);
+  memory->destroy(rank_metric);
+  memory->destroy(ef_external);
+  memory->destroy(polar_list);
+  memory->destroy(frozen_tag);
+  memory->destroy(frozen_save);
+  memory->destroy(ef_frozen);
+  memory->destroy(mobile_list);
+  delete [] fix_efield;
+  delete tree;
+  delete [] pvector;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairPolarization::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = vflag_fdotr = 0;
+
+  polar_compute(eflag);
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ----------------------------------------------------------------------
+   static field, self-consistent induced dipoles and dipole forces
+   between all pairs of owned atoms, sets eng_pol
+   called by compute() of this style and of styles derived from it
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_compute(int eflag)
+{
+  int nlocal = atom->nlocal;
+  int nghost = atom->nghost;
+  int ntotal = nlocal + nghost;
+  int i;
+
+  /* reallocate arrays if number of atoms grew */
+  if (nlocal > nlocal_old)
+  {
+    memory->destroy(ef_induced);
+    memory->create(ef_induced,nlocal,3,"pair:ef_induced");
+    memory->destroy(mu_induced_new);
+    memory->create(mu_induced_new,nlocal,3,"pair:mu_induced_new");
+    memory->destroy(mu_induced_old);
+    memory->create(mu_induced_old,nlocal,3,"pair:mu_induced_old");
+    memory->destroy(ranked_array);
+    memory->create(ranked_array,nlocal,"pair:ranked_array");
+    memory->destroy(rank_metric);
+    memory->create(rank_metric,nlocal,"pair:rank_metric");
+    memory->destroy(ef_external);
+    memory->create(ef_external,nlocal,3,"pair:ef_external");
+    memory->destroy(polar_list);
+    memory->create(polar_list,nlocal,"pair:polar_list");
+    memory->grow(frozen_tag,nlocal,"pair:frozen_tag");
+    memory->grow(frozen_save,nlocal,5,"pair:frozen_save");
+    memory->grow(ef_frozen,nlocal,3,"pair:ef_frozen");
+    memory->destroy(mobile_list);
+    memory->create(mobile_list,nlocal,"pair:mobile_list");
+    nlocal_old = nlocal;
+  }
+  double **ef_static = atom->ef_static;
+
+  int j,ii;
+  double r;
+
+  double **x = atom->x;
+  double qqrd2e = force->qqrd2e;
+
+  double *static_polarizability = atom->static_polarizability;
+  int *molecule = atom->molecule;
+  double **mu_induced = atom->mu_induced;
+
+  /* check if the cached blocks of the frozen group are still current */
+  if (frozen_group >= 0) check_frozen();
+
+  /* index the polarizable atoms, the tensor, the iterations and the dipole
+     forces only run over them, the other atoms carry no dipole
+     frozen atoms come first so their block of the tensor can be kept */
+  npolar = 0;
+  for (i = 0; i < nlocal; i++)
+  {
+    if (static_polarizability[i] == 0.0)
+    {
+      mu_induced[i][0] = mu_induced[i][1] = mu_induced[i][2] = 0.0;
+      ef_induced[i][0] = ef_induced[i][1] = ef_induced[i][2] = 0.0;
+    }
+    else if (frozen_group < 0 || atom->mask[i] & frozen_groupbit)
+      polar_list[npolar++] = i;
+  }
+  nfrozen = (frozen_group >= 0) ? npolar : 0;
+  if (frozen_group >= 0)
+  {
+    for (i = 0; i < nlocal; i++)
+      if (static_polarizability[i] != 0.0 && !(atom->mask[i] & frozen_groupbit))
+        polar_list[npolar++] = i;
+  }
+  /* the tree does not use the tensor */
+  if (npolar > npolar_max && !tree_flag)
+  {
+    /* copy a valid frozen block into the larger tensor */
+    double **matrix_old = dipole_field_matrix;
+    dipole_field_matrix = NULL;
+    memory->create(dipole_field_matrix,3*npolar,3*npolar,"pair:dipole_field_matrix");
+    if (frozen_tensor_valid)
+    {
+      for (i = 0; i < 3*nfrozen; i++)
+        for (j = 0; j < 3*nfrozen; j++)
+          dipole_field_matrix[i][j] = matrix_old[i][j];
+    }
+    memory->destroy(matrix_old);
+    npolar_max = npolar;
+  }
+
+  double time_start = MPI_Wtime();
+
+  /* sort the dipoles most likey to change if using polar_gs_ranked */
+  if (polar_gs_ranked) {
+    /* communicate static polarizabilities */
+    comm->forward_comm_pair(this);
+    MPI_Barrier(world);
+    rmin = 1000.0;
+    for (ii=0;ii<npolar;ii++)
+    {
+      i = polar_list[ii];
+      for (j=0;j<ntotal;j++)
+      {
+        if(i != j) {
+          r = sqrt(pow(x[i][0]-x[j][0],2)+pow(x[i][1]-x[j][1],2)+pow(x[i][2]-x[j][2],2));
+          if (static_polarizability[i]>0&&static_polarizability[j]>0&&rmin>r&&((molecule[i]!=molecule[j])||molecule[i]==0))
+          {
+            rmin = r;
+          }
+        }
+      }
+    }
+    for (i=0;i<nlocal;i++)
+    {
+      rank_metric[i] = 0;
+    }
+    for (ii=0;ii<npolar;ii++)
+    {
+      i = polar_list[ii];
+      for (j=0;j<ntotal;j++)
+      {
+        if(i != j) {
+          r = sqrt(pow(x[i][0]-x[j][0],2)+pow(x[i][1]-x[j][1],2)+pow(x[i][2]-x[j][2],2));
+          if (rmin*1.5>r&&((molecule[i]!=molecule[j])||molecule[i]==0))
+          {
+            rank_metric[i]+=static_polarizability[i]*static_polarizability[j];
+          }
+        }
+      }
+    }
+  }
+
+  double time_field = MPI_Wtime();
+
+  /* static electric field of the charges */
+  if (tree_flag) static_field_tree();
+  else static_field_wolf();
+
+  /* add any applied external field so it polarizes the dipoles self-consistently,
+     fix efield works in force/charge units so bring it to the charge/distance^2 units used above */
+  if (nfix_efield)
+  {
+    for (i = 0; i < nlocal; i++)
+    {
+      ef_external[i][0] = 0;
+      ef_external[i][1] = 0;
+      ef_external[i][2] = 0;
+    }
+    for (int ifix = 0; ifix < nfix_efield; ifix++)
+      fix_efield[ifix]->add_field(ef_external,1.0/qqrd2e);
+    for (i = 0; i < nlocal; i++)
+    {
+      ef_static[i][0] += ef_external[i][0];
+      ef_static[i][1] += ef_external[i][1];
+      ef_static[i][2] += ef_external[i][2];
+    }
+  }
+
+  int iterations;
+
+  double elementary_charge_to_sqrt_energy_length = sqrt(qqrd2e);
+
+  /* set the static electric field and first guess to alpha*E */
+  for (i = 0; i < nlocal; i++) {
+    /* it is more convenient to work in gaussian-like units for charges and electric fields */
+    ef_static[i][0] = ef_static[i][0]*elementary_charge_to_sqrt_energy_length;
+    ef_static[i][1] = ef_static[i][1]*elementary_charge_to_sqrt_energy_length;
+    ef_static[i][2] = ef_static[i][2]*elementary_charge_to_sqrt_energy_length;
+    /* don't reset the induced dipoles if use_previous is on */
+    if (!use_previous)
+    {
+      /* otherwise set it to alpha*E */
+      mu_induced[i][0] = static_polarizability[i]*ef_static[i][0];
+      mu_induced[i][1] = static_polarizability[i]*ef_static[i][1];
+      mu_induced[i][2] = static_polarizability[i]*ef_static[i][2];
+      mu_induced[i][0] *= polar_gamma;
+      mu_induced[i][1] *= polar_gamma;
+      mu_induced[i][2] *= polar_gamma;
+    }
+  }
+
+  double time_solve = MPI_Wtime();
+
+  /* solve for the induced dipoles */
+  if (zodid) iterations = 0;
+  else if (tree_flag) iterations = DipoleSolverTree();
+  else iterations = DipoleSolverIterative();
+
+  double time_forces = MPI_Wtime();
+
+  /* dipole forces */
+  double u_polar = 0.0;
+  double u_polar_self = 0.0;
+  double u_polar_ef = 0.0;
+  double u_polar_dd = 0.0;
+
+  if (tree_flag) polar_forces_tree(eflag,u_polar_self,u_polar_ef,u_polar_dd);
+  else polar_forces(eflag,u_polar_self,u_polar_ef,u_polar_dd);
+
+  /* iterations of this step, then totals since the run was set up */
+  double time_end = MPI_Wtime();
+  pvector[0] = iterations;
+  pvector[1] += iterations;
+  pvector[2] += time_solve - time_field;
+  pvector[3] += time_forces - time_solve;
+  pvector[4] += time_end - time_forces;
+  pvector[5] += time_field - time_start;
+
+  u_polar = u_polar_self + u_polar_ef + u_polar_dd;
+  eng_pol = u_polar;
+
+  /* solver diagnostics, energies are in energy units */
+  if (debug)
+  {
+    double u_local[4],u_all[4];
+    u_local[0] = u_polar_self;
+    u_local[1] = u_polar_ef;
+    u_local[2] = u_polar_dd;
+    u_local[3] = u_polar;
+    MPI_Allreduce(u_local,u_all,4,MPI_DOUBLE,MPI_SUM,world);
+    if (comm->me == 0)
+    {
+      if (screen)
+        fprintf(screen,"Polarization: %d iterations, self %g ef %g dd %g "
+                "total %g\n",iterations,u_all[0],u_all[1],u_all[2],u_all[3]);
+      if (logfile)
+        fprintf(logfile,"Polarization: %d iterations, self %g ef %g dd %g "
+                "total %g\n",iterations,u_all[0],u_all[1],u_all[2],u_all[3]);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   forces and energies of the induced dipoles from all pairs of owned
+   atoms with at least one dipole
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_forces(int eflag, double &u_polar_self,
+                                    double &u_polar_ef, double &u_polar_dd)
+{
+  int i,j,ii;
+  double qtmp,xtmp,ytmp,ztmp,delx,dely,delz;
+  double r,rinv,r2inv,rsq,ef_temp,dvdrr;
+  double xjimage[3];
+
+  double **x = atom->x;
+  double **f = atom->f;
+  double *q = atom->q;
+  int *molecule = atom->molecule;
+  double *static_polarizability = atom->static_polarizability;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  double f_shift = -1.0/(cut_coul*cut_coul);
+  double elementary_charge_to_sqrt_energy_length = sqrt(force->qqrd2e);
+
+  /* variables for dipole forces */
+  double forcecoulx,forcecouly,forcecoulz;
+  double r3inv,r5inv,r7inv,pdotp,pidotr,pjdotr,pre1,pre2,pre3,pre4,pre5;
+  double ef_0,ef_1,ef_2;
+  double **mu = atom->mu_induced;
+  double xsq,ysq,zsq,common_factor;
+
+  double term_1,term_2,term_3;
+
+  for (ii = 0; ii < npolar; ii++) {
+    i = polar_list[ii];
+    qtmp = q[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+
+    /* self interaction energy */
+    if (eflag&&static_polarizability[i]!=0.0)
+      u_polar_self += 0.5 * (mu[i][0]*mu[i][0]+mu[i][1]*mu[i][1]+mu[i][2]*mu[i][2])/static_polarizability[i];
+
+    /* induced dipole in the applied field, polar_init() only allows constant and
+       equal-style fields, which are uniform in space, so there is no mu.grad(E) force */
+    if (eflag&&nfix_efield)
+      u_polar_ef -= (mu[i][0]*ef_external[i][0]+mu[i][1]*ef_external[i][1]+mu[i][2]*ef_external[i][2])*elementary_charge_to_sqrt_energy_length;
+
+    /* pairs with a dipole on i, pairs of two dipoles are done once for i < j */
+    for (j = 0; j < nlocal; j++) {
+      if (j == i || (j < i && static_polarizability[j] != 0.0)) continue;
+
+      /* using minimum image again to be consistent */
+      domain->closest_image(x[i],x[j],xjimage);
+      delx = xtmp - xjimage[0];
+      dely = ytmp - xjimage[1];
+      delz = ztmp - xjimage[2];
+      xsq = delx*delx;
+      ysq = dely*dely;
+      zsq = delz*delz;
+      rsq = xsq + ysq + zsq;
+
+      r2inv = 1.0/rsq;
+      rinv = sqrt(r2inv);
+      r = 1.0/rinv;
+      r3inv = r2inv*rinv;
+
+      forcecoulx = forcecouly = forcecoulz = 0.0;
+
+      if (rsq < cut_coulsq)
+      {
+
+        if ( (molecule[i]!=molecule[j])||molecule[i]==0 )
+        {
+          /* using wolf again */
+          dvdrr = 1.0/rsq + f_shift;
+          ef_temp = dvdrr*1.0/r*elementary_charge_to_sqrt_energy_length;
+
+          /* dipole on i, charge on j interaction */
+          if (static_polarizability[i]!=0.0&&q[j]!=0.0)
+          {
+            common_factor = q[j]*elementary_charge_to_sqrt_energy_length*r3inv;
+            forcecoulx += common_factor * (mu[i][0] * ((-2.0*xsq+ysq+zsq)*r2inv + f_shift*(ysq+zsq)) + \
+                                           mu[i][1] * (-3.0*delx*dely*r2inv - f_shift*delx*dely) + \
+                                           mu[i][2] * (-3.0*delx*delz*r2inv - f_shift*delx*delz));
+            forcecouly += common_factor * (mu[i][0] * (-3.0*delx*dely*r2inv - f_shift*delx*dely) + \
+                                           mu[i][1] * ((-2.0*ysq+xsq+zsq)*r2inv + f_shift*(xsq+zsq)) + \
+                                           mu[i][2] * (-3.0*dely*delz*r2inv - f_shift*dely*delz));
+            forcecoulz += common_factor * (mu[i][0] * (-3.0*delx*delz*r2inv - f_shift*delx*delz) + \
+                                           mu[i][1] * (-3.0*dely*delz*r2inv - f_shift*dely*delz) + \
+                                           mu[i][2] * ((-2.0*zsq+xsq+ysq)*r2inv + f_shift*(xsq+ysq)));
+            if (eflag)
+            {
+              ef_0 = ef_temp*q[j]*delx;
+              ef_1 = ef_temp*q[j]*dely;
+              ef_2 = ef_temp*q[j]*delz;
+
+              u_polar_ef -= mu[i][0]*ef_0 + mu[i][1]*ef_1 + mu[i][2]*ef_2;
+            }
+          }
+
+          /* dipole on j, charge on i interaction */
+          if (static_polarizability[j]!=0.0&&qtmp!=0.0)
+          {
+            common_factor = qtmp*elementary_charge_to_sqrt_energy_length*r3inv;
+            forcecoulx -= common_factor * (mu[j][0] * ((-2.0*xsq+ysq+zsq)*r2inv + f_shift*(ysq+zsq)) + \
+                                             mu[j][1] * (-3.0*delx*dely*r2inv - f_shift*delx*dely) + \
+                                             mu[j][2] * (-3.0*delx*delz*r2inv - f_shift*delx*delz));
+            forcecouly -= common_factor * (mu[j][0] * (-3.0*delx*dely*r2inv - f_shift*delx*dely) + \
+                                             mu[j][1] * ((-2.0*ysq+xsq+zsq)*r2inv + f_shift*(xsq+zsq)) + \
+                                             mu[j][2] * (-3.0*dely*delz*r2inv - f_shift*dely*delz));
+            forcecoulz -= common_factor * (mu[j][0] * (-3.0*delx*delz*r2inv - f_shift*delx*delz) + \
+                                             mu[j][1] * (-3.0*dely*delz*r2inv - f_shift*dely*delz) + \
+                                             mu[j][2] * ((-2.0*zsq+xsq+ysq)*r2inv + f_shift*(xsq+ysq)));
+            if (eflag)
+            {
+              ef_0 = ef_temp*qtmp*delx;
+              ef_1 = ef_temp*qtmp*dely;
+              ef_2 = ef_temp*qtmp*delz;
+
+              u_polar_ef += mu[j][0]*ef_0 + mu[j][1]*ef_1 + mu[j][2]*ef_2;
+            }
+          }
+        }
+      }
+
+      /* dipole on i, dipole on j interaction */
+      if (static_polarizability[i]!=0.0 && static_polarizability[j]!=0.0)
+      {
+        /* exponential dipole-dipole damping */
+        if(damping_type == DAMPING_EXPONENTIAL)
+        {
+          r5inv = r3inv*r2inv;
+          r7inv = r5inv*r2inv;
+
+          term_1 = exp(-polar_damp*r);
+          term_2 = 1.0+polar_damp*r+0.5*polar_damp*polar_damp*r*r;
+          term_3 = 1.0+polar_damp*r+0.5*polar_damp*polar_damp*r*r+1.0/6.0*polar_damp*polar_damp*polar_damp*r*r*r;
+
+          pdotp = mu[i][0]*mu[j][0] + mu[i][1]*mu[j][1] + mu[i][2]*mu[j][2];
+          pidotr = mu[i][0]*delx + mu[i][1]*dely + mu[i][2]*delz;
+          pjdotr = mu[j][0]*delx + mu[j][1]*dely + mu[j][2]*delz;
+
+          pre1 = 3.0*r5inv*pdotp*(1.0-term_1*term_2) - 15.0*r7inv*pidotr*pjdotr*(1.0-term_1*term_3);
+          pre2 = 3.0*r5inv*pjdotr*(1.0-term_1*term_3);
+          pre3 = 3.0*r5inv*pidotr*(1.0-term_1*term_3);
+          pre4 = -pdotp*r3inv*(-term_1*(polar_damp*rinv+polar_damp*polar_damp) + term_1*polar_damp*term_2*rinv);
+          pre5 = 3.0*pidotr*pjdotr*r5inv*(-term_1*(polar_damp*rinv+polar_damp*polar_damp+0.5*r*polar_damp*polar_damp*polar_damp)+term_1*polar_damp*term_3*rinv);
+
+          forcecoulx += pre1*delx + pre2*mu[i][0] + pre3*mu[j][0] + pre4*delx + pre5*delx;
+          forcecouly += pre1*dely + pre2*mu[i][1] + pre3*mu[j][1] + pre4*dely + pre5*dely;
+          forcecoulz += pre1*delz + pre2*mu[i][2] + pre3*mu[j][2] + pre4*delz + pre5*delz;
+
+          if (eflag)
+          {
+            u_polar_dd += r3inv*pdotp*(1.0-term_1*term_2) - 3.0*r5inv*pidotr*pjdotr*(1.0-term_1*term_3);
+          }
+        }
+        /* no dipole-dipole damping */
+        else
+        {
+          r5inv = r3inv*r2inv;
+          r7inv = r5inv*r2inv;
+
+          pdotp = mu[i][0]*mu[j][0] + mu[i][1]*mu[j][1] + mu[i][2]*mu[j][2];
+          pidotr = mu[i][0]*delx + mu[i][1]*dely + mu[i][2]*delz;
+          pjdotr = mu[j][0]*delx + mu[j][1]*dely + mu[j][2]*delz;
+
+          pre1 = 3.0*r5inv*pdotp - 15.0*r7inv*pidotr*pjdotr;
+          pre2 = 3.0*r5inv*pjdotr;
+          pre3 = 3.0*r5inv*pidotr;
+
+          forcecoulx += pre1*delx + pre2*mu[i][0] + pre3*mu[j][0];
+          forcecouly += pre1*dely + pre2*mu[i][1] + pre3*mu[j][1];
+          forcecoulz += pre1*delz + pre2*mu[i][2] + pre3*mu[j][2];
+
+          if (eflag)
+          {
+            u_polar_dd += r3inv*pdotp - 3.0*r5inv*pidotr*pjdotr;
+          }
+        }
+      }
+
+      f[i][0] += forcecoulx;
+      f[i][1] += forcecouly;
+      f[i][2] += forcecoulz;
+
+      if (newton_pair || j < nlocal)
+      {
+        f[j][0] -= forcecoulx;
+        f[j][1] -= forcecouly;
+        f[j][2] -= forcecoulz;
+      }
+      if (evflag) ev_tally_xyz(i,j,nlocal,newton_pair,0.0,0.0,forcecoulx,forcecouly,forcecoulz,delx,dely,delz);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   static field from a Wolf-shifted sum over the closest images of the
+   other owned atoms, charges in the same molecule are excluded
+------------------------------------------------------------------------- */
+
+void PairPolarization::static_field_wolf()
+{
+  int i,j;
+  double qtmp,xtmp,ytmp,ztmp,delx,dely,delz,rsq,r;
+  double ef_temp,dvdrr;
+  double xjimage[3];
+
+  double **x = atom->x;
+  double *q = atom->q;
+  int *molecule = atom->molecule;
+  double **ef_static = atom->ef_static;
+  int nlocal = atom->nlocal;
+  double f_shift = -1.0/(cut_coul*cut_coul);
+
+  int *mask = atom->mask;
+  int ii,ni;
+
+  for (i = 0; i < nlocal; i++)
+  {
+    ef_static[i][0] = 0;
+    ef_static[i][1] = 0;
+    ef_static[i][2] = 0;
+  }
+
+  /* field of the frozen charges on the frozen atoms is summed once,
+     afterwards only pairs with a mobile atom are summed */
+  if (frozen_group >= 0)
+  {
+    if (!frozen_field_valid)
+    {
+      for (i = 0; i < nlocal; i++)
+        if (mask[i] & frozen_groupbit) ef_frozen[i][0] = ef_frozen[i][1] = ef_frozen[i][2] = 0.0;
+      for (i = 0; i < nlocal; i++) {
+        if (!(mask[i] & frozen_groupbit)) continue;
+        for (j = i+1; j < nlocal; j++) {
+          if (!(mask[j] & frozen_groupbit)) continue;
+          domain->closest_image(x[i],x[j],xjimage);
+          delx = x[i][0] - xjimage[0];
+          dely = x[i][1] - xjimage[1];
+          delz = x[i][2] - xjimage[2];
+          rsq = delx*delx + dely*dely + delz*delz;
+          if (rsq <= cut_coulsq && ((molecule[i]!=molecule[j])||molecule[i]==0))
+          {
+            r = sqrt(rsq);
+            dvdrr = 1.0/rsq + f_shift;
+            ef_temp = dvdrr*1.0/r;
+            ef_frozen[i][0] += ef_temp*q[j]*delx;
+            ef_frozen[i][1] += ef_temp*q[j]*dely;
+            ef_frozen[i][2] += ef_temp*q[j]*delz;
+            ef_frozen[j][0] -= ef_temp*q[i]*delx;
+            ef_frozen[j][1] -= ef_temp*q[i]*dely;
+            ef_frozen[j][2] -= ef_temp*q[i]*delz;
+          }
+        }
+      }
+      frozen_field_valid = 1;
+    }
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & frozen_groupbit)
+      {
+        ef_static[i][0] = ef_frozen[i][0];
+        ef_static[i][1] = ef_frozen[i][1];
+        ef_static[i][2] = ef_frozen[i][2];
+      }
+  }
+
+  /* calculate static electric field using minimum image
+     with a frozen group the outer loop is over mobile atoms only,
+     pairs of two mobile atoms are done once for i < j */
+  ni = (frozen_group >= 0) ? nmobile : nlocal;
+  for (ii = 0; ii < ni; ii++) {
+    i = (frozen_group >= 0) ? mobile_list[ii] : ii;
+    qtmp = q[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+
+    for (j = (frozen_group >= 0) ? 0 : i+1; j < nlocal; j++) {
+      if (frozen_group >= 0 && (j == i || (j < i && !(mask[j] & frozen_groupbit))))
+        continue;
+      domain->closest_image(x[i],x[j],xjimage);
+      delx = xtmp - xjimage[0];
+      dely = ytmp - xjimage[1];
+      delz = ztmp - xjimage[2];
+      rsq = delx*delx + dely*dely + delz*delz;
+
+      if (rsq <= cut_coulsq)
+      {
+        if ( (molecule[i]!=molecule[j])||molecule[i]==0 )
+        {
+          r = sqrt(rsq);
+
+          /* Use wolf to calculate the electric field (no damping) */
+          dvdrr = 1.0/rsq + f_shift;
+          ef_temp = dvdrr*1.0/r;
+
+          ef_static[i][0] += ef_temp*q[j]*delx;
+          ef_static[i][1] += ef_temp*q[j]*dely;
+          ef_static[i][2] += ef_temp*q[j]*delz;
+          ef_static[j][0] -= ef_temp*qtmp*delx;
+          ef_static[j][1] -= ef_temp*qtmp*dely;
+          ef_static[j][2] -= ef_temp*qtmp*delz;
+        }
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   compare the frozen atoms with their state when the blocks were cached
+   invalidate the cached blocks if any frozen atom was added, removed,
+     moved, reordered or changed its charge or polarizability
+   also build the list of mobile atoms
+------------------------------------------------------------------------- */
+
+void PairPolarization::check_frozen()
+{
+  int *mask = atom->mask;
+  int *tag = atom->tag;
+  double **x = atom->x;
+  double *q = atom->q;
+  double *static_polarizability = atom->static_polarizability;
+  int nlocal = atom->nlocal;
+  double *h = domain->h;
+
+  int i,m,was_frozen;
+  int changed = 0;
+  int n = 0;
+
+  for (m = 0; m < 6; m++)
+    if (h[m] != frozen_h[m]) changed = 1;
+
+  nmobile = 0;
+  for (i = 0; i < nlocal; i++) {
+    was_frozen = (i < nlocal_frozen && frozen_tag[i] >= 0);
+    if (mask[i] & frozen_groupbit) {
+      n++;
+      if (!was_frozen || frozen_tag[i] != tag[i] ||
+          frozen_save[i][0] != x[i][0] || frozen_save[i][1] != x[i][1] ||
+          frozen_save[i][2] != x[i][2] || frozen_save[i][3] != q[i] ||
+          frozen_save[i][4] != static_polarizability[i]) changed = 1;
+    } else {
+      mobile_list[nmobile++] = i;
+      if (was_frozen) changed = 1;
+    }
+  }
+  if (n != nfrozen_all) changed = 1;
+
+  if (!changed) return;
+
+  frozen_tensor_valid = frozen_field_valid = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & frozen_groupbit) frozen_tag[i] = tag[i];
+    else frozen_tag[i] = -1;
+    frozen_save[i][0] = x[i][0];
+    frozen_save[i][1] = x[i][1];
+    frozen_save[i][2] = x[i][2];
+    frozen_save[i][3] = q[i];
+    frozen_save[i][4] = static_polarizability[i];
+  }
+  for (m = 0; m < 6; m++) frozen_h[m] = h[m];
+  nfrozen_all = n;
+  nlocal_frozen = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   global settings
+------------------------------------------------------------------------- */
+
+void PairPolarization::settings(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal pair_style command");
+
+  cut_coul = force->numeric(arg[0]);
+  polar_settings(narg-1,&arg[1]);
+}
+
+/* ----------------------------------------------------------------------
+   keyword/value pairs for the induced dipoles
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_settings(int narg, char **arg)
+{
+  int iarg = 0;
+  while (iarg < narg)
+  {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal pair_style command");
+    if (strcmp("precision",arg[iarg])==0)
+    {
+      polar_precision = force->numeric(arg[iarg+1]);
+    }
+    else if (strcmp("zodid",arg[iarg])==0)
+    {
+      if (polar_gs||polar_gs_ranked) error->all(FLERR,"Zodid doesn't work with polar_gs or polar_gs_ranked");
+      if (strcmp("yes",arg[iarg+1])==0) zodid = 1;
+      else if (strcmp("no",arg[iarg+1])==0) zodid = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("fixed_iteration",arg[iarg])==0)
+    {
+      if (strcmp("yes",arg[iarg+1])==0) fixed_iteration = 1;
+      else if (strcmp("no",arg[iarg+1])==0) fixed_iteration = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("damp",arg[iarg])==0)
+    {
+      polar_damp = force->numeric(arg[iarg+1]);
+    }
+    else if (strcmp("max_iterations",arg[iarg])==0)
+    {
+      iterations_max = force->inumeric(arg[iarg+1]);
+    }
+    else if (strcmp("damp_type",arg[iarg])==0)
+    {
+      if (strcmp("exponential",arg[iarg+1])==0) damping_type = DAMPING_EXPONENTIAL;
+      else if (strcmp("none",arg[iarg+1])==0) damping_type = DAMPING_NONE;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("polar_gs",arg[iarg])==0)
+    {
+      if (polar_gs_ranked) error->all(FLERR,"polar_gs and polar_gs_ranked are mutually exclusive");
+      if (strcmp("yes",arg[iarg+1])==0) polar_gs = 1;
+      else if (strcmp("no",arg[iarg+1])==0) polar_gs = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("polar_gs_ranked",arg[iarg])==0)
+    {
+      if (polar_gs) error->all(FLERR,"polar_gs and polar_gs_ranked are mutually exclusive");
+      if (strcmp("yes",arg[iarg+1])==0) polar_gs_ranked = 1;
+      else if (strcmp("no",arg[iarg+1])==0) polar_gs_ranked = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("polar_gamma",arg[iarg])==0)
+    {
+      polar_gamma = force->numeric(arg[iarg+1]);
+    }
+    else if (strcmp("frozen",arg[iarg])==0)
+    {
+      if (strcmp("none",arg[iarg+1])==0) frozen_group = -1;
+      else
+      {
+        frozen_group = group->find(arg[iarg+1]);
+        if (frozen_group == -1)
+          error->all(FLERR,"Could not find pair_style polarization frozen group ID");
+      }
+    }
+    else if (strcmp("tree",arg[iarg])==0)
+    {
+      if (strcmp("yes",arg[iarg+1])==0) tree_flag = 1;
+      else if (strcmp("no",arg[iarg+1])==0) tree_flag = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("tree_theta",arg[iarg])==0)
+    {
+      tree_theta = force->numeric(arg[iarg+1]);
+      if (tree_theta < 0.0) error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("tree_order",arg[iarg])==0)
+    {
+      tree_order = force->inumeric(arg[iarg+1]);
+      if (tree_order < 1 || tree_order > 2) error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("debug",arg[iarg])==0)
+    {
+      if (strcmp("yes",arg[iarg+1])==0) debug = 1;
+      else if (strcmp("no",arg[iarg+1])==0) debug = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else if (strcmp("use_previous",arg[iarg])==0)
+    {
+      if (strcmp("yes",arg[iarg+1])==0) use_previous = 1;
+      else if (strcmp("no",arg[iarg+1])==0) use_previous = 0;
+      else error->all(FLERR,"Illegal pair_style command");
+    }
+    else error->all(FLERR,"Illegal pair_style command");
+    iarg+=2;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   allocate all arrays
+------------------------------------------------------------------------- */
+
+void PairPolarization::allocate()
+{
+  allocated = 1;
+  int n = atom->ntypes;
+
+  memory->create(setflag,n+1,n+1,"pair:setflag");
+  for (int i = 1; i <= n; i++)
+    for (int j = i; j <= n; j++)
+      setflag[i][j] = 0;
+
+  memory->create(cutsq,n+1,n+1,"pair:cutsq");
+}
+
+/* ----------------------------------------------------------------------
+   set coeffs for all type pairs, the dipoles do not depend on type
+------------------------------------------------------------------------- */
+
+void PairPolarization::coeff(int narg, char **arg)
+{
+  if (narg != 2) error->all(FLERR,"Incorrect args for pair coefficients");
+  if (strcmp(arg[0],"*") != 0 || strcmp(arg[1],"*") != 0)
+    error->all(FLERR,"Incorrect args for pair coefficients");
+  if (!allocated) allocate();
+
+  int n = atom->ntypes;
+  for (int i = 1; i <= n; i++)
+    for (int j = i; j <= n; j++)
+      setflag[i][j] = 1;
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+void PairPolarization::init_style()
+{
+  if (!atom->q_flag)
+    error->all(FLERR,"Pair style polarization requires atom attribute q");
+
+  polar_init();
+}
+
+/* ----------------------------------------------------------------------
+   init of the induced dipoles shared with derived styles
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_init()
+{
+  cut_coulsq = cut_coul * cut_coul;
+
+  for (int m = 0; m < nextra; m++) pvector[m] = 0.0;
+
+  // the induced dipoles only see the closest image of the owned atoms
+
+  if (comm->nprocs > 1)
+    error->all(FLERR,"Pair style polarization requires a single processor");
+
+  // the tree sums over the atoms of a finite cluster
+
+  if (tree_flag) {
+    if (domain->xperiodic || domain->yperiodic || domain->zperiodic)
+      error->all(FLERR,"Pair style polarization tree requires a non-periodic box");
+    if (polar_gs || polar_gs_ranked)
+      error->all(FLERR,"Pair style polarization tree doesn't work with "
+                 "polar_gs or polar_gs_ranked");
+    if (tree == NULL) tree = new PolarTree(lmp);
+    tree->order = tree_order;
+    tree->theta = tree_theta;
+  }
+
+  // settings may have changed since the frozen blocks were cached
+
+  if (frozen_group >= 0) frozen_groupbit = group->bitmask[frozen_group];
+  frozen_tensor_valid = frozen_field_valid = 0;
+  nlocal_frozen = 0;
+
+  // find fix efield instances whose field is added to the static field
+
+  delete [] fix_efield;
+  fix_efield = NULL;
+  nfix_efield = 0;
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"efield") == 0) nfix_efield++;
+  if (nfix_efield) {
+    fix_efield = new FixEfield*[nfix_efield];
+    nfix_efield = 0;
+    for (int i = 0; i < modify->nfix; i++)
+      if (strcmp(modify->fix[i]->style,"efield") == 0)
+        fix_efield[nfix_efield++] = (FixEfield *) modify->fix[i];
+  }
+
+  // the mu.grad(E) force of a non-uniform applied field is not computed
+
+  for (int ifix = 0; ifix < nfix_efield; ifix++)
+    if (fix_efield[ifix]->atom_field())
+      error->all(FLERR,"Pair style polarization does not support "
+                 "fix efield with atom-style variables");
+}
+
+/* ----------------------------------------------------------------------
+   init for one type pair i,j and corresponding j,i
+------------------------------------------------------------------------- */
+
+double PairPolarization::init_one(int i, int j)
+{
+  return cut_coul;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes to restart file
+------------------------------------------------------------------------- */
+
+void PairPolarization::write_restart(FILE *fp)
+{
+  write_restart_settings(fp);
+
+  int i,j;
+  for (i = 1; i <= atom->ntypes; i++)
+    for (j = i; j <= atom->ntypes; j++)
+      fwrite(&setflag[i][j],sizeof(int),1,fp);
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads from restart file, bcasts
+------------------------------------------------------------------------- */
+
+void PairPolarization::read_restart(FILE *fp)
+{
+  read_restart_settings(fp);
+  allocate();
+
+  int i,j;
+  int me = comm->me;
+  for (i = 1; i <= atom->ntypes; i++)
+    for (j = i; j <= atom->ntypes; j++) {
+      if (me == 0) fread(&setflag[i][j],sizeof(int),1,fp);
+      MPI_Bcast(&setflag[i][j],1,MPI_INT,0,world);
+    }
+}
+
+/* ----------------------------------------------------------------------
+  proc 0 writes to restart file
+------------------------------------------------------------------------- */
+
+void PairPolarization::write_restart_settings(FILE *fp)
+{
+  fwrite(&cut_coul,sizeof(double),1,fp);
+  polar_write_restart_settings(fp);
+}
+
+/* ----------------------------------------------------------------------
+  proc 0 reads from restart file, bcasts
+------------------------------------------------------------------------- */
+
+void PairPolarization::read_restart_settings(FILE *fp)
+{
+  if (comm->me == 0) fread(&cut_coul,sizeof(double),1,fp);
+  MPI_Bcast(&cut_coul,1,MPI_DOUBLE,0,world);
+  polar_read_restart_settings(fp);
+}
+
+/* ----------------------------------------------------------------------
+  proc 0 writes induced dipole settings to restart file
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_write_restart_settings(FILE *fp)
+{
+  fwrite(&iterations_max,sizeof(int),1,fp);
+  fwrite(&damping_type,sizeof(int),1,fp);
+  fwrite(&polar_damp,sizeof(double),1,fp);
+  fwrite(&zodid,sizeof(int),1,fp);
+  fwrite(&polar_precision,sizeof(double),1,fp);
+  fwrite(&fixed_iteration,sizeof(int),1,fp);
+  fwrite(&polar_gs,sizeof(int),1,fp);
+  fwrite(&polar_gs_ranked,sizeof(int),1,fp);
+  fwrite(&polar_gamma,sizeof(double),1,fp);
+  fwrite(&debug,sizeof(int),1,fp);
+  fwrite(&frozen_group,sizeof(int),1,fp);
+  fwrite(&tree_flag,sizeof(int),1,fp);
+  fwrite(&tree_order,sizeof(int),1,fp);
+  fwrite(&tree_theta,sizeof(double),1,fp);
+}
+
+/* ----------------------------------------------------------------------
+  proc 0 reads induced dipole settings from restart file, bcasts
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_read_restart_settings(FILE *fp)
+{
+  if (comm->me == 0) {
+    fread(&iterations_max,sizeof(int),1,fp);
+    fread(&damping_type,sizeof(int),1,fp);
+    fread(&polar_damp,sizeof(double),1,fp);
+    fread(&zodid,sizeof(int),1,fp);
+    fread(&polar_precision,sizeof(double),1,fp);
+    fread(&fixed_iteration,sizeof(int),1,fp);
+    fread(&polar_gs,sizeof(int),1,fp);
+    fread(&polar_gs_ranked,sizeof(int),1,fp);
+    fread(&polar_gamma,sizeof(double),1,fp);
+    fread(&debug,sizeof(int),1,fp);
+    fread(&frozen_group,sizeof(int),1,fp);
+    fread(&tree_flag,sizeof(int),1,fp);
+    fread(&tree_order,sizeof(int),1,fp);
+    fread(&tree_theta,sizeof(double),1,fp);
+  }
+  MPI_Bcast(&iterations_max,1,MPI_INT,0,world);
+  MPI_Bcast(&damping_type,1,MPI_INT,0,world);
+  MPI_Bcast(&polar_damp,1,MPI_DOUBLE,0,world);
+  MPI_Bcast(&zodid,1,MPI_INT,0,world);
+  MPI_Bcast(&polar_precision,1,MPI_DOUBLE,0,world);
+  MPI_Bcast(&fixed_iteration,1,MPI_INT,0,world);
+  MPI_Bcast(&polar_gs,1,MPI_INT,0,world);
+  MPI_Bcast(&polar_gs_ranked,1,MPI_INT,0,world);
+  MPI_Bcast(&polar_gamma,1,MPI_DOUBLE,0,world);
+  MPI_Bcast(&debug,1,MPI_INT,0,world);
+  MPI_Bcast(&frozen_group,1,MPI_INT,0,world);
+  MPI_Bcast(&tree_flag,1,MPI_INT,0,world);
+  MPI_Bcast(&tree_order,1,MPI_INT,0,world);
+  MPI_Bcast(&tree_theta,1,MPI_DOUBLE,0,world);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void *PairPolarization::extract(const char *str, int &dim)
+{
+  dim = 0;
+  if (strcmp(str,"cut_coul") == 0) return (void *) &cut_coul;
+  return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int PairPolarization::DipoleSolverIterative()
+{
+  double **ef_static = atom->ef_static;
+  double *static_polarizability = atom->static_polarizability;
+  double **mu_induced = atom->mu_induced;
+  int nlocal = atom->nlocal;
+  int i,ii,j,jj,k,l,p,q,iterations,keep_iterating,index;
+  double change;
+
+  /* build dipole interaction tensor */
+  build_dipole_field_matrix();
+
+  keep_iterating = 1;
+  iterations = 0;
+  for(k = 0; k < npolar; k++) ranked_array[k] = k;
+
+  /* rank the dipoles by bubble sort */
+  if(polar_gs_ranked) {
+    int tmp,sorted;
+    for(k = 0; k < npolar; k++) {
+      for(l = 0, sorted = 1; l < (npolar-1); l++) {
+        if(rank_metric[polar_list[ranked_array[l]]] < rank_metric[polar_list[ranked_array[l+1]]]) {
+          sorted = 0;
+          tmp = ranked_array[l];
+          ranked_array[l] = ranked_array[l+1];
+          ranked_array[l+1] = tmp;
+        }
+      }
+      if(sorted) break;
+    }
+  }
+
+  while (keep_iterating)
+  {
+    /* save old dipoles and clear the induced field */
+    for(k = 0; k < npolar; k++)
+    {
+      i = polar_list[k];
+      for(p = 0; p < 3; p++)
+      {
+        mu_induced_old[i][p] = mu_induced[i][p];
+        ef_induced[i][p] = 0;
+      }
+    }
+
+    /* contract the dipoles with the field tensor */
+    for(k = 0; k < npolar; k++) {
+      ii = ranked_array[k]*3;
+      index = polar_list[ranked_array[k]];
+      for(l = 0; l < npolar; l++) {
+        jj = l*3;
+        j = polar_list[l];
+        if(index != j) {
+          for(p = 0; p < 3; p++)
+            for(q = 0; q < 3; q++)
+              ef_induced[index][p] -= dipole_field_matrix[ii+p][jj+q]*mu_induced[j][q];
+        }
+      } /* end j */
+
+
+      /* dipole is the sum of the static and induced parts */
+      for(p = 0; p < 3; p++) {
+        mu_induced_new[index][p] = static_polarizability[index]*(ef_static[index][p] + ef_induced[index][p]);
+
+        /* Gauss-Seidel */
+        if(polar_gs || polar_gs_ranked)
+          mu_induced[index][p] = mu_induced_new[index][p];
+      }
+
+    } /* end i */
+
+    /* determine if we are done by precision */
+    if (fixed_iteration==0)
+    {
+      keep_iterating = 0;
+      change = 0;
+      for(k = 0; k < npolar; k++)
+      {
+        i = polar_list[k];
+        for(p = 0; p < 3; p++)
+        {
+          change += (mu_induced_new[i][p] - mu_induced_old[i][p])*(mu_induced_new[i][p] - mu_induced_old[i][p]);
+        }
+      }
+      change /= (double)(nlocal)*3.0;
+      if (change > polar_precision*polar_precision)
+      {
+        keep_iterating = 1;
+      }
+    }
+    else
+    {
+      /* or by fixed iteration */
+      if(iterations >= iterations_max) return iterations;
+    }
+
+    /* save the dipoles for the next pass */
+    for(k = 0; k < npolar; k++) {
+      i = polar_list[k];
+      for(p = 0; p < 3; p++) {
+          mu_induced[i][p] = mu_induced_new[i][p];
+      }
+    }
+
+    iterations++;
+    /* divergence detection */
+    /* if we fail to converge, then set dipoles to alpha*E */
+    if(iterations > iterations_max) {
+
+      for(k = 0; k < npolar; k++) {
+        i = polar_list[k];
+        for(p = 0; p < 3; p++)
+          mu_induced[i][p] = static_polarizability[i]*ef_static[i][p];
+      }
+
+      error->warning(FLERR,"Number of iterations exceeding max_iterations, setting dipoles to alpha*E");
+      return iterations;
+    }
+  }
+  return iterations;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairPolarization::build_dipole_field_matrix()
+{
+  int N = npolar;
+  double **x = atom->x;
+  double *static_polarizability = atom->static_polarizability;
+  int i,j,k,l,ii,jj,p,q;
+  double r,r2,r3,r5,damping_term1=1.0,damping_term2=1.0;
+  double xjimage[3] = {0.0,0.0,0.0};
+
+  /* the leading block of the frozen atoms is kept if still current */
+  int nf = frozen_tensor_valid ? nfrozen : 0;
+
+  /* zero out the matrix */
+  for (i=0;i<3*N;i++)
+  {
+    for (j=(i<3*nf ? 3*nf : 0);j<3*N;j++)
+    {
+      dipole_field_matrix[i][j] = 0;
+    }
+  }
+
+  /* set the diagonal blocks, only polarizable atoms are in the tensor */
+  for(k = nf; k < N; k++) {
+    ii = k*3;
+    i = polar_list[k];
+    for(p = 0; p < 3; p++)
+      dipole_field_matrix[ii+p][ii+p] = 1.0/static_polarizability[i];
+  }
+
+    /* calculate each Tij tensor component for each dipole pair */
+  for(k = 0; k < (N - 1); k++) {
+    ii = k*3;
+    i = polar_list[k];
+    for(l = (k < nf ? nf : k + 1); l < N; l++) {
+      jj = l*3;
+      j = polar_list[l];
+
+      /* inverse displacements */
+      double xi[3] = {x[i][0],x[i][1],x[i][2]};
+      double xj[3] = {x[j][0],x[j][1],x[j][2]};
+      domain->closest_image(xi,xj,xjimage);
+      r2 = pow(xi[0]-xjimage[0],2)+pow(xi[1]-xjimage[1],2)+pow(xi[2]-xjimage[2],2);
+
+      r = sqrt(r2);
+      if(r == 0.0)
+        r3 = r5 = DBL_MAX;
+      else {
+        r3 = 1.0/(r*r*r);
+        r5 = 1.0/(r*r*r*r*r);
+      }
+
+      /* set the damping function */
+      if(damping_type == DAMPING_EXPONENTIAL) {
+        damping_term1 = 1.0 - exp(-polar_damp*r)*(0.5*polar_damp*polar_damp*r2 + polar_damp*r + 1.0);
+        damping_term2 = 1.0 - exp(-polar_damp*r)*(polar_damp*polar_damp*polar_damp*r2*r/6.0 + 0.5*polar_damp*polar_damp*r2 + polar_damp*r + 1.0);
+      }
+
+      /* build the tensor */
+      for(p = 0; p < 3; p++) {
+        for(q = 0; q < 3; q++) {
+          dipole_field_matrix[ii+p][jj+q] = -3.0*(x[i][p]-xjimage[p])*(x[i][q]-xjimage[q])*damping_term2*r5;
+          /* additional diagonal term */
+          if(p == q)
+            dipole_field_matrix[ii+p][jj+q] += damping_term1*r3;
+        }
+      }
+
+      /* set the lower half of the tensor component */
+      for(p = 0; p < 3; p++)
+        for(q = 0; q < 3; q++)
+          dipole_field_matrix[jj+p][ii+q] = dipole_field_matrix[ii+p][jj+q];
+    }
+  }
+
+  if (frozen_group >= 0) frozen_tensor_valid = 1;
+
+  return;
+}
+
+/* ----------------------------------------------------------------------
+   static field of all charges without cutoff from the tree
+   charges in the same molecule are excluded, unless molecule ID is 0
+------------------------------------------------------------------------- */
+
+void PairPolarization::static_field_tree()
+{
+  int i,j,k,n;
+  double delx,dely,delz,rsq,r3inv;
+  double out[PolarTree::NOUT];
+
+  double **x = atom->x;
+  double *q = atom->q;
+  int *molecule = atom->molecule;
+  double **ef_static = atom->ef_static;
+  int nlocal = atom->nlocal;
+
+  tree->build(nlocal,x,molecule);
+  tree->charge_moments(q);
+
+  for (i = 0; i < nlocal; i++) {
+    n = tree->evaluate(x[i],molecule[i],PolarTree::CHARGE,out);
+    ef_static[i][0] = out[PolarTree::EQ];
+    ef_static[i][1] = out[PolarTree::EQ+1];
+    ef_static[i][2] = out[PolarTree::EQ+2];
+
+    for (k = 0; k < n; k++) {
+      j = tree->nearlist[k];
+      if (j == i || q[j] == 0.0) continue;
+      if (molecule[i] == molecule[j] && molecule[i] != 0) continue;
+      delx = x[i][0] - x[j][0];
+      dely = x[i][1] - x[j][1];
+      delz = x[i][2] - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      r3inv = 1.0/(rsq*sqrt(rsq));
+      ef_static[i][0] += q[j]*delx*r3inv;
+      ef_static[i][1] += q[j]*dely*r3inv;
+      ef_static[i][2] += q[j]*delz*r3inv;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   Jacobi iterations for the induced dipoles with the induced field
+     from the tree, replaces the sweeps over the dipole field tensor
+   nearby dipoles are summed directly with the damped tensor
+------------------------------------------------------------------------- */
+
+int PairPolarization::DipoleSolverTree()
+{
+  double **x = atom->x;
+  double **ef_static = atom->ef_static;
+  double *static_polarizability = atom->static_polarizability;
+  double **mu_induced = atom->mu_induced;
+  int nlocal = atom->nlocal;
+  int i,j,k,m,n,p,iterations,keep_iterating;
+  double delx,dely,delz,r2,r,r3,r5,pjdotr,change;
+  double damping_term1 = 1.0;
+  double damping_term2 = 1.0;
+  double out[PolarTree::NOUT];
+
+  keep_iterating = 1;
+  iterations = 0;
+
+  while (keep_iterating)
+  {
+    tree->dipole_moments(mu_induced);
+
+    for (k = 0; k < npolar; k++) {
+      i = polar_list[k];
+      n = tree->evaluate(x[i],0,PolarTree::DIPOLE,out);
+      for (p = 0; p < 3; p++) ef_induced[i][p] = out[PolarTree::EMU+p];
+
+      for (m = 0; m < n; m++) {
+        j = tree->nearlist[m];
+        if (j == i || static_polarizability[j] == 0.0) continue;
+        delx = x[i][0] - x[j][0];
+        dely = x[i][1] - x[j][1];
+        delz = x[i][2] - x[j][2];
+        r2 = delx*delx + dely*dely + delz*delz;
+        r = sqrt(r2);
+        r3 = 1.0/(r*r2);
+        r5 = r3/r2;
+        if (damping_type == DAMPING_EXPONENTIAL) {
+          damping_term1 = 1.0 - exp(-polar_damp*r)*(0.5*polar_damp*polar_damp*r2 + polar_damp*r + 1.0);
+          damping_term2 = 1.0 - exp(-polar_damp*r)*(polar_damp*polar_damp*polar_damp*r2*r/6.0 + 0.5*polar_damp*polar_damp*r2 + polar_damp*r + 1.0);
+        }
+        pjdotr = mu_induced[j][0]*delx + mu_induced[j][1]*dely + mu_induced[j][2]*delz;
+        ef_induced[i][0] += 3.0*delx*pjdotr*damping_term2*r5 - mu_induced[j][0]*damping_term1*r3;
+        ef_induced[i][1] += 3.0*dely*pjdotr*damping_term2*r5 - mu_induced[j][1]*damping_term1*r3;
+        ef_induced[i][2] += 3.0*delz*pjdotr*damping_term2*r5 - mu_induced[j][2]*damping_term1*r3;
+      }
+
+      for (p = 0; p < 3; p++)
+        mu_induced_new[i][p] = static_polarizability[i]*(ef_static[i][p] + ef_induced[i][p]);
+    }
+
+    /* determine if we are done by precision or by fixed iteration */
+    change = 0.0;
+    for (k = 0; k < npolar; k++) {
+      i = polar_list[k];
+      for (p = 0; p < 3; p++)
+        change += (mu_induced_new[i][p] - mu_induced[i][p])*(mu_induced_new[i][p] - mu_induced[i][p]);
+    }
+    change /= (double)(nlocal)*3.0;
+    if (fixed_iteration == 0) keep_iterating = (change > polar_precision*polar_precision);
+    else if (iterations >= iterations_max) return iterations;
+
+    /* all dipoles are updated at once */
+    for (k = 0; k < npolar; k++) {
+      i = polar_list[k];
+      for (p = 0; p < 3; p++) mu_induced[i][p] = mu_induced_new[i][p];
+    }
+
+    iterations++;
+    if (iterations > iterations_max) {
+      for (k = 0; k < npolar; k++) {
+        i = polar_list[k];
+        for (p = 0; p < 3; p++)
+          mu_induced[i][p] = static_polarizability[i]*ef_static[i][p];
+      }
+      error->warning(FLERR,"Number of iterations exceeding max_iterations, setting dipoles to alpha*E");
+      return iterations;
+    }
+  }
+  return iterations;
+}
+
+/* ----------------------------------------------------------------------
+   forces and energies of the induced dipoles from the tree
+   each atom gets the force of all other atoms on it, far cells act via
+     the field and field gradient of their multipoles, near atoms via the
+     same pair terms as the all-pairs loop without the Wolf shift
+------------------------------------------------------------------------- */
+
+void PairPolarization::polar_forces_tree(int eflag, double &u_polar_self,
+                                         double &u_polar_ef, double &u_polar_dd)
+{
+  double **x = atom->x;
+  double **f = atom->f;
+  double *q = atom->q;
+  int *molecule = atom->molecule;
+  double **ef_static = atom->ef_static;
+  double *static_polarizability = atom->static_polarizability;
+  double **mu = atom->mu_induced;
+  int nlocal = atom->nlocal;
+
+  int i,j,k,n,mode,a,b;
+  double delx,dely,delz,xsq,ysq,zsq,rsq,r,rinv,r2inv,r3inv,r5inv,r7inv;
+  double common_factor,pdotp,pidotr,pjdotr,pre1,pre2,pre3,pre4,pre5;
+  double term_1,term_2,term_3;
+  double fi[3],ef_ind[3];
+  double out[PolarTree::NOUT];
+  double s = sqrt(force->qqrd2e);
+
+  tree->dipole_moments(mu);
+
+  for (i = 0; i < nlocal; i++) {
+    int polar_i = (static_polarizability[i] != 0.0);
+    if (!polar_i && q[i] == 0.0) continue;
+
+    mode = PolarTree::DIPOLE;
+    if (polar_i) mode |= PolarTree::CHARGE | PolarTree::GRADIENT;
+    n = tree->evaluate(x[i],molecule[i],mode,out);
+
+    /* far field: charge in the dipole field, dipole in the field gradients */
+    for (a = 0; a < 3; a++) {
+      fi[a] = q[i]*s*out[PolarTree::EMUX+a];
+      ef_ind[a] = out[PolarTree::EMU+a];
+      if (polar_i)
+        for (b = 0; b < 3; b++)
+          fi[a] += (s*out[PolarTree::GQ+3*a+b] + out[PolarTree::GMU+3*a+b])*mu[i][b];
+    }
+
+    /* near atoms */
+    for (k = 0; k < n; k++) {
+      j = tree->nearlist[k];
+      if (j == i) continue;
+      delx = x[i][0] - x[j][0];
+      dely = x[i][1] - x[j][1];
+      delz = x[i][2] - x[j][2];
+      xsq = delx*delx;
+      ysq = dely*dely;
+      zsq = delz*delz;
+      rsq = xsq + ysq + zsq;
+      r2inv = 1.0/rsq;
+      rinv = sqrt(r2inv);
+      r = 1.0/rinv;
+      r3inv = r2inv*rinv;
+
+      if ((molecule[i]!=molecule[j])||molecule[i]==0)
+      {
+        /* dipole on i, charge on j */
+        if (polar_i && q[j] != 0.0)
+        {
+          common_factor = q[j]*s*r3inv;
+          pidotr = mu[i][0]*delx + mu[i][1]*dely + mu[i][2]*delz;
+          fi[0] += common_factor*(mu[i][0] - 3.0*delx*pidotr*r2inv);
+          fi[1] += common_factor*(mu[i][1] - 3.0*dely*pidotr*r2inv);
+          fi[2] += common_factor*(mu[i][2] - 3.0*delz*pidotr*r2inv);
+        }
+        /* charge on i, dipole on j */
+        if (static_polarizability[j] != 0.0 && q[i] != 0.0)
+        {
+          common_factor = q[i]*s*r3inv;
+          pjdotr = mu[j][0]*delx + mu[j][1]*dely + mu[j][2]*delz;
+          fi[0] -= common_factor*(mu[j][0] - 3.0*delx*pjdotr*r2inv);
+          fi[1] -= common_factor*(mu[j][1] - 3.0*dely*pjdotr*r2inv);
+          fi[2] -= common_factor*(mu[j][2] - 3.0*delz*pjdotr*r2inv);
+        }
+      }
+
+      /* dipole on i, dipole on j */
+      if (polar_i && static_polarizability[j] != 0.0)
+      {
+        r5inv = r3inv*r2inv;
+        r7inv = r5inv*r2inv;
+        pdotp = mu[i][0]*mu[j][0] + mu[i][1]*mu[j][1] + mu[i][2]*mu[j][2];
+        pidotr = mu[i][0]*delx + mu[i][1]*dely + mu[i][2]*delz;
+        pjdotr = mu[j][0]*delx + mu[j][1]*dely + mu[j][2]*delz;
+
+        if (damping_type == DAMPING_EXPONENTIAL)
+        {
+          term_1 = exp(-polar_damp*r);
+          term_2 = 1.0+polar_damp*r+0.5*polar_damp*polar_damp*r*r;
+          term_3 = 1.0+polar_damp*r+0.5*polar_damp*polar_damp*r*r+1.0/6.0*polar_damp*polar_damp*polar_damp*r*r*r;
+
+          pre1 = 3.0*r5inv*pdotp*(1.0-term_1*term_2) - 15.0*r7inv*pidotr*pjdotr*(1.0-term_1*term_3);
+          pre2 = 3.0*r5inv*pjdotr*(1.0-term_1*term_3);
+          pre3 = 3.0*r5inv*pidotr*(1.0-term_1*term_3);
+          pre4 = -pdotp*r3inv*(-term_1*(polar_damp*rinv+polar_damp*polar_damp) + term_1*polar_damp*term_2*rinv);
+          pre5 = 3.0*pidotr*pjdotr*r5inv*(-term_1*(polar_damp*rinv+polar_damp*polar_damp+0.5*r*polar_damp*polar_damp*polar_damp)+term_1*polar_damp*term_3*rinv);
+        }
+        else
+        {
+          term_1 = 0.0;
+          term_2 = term_3 = 1.0;
+          pre1 = 3.0*r5inv*pdotp - 15.0*r7inv*pidotr*pjdotr;
+          pre2 = 3.0*r5inv*pjdotr;
+          pre3 = 3.0*r5inv*pidotr;
+          pre4 = pre5 = 0.0;
+        }
+
+        fi[0] += pre1*delx + pre2*mu[i][0] + pre3*mu[j][0] + pre4*delx + pre5*delx;
+        fi[1] += pre1*dely + pre2*mu[i][1] + pre3*mu[j][1] + pre4*dely + pre5*dely;
+        fi[2] += pre1*delz + pre2*mu[i][2] + pre3*mu[j][2] + pre4*delz + pre5*delz;
+
+        ef_ind[0] += 3.0*delx*pjdotr*(1.0-term_1*term_3)*r5inv - mu[j][0]*(1.0-term_1*term_2)*r3inv;
+        ef_ind[1] += 3.0*dely*pjdotr*(1.0-term_1*term_3)*r5inv - mu[j][1]*(1.0-term_1*term_2)*r3inv;
+        ef_ind[2] += 3.0*delz*pjdotr*(1.0-term_1*term_3)*r5inv - mu[j][2]*(1.0-term_1*term_2)*r3inv;
+      }
+    }
+
+    f[i][0] += fi[0];
+    f[i][1] += fi[1];
+    f[i][2] += fi[2];
+
+    /* energies of the dipole, each dipole-dipole pair is seen twice */
+    if (eflag && polar_i)
+    {
+      u_polar_self += 0.5*(mu[i][0]*mu[i][0]+mu[i][1]*mu[i][1]+mu[i][2]*mu[i][2])/static_polarizability[i];
+      u_polar_ef -= mu[i][0]*ef_static[i][0] + mu[i][1]*ef_static[i][1] + mu[i][2]*ef_static[i][2];
+      u_polar_dd -= 0.5*(mu[i][0]*ef_ind[0] + mu[i][1]*ef_ind[1] + mu[i][2]*ef_ind[2]);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   dipoles induced by a unit field along x, y, and z on all atoms,
+     used by compute polarizability
+   the three right-hand sides share one build of the tensor, and each
+     Gauss-Seidel sweep contracts a row of the tensor with all three
+   mu[i][3*b+a] = component a of the dipole of atom i for the field along b
+   uses the polarizable atoms indexed by the last force evaluation
+------------------------------------------------------------------------- */
+
+int PairPolarization::solve_polarizability(double **mu)
+{
+  double *static_polarizability = atom->static_polarizability;
+  int nlocal = atom->nlocal;
+  int i,j,k,l,ii,jj,a,b,p,q,iterations;
+  double t,change,mu_new;
+  double e[9];
+
+  if (tree_flag)
+    error->all(FLERR,"Compute polarizability cannot be used with pair style polarization tree");
+
+  for (i = 0; i < nlocal; i++)
+    for (p = 0; p < 9; p++) mu[i][p] = 0.0;
+
+  build_dipole_field_matrix();
+
+  /* start from alpha times the unit fields */
+  for (k = 0; k < npolar; k++) {
+    i = polar_list[k];
+    for (b = 0; b < 3; b++) mu[i][4*b] = static_polarizability[i];
+  }
+
+  for (iterations = 1; iterations <= iterations_max; iterations++) {
+    change = 0.0;
+    for (k = 0; k < npolar; k++) {
+      ii = 3*k;
+      i = polar_list[k];
+      for (p = 0; p < 9; p++) e[p] = 0.0;
+      for (l = 0; l < npolar; l++) {
+        if (l == k) continue;
+        jj = 3*l;
+        j = polar_list[l];
+        for (p = 0; p < 3; p++)
+          for (q = 0; q < 3; q++) {
+            t = dipole_field_matrix[ii+p][jj+q];
+            e[p] -= t*mu[j][q];
+            e[3+p] -= t*mu[j][3+q];
+            e[6+p] -= t*mu[j][6+q];
+          }
+      }
+      for (b = 0; b < 3; b++)
+        for (a = 0; a < 3; a++) {
+          mu_new = static_polarizability[i]*((a == b ? 1.0 : 0.0) + e[3*b+a]);
+          change += (mu_new - mu[i][3*b+a])*(mu_new - mu[i][3*b+a]);
+          mu[i][3*b+a] = mu_new;
+        }
+    }
+    change /= (double)(nlocal)*9.0;
+    if (change < polar_precision*polar_precision) return iterations;
+  }
+
+  error->warning(FLERR,"Polarizability solve exceeding max_iterations");
+  return iterations_max;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int PairPolarization::pack_comm(int n, int *list, double *buf,
+           int pbc_flag, int *pbc)
+{
+  int i,j,m;
+  double *static_polarizability = atom->static_polarizability;
+  double **ef_static = atom->ef_static;
+  double **mu_induced = atom->mu_induced;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = static_polarizability[j];
+    buf[m++] = ef_static[j][0];
+    buf[m++] = ef_static[j][1];
+    buf[m++] = ef_static[j][2];
+    buf[m++] = mu_induced[j][0];
+    buf[m++] = mu_induced[j][1];
+    buf[m++] = mu_induced[j][2];
+  }
+  return 7;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairPolarization::unpack_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+  double *static_polarizability = atom->static_polarizability;
+  double **ef_static = atom->ef_static;
+  double **mu_induced = atom->mu_induced;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    static_polarizability[i] = buf[m++];
+    ef_static[i][0] = buf[m++];
+    ef_static[i][1] = buf[m++];
+    ef_static[i][2] = buf[m++];
+    mu_induced[i][0] = buf[m++];
+    mu_induced[i][1] = buf[m++];
+    mu_induced[i][2] = buf[m++];
+  }
+}
@@ -0,0 +1,190 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(polarization,PairPolarization)
+
+#else
+
+#ifndef LMP_PAIR_POLARIZATION_H
+#define LMP_PAIR_POLARIZATION_H
+
+#include "stdio.h"
+#include "pair.h"
+
+namespace LAMMPS_NS {
+
+class PairPolarization : public Pair {
+ public:
+  PairPolarization(class LAMMPS *);
+  virtual ~PairPolarization();
+  virtual void compute(int, int);
+  virtual void settings(int, char **);
+  virtual void coeff(int, char **);
+  virtual void init_style();
+  virtual double init_one(int, int);
+  virtual void write_restart(FILE *);
+  virtual void read_restart(FILE *);
+  virtual void write_restart_settings(FILE *);
+  virtual void read_restart_settings(FILE *);
+  void *extract(const char *, int &);
+
+  int pack_comm(int, int *, double *,int, int *);
+  void unpack_comm(int, int, double *);
+  int solve_polarizability(double **);
+
+ protected:
+  double cut_coul,cut_coulsq;
+
+  /* polarization stuff */
+  double **ef_induced;
+  double **dipole_field_matrix;
+  double **mu_induced_new,**mu_induced_old;
+  double *rank_metric;
+  double rmin;
+  int *ranked_array;
+  int nlocal_old;
+  int npolar,npolar_max;           // # of polarizable owned atoms, matrix size
+  int *polar_list;                 // indices of polarizable owned atoms
+
+  /* cached tensor blocks and static field of a frozen group */
+  int frozen_group,frozen_groupbit;   // group that does not move, -1 if none
+  int nfrozen;                     // # of frozen atoms at start of polar_list
+  int nfrozen_all,nlocal_frozen;   // # of frozen atoms and nlocal when cached
+  int frozen_tensor_valid;         // 1 if frozen block of tensor is current
+  int frozen_field_valid;          // 1 if ef_frozen is current
+  int *frozen_tag;                 // tag of frozen atoms when cached, else -1
+  double **frozen_save;            // x,q,alpha of frozen atoms when cached
+  double frozen_h[6];              // box when cached
+  double **ef_frozen;              // field of frozen charges on frozen atoms
+  int nmobile;
+  int *mobile_list;                // indices of owned atoms not frozen
+
+  /* Barnes-Hut tree for non-periodic systems */
+  int tree_flag;                   // 1 to use the tree instead of all pairs
+  int tree_order;                  // highest multipole of the tree cells
+  double tree_theta;               // opening angle of the tree
+  class PolarTree *tree;
+
+  int iterations_max;
+  virtual void build_dipole_field_matrix();
+  int DipoleSolverIterative();
+  int damping_type;
+  int zodid;
+  int debug;
+  double polar_damp;
+  double polar_precision;
+  int fixed_iteration;
+  int polar_gs,polar_gs_ranked;
+  int use_previous;
+  double polar_gamma;
+
+  /* external fields from fix efield */
+  int nfix_efield;
+  class FixEfield **fix_efield;
+  double **ef_external;
+
+  void allocate();
+  void polar_settings(int, char **);
+  void polar_init();
+  void polar_compute(int);
+  virtual void static_field_wolf();
+  virtual void polar_forces(int, double &, double &, double &);
+  void check_frozen();
+  void static_field_tree();
+  int DipoleSolverTree();
+  void polar_forces_tree(int, double &, double &, double &);
+  void polar_write_restart_settings(FILE *);
+  void polar_read_restart_settings(FILE *);
+  /* ------------------ */
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Pair style requires atom attribute polarizability
+
+The atom style defined does not have this attribute.
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Zodid doesn't work with polar_gs or polar_gs_ranked
+
+Turn off Gauss-Seidel iterations with polar_gs_ranked no before
+selecting zodid yes.
+
+E: polar_gs and polar_gs_ranked are mutually exclusive
+
+Only one of the two Gauss-Seidel orderings can be selected.
+
+E: Incorrect args for pair coefficients
+
+Self-explanatory.  Check the input script or data file.
+
+E: Could not find pair_style polarization frozen group ID
+
+Self-explanatory.
+
+E: Pair style polarization does not support fix efield with atom-style variables
+
+The force from the gradient of a non-uniform applied field on the
+induced dipoles is not computed.  Use constant or equal-style fields.
+
+E: Pair style polarization tree requires a non-periodic box
+
+The tree sums the interactions of the atoms in a finite cluster and
+does not handle periodic images.
+
+E: Pair style polarization tree doesn't work with polar_gs or polar_gs_ranked
+
+The tree solves for the dipoles with Jacobi iterations.  Since
+polar_gs_ranked is on by default, set polar_gs_ranked no together with
+tree yes.
+
+E: Compute polarizability cannot be used with pair style polarization tree
+
+The polarizability solve uses the dipole field tensor, which the tree
+does not build.
+
+W: Polarizability solve exceeding max_iterations
+
+The dipoles induced by the unit fields of compute polarizability did
+not converge.  The polarizabilities for this timestep are not
+accurate.
+
+E: Pair style polarization requires atom attribute q
+
+The atom style defined does not have this attribute.
+
+E: Pair style polarization requires a single processor
+
+The induced dipoles interact with the closest periodic image of the
+atoms owned by the same processor, so the fields and forces would miss
+the atoms owned by other processors.
+
+W: Number of iterations exceeding max_iterations, setting dipoles to alpha*E
+
+The self-consistent solution for the induced dipoles did not
+converge.  The dipoles for this timestep are set to the first-order
+estimate instead.
+
+*/
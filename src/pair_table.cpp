@@ -61,8 +61,9 @@ void PairTable::compute(int eflag, int vflag)
 {
   int i,j,ii,jj,inum,jnum,itype,jtype,itable;
   double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
-  double rsq,factor_lj,fraction,value,a,b;
+  double rsq,factor_lj,fraction,value;
   int *ilist,*jlist,*numneigh,**firstneigh;
+  const double *coeff;
   Table *tb;
 
   union_int_float_t rsq_lookup;
@@ -111,27 +112,17 @@ void PairTable::compute(int eflag, int vflag)
         if (rsq < tb->innersq)
           error->one(FLERR,"Pair distance < table inner cutoff");
 
-        if (tabstyle == LOOKUP) {
-          itable = static_cast<int> ((rsq - tb->innersq) * tb->invdelta);
-          if (itable >= tlm1)
-            error->one(FLERR,"Pair distance > table outer cutoff");
-          fpair = factor_lj * tb->f[itable];
-        } else if (tabstyle == LINEAR) {
-          itable = static_cast<int> ((rsq - tb->innersq) * tb->invdelta);
-          if (itable >= tlm1)
-            error->one(FLERR,"Pair distance > table outer cutoff");
-          fraction = (rsq - tb->rsq[itable]) * tb->invdelta;
-          value = tb->f[itable] + fraction*tb->df[itable];
-          fpair = factor_lj * value;
-        } else if (tabstyle == SPLINE) {
-          itable = static_cast<int> ((rsq - tb->innersq) * tb->invdelta);
+        // LOOKUP, LINEAR, SPLINE share one kernel on the packed coeffs
+
+        if (tabstyle != BITMAP) {
+          fraction = (rsq - tb->innersq) * tb->invdelta;
+          itable = static_cast<int> (fraction);
           if (itable >= tlm1)
             error->one(FLERR,"Pair distance > table outer cutoff");
-          b = (rsq - tb->rsq[itable]) * tb->invdelta;
-          a = 1.0 - b;
-          value = a * tb->f[itable] + b * tb->f[itable+1] +
-            ((a*a*a-a)*tb->f2[itable] + (b*b*b-b)*tb->f2[itable+1]) *
-            tb->deltasq6;
+          fraction -= itable;
+          coeff = &tb->coeff[8*itable];
+          value = coeff[0] + fraction*(coeff[1] +
+                                       fraction*(coeff[2] + fraction*coeff[3]));
           fpair = factor_lj * value;
         } else {
           rsq_lookup.f = rsq;
@@ -152,14 +143,11 @@ void PairTable::compute(int eflag, int vflag)
         }
 
         if (eflag) {
-          if (tabstyle == LOOKUP)
-            evdwl = tb->e[itable];
-          else if (tabstyle == LINEAR || tabstyle == BITMAP)
-            evdwl = tb->e[itable] + fraction*tb->de[itable];
+          if (tabstyle != BITMAP)
+            evdwl = coeff[4] + fraction*(coeff[5] +
+                                         fraction*(coeff[6] + fraction*coeff[7]));
           else
-            evdwl = a * tb->e[itable] + b * tb->e[itable+1] +
-              ((a*a*a-a)*tb->e2[itable] + (b*b*b-b)*tb->e2[itable+1]) *
-              tb->deltasq6;
+            evdwl = tb->e[itable] + fraction*tb->de[itable];
           evdwl *= factor_lj;
         }
 
@@ -749,6 +737,52 @@ void PairTable::compute_table(Table *tb)
       }
     }
   }
+
+  if (tabstyle != BITMAP) pack_table(tb);
+}
+
+/* ----------------------------------------------------------------------
+   pack LOOKUP, LINEAR, SPLINE tables into per-bin polynomial coeffs
+   f,e in bin i are cubics in the fraction b = (rsq-rsq[i])/delta
+   coeff[8*i] = f0,f1,f2,f3,e0,e1,e2,e3 so one bin is one contiguous block
+   and the pair loop evaluates all 3 styles with the same Horner kernel
+------------------------------------------------------------------------- */
+
+void PairTable::pack_table(Table *tb)
+{
+  int tlm1 = tablength-1;
+
+  memory->create(tb->coeff,8*tlm1,"pair:coeff");
+  for (int i = 0; i < 8*tlm1; i++) tb->coeff[i] = 0.0;
+
+  double *c;
+  for (int i = 0; i < tlm1; i++) {
+    c = &tb->coeff[8*i];
+    if (tabstyle == LOOKUP) {
+      c[0] = tb->f[i];
+      c[4] = tb->e[i];
+    } else if (tabstyle == LINEAR) {
+      c[0] = tb->f[i];
+      c[1] = tb->df[i];
+      c[4] = tb->e[i];
+      c[5] = tb->de[i];
+    } else {
+
+      // a*y[i] + b*y[i+1] + ((a^3-a)*y2[i] + (b^3-b)*y2[i+1])*delta^2/6
+      // with a = 1-b, expanded in powers of b
+
+      c[0] = tb->f[i];
+      c[1] = tb->f[i+1] - tb->f[i] -
+        (2.0*tb->f2[i] + tb->f2[i+1]) * tb->deltasq6;
+      c[2] = 3.0*tb->f2[i] * tb->deltasq6;
+      c[3] = (tb->f2[i+1] - tb->f2[i]) * tb->deltasq6;
+      c[4] = tb->e[i];
+      c[5] = tb->e[i+1] - tb->e[i] -
+        (2.0*tb->e2[i] + tb->e2[i+1]) * tb->deltasq6;
+      c[6] = 3.0*tb->e2[i] * tb->deltasq6;
+      c[7] = (tb->e2[i+1] - tb->e2[i]) * tb->deltasq6;
+    }
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -761,6 +795,7 @@ void PairTable::null_table(Table *tb)
   tb->e2file = tb->f2file = NULL;
   tb->rsq = tb->drsq = tb->e = tb->de = NULL;
   tb->f = tb->df = tb->e2 = tb->f2 = NULL;
+  tb->coeff = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -783,6 +818,7 @@ void PairTable::free_table(Table *tb)
   memory->destroy(tb->df);
   memory->destroy(tb->e2);
   memory->destroy(tb->f2);
+  memory->destroy(tb->coeff);
 }
 
 /* ----------------------------------------------------------------------
@@ -891,30 +927,21 @@ double PairTable::single(int i, int j, int itype, int jtype, double rsq,
                          double &fforce)
 {
   int itable;
-  double fraction,value,a,b,phi;
+  double fraction,value,phi;
+  const double *coeff;
   int tlm1 = tablength - 1;
 
   Table *tb = &tables[tabindex[itype][jtype]];
   if (rsq < tb->innersq) error->one(FLERR,"Pair distance < table inner cutoff");
 
-  if (tabstyle == LOOKUP) {
-    itable = static_cast<int> ((rsq-tb->innersq) * tb->invdelta);
-    if (itable >= tlm1) error->one(FLERR,"Pair distance > table outer cutoff");
-    fforce = factor_lj * tb->f[itable];
-  } else if (tabstyle == LINEAR) {
-    itable = static_cast<int> ((rsq-tb->innersq) * tb->invdelta);
+  if (tabstyle != BITMAP) {
+    fraction = (rsq-tb->innersq) * tb->invdelta;
+    itable = static_cast<int> (fraction);
     if (itable >= tlm1) error->one(FLERR,"Pair distance > table outer cutoff");
-    fraction = (rsq - tb->rsq[itable]) * tb->invdelta;
-    value = tb->f[itable] + fraction*tb->df[itable];
-    fforce = factor_lj * value;
-  } else if (tabstyle == SPLINE) {
-    itable = static_cast<int> ((rsq-tb->innersq) * tb->invdelta);
-    if (itable >= tlm1) error->one(FLERR,"Pair distance > table outer cutoff");
-    b = (rsq - tb->rsq[itable]) * tb->invdelta;
-    a = 1.0 - b;
-    value = a * tb->f[itable] + b * tb->f[itable+1] +
-      ((a*a*a-a)*tb->f2[itable] + (b*b*b-b)*tb->f2[itable+1]) *
-      tb->deltasq6;
+    fraction -= itable;
+    coeff = &tb->coeff[8*itable];
+    value = coeff[0] + fraction*(coeff[1] +
+                                 fraction*(coeff[2] + fraction*coeff[3]));
     fforce = factor_lj * value;
   } else {
     union_int_float_t rsq_lookup;
@@ -926,13 +953,11 @@ double PairTable::single(int i, int j, int itype, int jtype, double rsq,
     fforce = factor_lj * value;
   }
 
-  if (tabstyle == LOOKUP)
-    phi = tb->e[itable];
-  else if (tabstyle == LINEAR || tabstyle == BITMAP)
-    phi = tb->e[itable] + fraction*tb->de[itable];
+  if (tabstyle != BITMAP)
+    phi = coeff[4] + fraction*(coeff[5] +
+                               fraction*(coeff[6] + fraction*coeff[7]));
   else
-    phi = a * tb->e[itable] + b * tb->e[itable+1] +
-      ((a*a*a-a)*tb->e2[itable] + (b*b*b-b)*tb->e2[itable+1]) * tb->deltasq6;
+    phi = tb->e[itable] + fraction*tb->de[itable];
   return factor_lj*phi;
 }
 
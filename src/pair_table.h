@@ -52,6 +52,7 @@ class PairTable : public Pair {
     double *e2file,*f2file;
     double innersq,delta,invdelta,deltasq6;
     double *rsq,*drsq,*e,*de,*f,*df,*e2,*f2;
+    double *coeff;
   };
   int ntables;
   Table *tables;
@@ -64,6 +65,7 @@ class PairTable : public Pair {
   void bcast_table(Table *);
   void spline_table(Table *);
   void compute_table(Table *);
+  void pack_table(Table *);
   void null_table(Table *);
   void free_table(Table *);
   void spline(double *, double *, int, double, double, double *);
@@ -0,0 +1,417 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   Barnes-Hut octree with Cartesian multipole expansions of point charges
+     and point dipoles, used for the static and induced fields of
+     non-periodic polarizable systems
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "polar_tree.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define LEAFSIZE 8             // max # of atoms in a leaf
+#define MAXDEPTH 30            // max depth, for atoms on top of each other
+#define DELTA 1024
+
+/* ---------------------------------------------------------------------- */
+
+PolarTree::PolarTree(LAMMPS *lmp) : Pointers(lmp)
+{
+  order = 2;
+  theta = 0.3;
+
+  natoms = nmax = 0;
+  x = NULL;
+  molecule = NULL;
+  perm = NULL;
+
+  nnodes = maxnodes = 0;
+  center = NULL;
+  edge = NULL;
+  first = count = NULL;
+  child = NULL;
+  molmin = molmax = NULL;
+  qmom = dmom = NULL;
+
+  maxnear = maxstack = 0;
+  nearlist = NULL;
+  stack = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PolarTree::~PolarTree()
+{
+  memory->destroy(perm);
+  memory->destroy(center);
+  memory->destroy(edge);
+  memory->destroy(first);
+  memory->destroy(count);
+  memory->destroy(child);
+  memory->destroy(molmin);
+  memory->destroy(molmax);
+  memory->destroy(qmom);
+  memory->destroy(dmom);
+  memory->destroy(nearlist);
+  memory->destroy(stack);
+}
+
+/* ----------------------------------------------------------------------
+   build the octree over n atoms with coords xnew and molecule IDs mol
+   the arrays are referenced, not copied, until the next build
+------------------------------------------------------------------------- */
+
+void PolarTree::build(int n, double **xnew, int *mol)
+{
+  int i;
+
+  natoms = n;
+  x = xnew;
+  molecule = mol;
+  nnodes = 0;
+  if (natoms == 0) return;
+
+  if (natoms > nmax) {
+    nmax = natoms;
+    memory->destroy(perm);
+    memory->create(perm,nmax,"polar/tree:perm");
+  }
+  for (i = 0; i < natoms; i++) perm[i] = i;
+
+  // root is the cube around the bounding box of the atoms
+
+  double lo[3],hi[3];
+  lo[0] = hi[0] = x[0][0];
+  lo[1] = hi[1] = x[0][1];
+  lo[2] = hi[2] = x[0][2];
+  for (i = 1; i < natoms; i++) {
+    lo[0] = MIN(lo[0],x[i][0]); hi[0] = MAX(hi[0],x[i][0]);
+    lo[1] = MIN(lo[1],x[i][1]); hi[1] = MAX(hi[1],x[i][1]);
+    lo[2] = MIN(lo[2],x[i][2]); hi[2] = MAX(hi[2],x[i][2]);
+  }
+
+  double c[3];
+  c[0] = 0.5*(lo[0]+hi[0]);
+  c[1] = 0.5*(lo[1]+hi[1]);
+  c[2] = 0.5*(lo[2]+hi[2]);
+  double h = 0.5*MAX(hi[0]-lo[0],MAX(hi[1]-lo[1],hi[2]-lo[2]));
+  if (h == 0.0) h = 1.0;
+  h *= 1.0001;
+
+  // each level of the deepest path leaves at most 7 pending siblings
+
+  if (maxstack < 8*(MAXDEPTH+2)) {
+    maxstack = 8*(MAXDEPTH+2);
+    memory->destroy(stack);
+    memory->create(stack,maxstack,"polar/tree:stack");
+  }
+
+  build_node(0,natoms,c,h,0);
+}
+
+/* ----------------------------------------------------------------------
+   create node for atoms perm[ifirst:ifirst+n) in cube of half edge h
+   partition the atoms into octants in place and recurse
+------------------------------------------------------------------------- */
+
+int PolarTree::build_node(int ifirst, int n, double *c, double h, int depth)
+{
+  int i,k,m,kk,tmp;
+
+  if (nnodes == maxnodes) grow_nodes();
+  int node = nnodes++;
+
+  center[node][0] = c[0];
+  center[node][1] = c[1];
+  center[node][2] = c[2];
+  edge[node] = 2.0*h;
+  first[node] = ifirst;
+  count[node] = n;
+  for (k = 0; k < 8; k++) child[node][k] = -1;
+
+  if (molecule) {
+    molmin[node] = molmax[node] = molecule[perm[ifirst]];
+    for (m = ifirst+1; m < ifirst+n; m++) {
+      i = perm[m];
+      molmin[node] = MIN(molmin[node],molecule[i]);
+      molmax[node] = MAX(molmax[node],molecule[i]);
+    }
+  } else molmin[node] = molmax[node] = 0;
+
+  if (n <= LEAFSIZE || depth >= MAXDEPTH) return node;
+
+  // count atoms per octant, then swap them into place
+
+  int cnt[8],start[8],next[8];
+  for (k = 0; k < 8; k++) cnt[k] = 0;
+  for (m = ifirst; m < ifirst+n; m++) {
+    i = perm[m];
+    k = (x[i][0] > c[0]) + 2*(x[i][1] > c[1]) + 4*(x[i][2] > c[2]);
+    cnt[k]++;
+  }
+  start[0] = 0;
+  for (k = 1; k < 8; k++) start[k] = start[k-1] + cnt[k-1];
+  for (k = 0; k < 8; k++) next[k] = start[k];
+
+  for (k = 0; k < 8; k++) {
+    while (next[k] < start[k] + cnt[k]) {
+      m = ifirst + next[k];
+      i = perm[m];
+      kk = (x[i][0] > c[0]) + 2*(x[i][1] > c[1]) + 4*(x[i][2] > c[2]);
+      if (kk == k) next[k]++;
+      else {
+        tmp = perm[ifirst+next[kk]];
+        perm[ifirst+next[kk]] = i;
+        perm[m] = tmp;
+        next[kk]++;
+      }
+    }
+  }
+
+  double cc[3];
+  double hh = 0.5*h;
+  for (k = 0; k < 8; k++) {
+    if (cnt[k] == 0) continue;
+    cc[0] = c[0] + ((k & 1) ? hh : -hh);
+    cc[1] = c[1] + ((k & 2) ? hh : -hh);
+    cc[2] = c[2] + ((k & 4) ? hh : -hh);
+    m = build_node(ifirst+start[k],cnt[k],cc,hh,depth+1);
+    child[node][k] = m;
+  }
+
+  return node;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PolarTree::grow_nodes()
+{
+  maxnodes += DELTA;
+  memory->grow(center,maxnodes,3,"polar/tree:center");
+  memory->grow(edge,maxnodes,"polar/tree:edge");
+  memory->grow(first,maxnodes,"polar/tree:first");
+  memory->grow(count,maxnodes,"polar/tree:count");
+  memory->grow(child,maxnodes,8,"polar/tree:child");
+  memory->grow(molmin,maxnodes,"polar/tree:molmin");
+  memory->grow(molmax,maxnodes,"polar/tree:molmax");
+  memory->grow(qmom,maxnodes,10,"polar/tree:qmom");
+  memory->grow(dmom,maxnodes,9,"polar/tree:dmom");
+}
+
+/* ----------------------------------------------------------------------
+   multipole moments of the charges q about each node center
+   phi(R) = M0/R + M1.grad(1/R) + M2:grad grad(1/R), R from the center
+------------------------------------------------------------------------- */
+
+void PolarTree::charge_moments(double *q)
+{
+  int i,k,m,node;
+  double s[3];
+
+  for (node = 0; node < nnodes; node++) {
+    double *mom = qmom[node];
+    for (k = 0; k < 10; k++) mom[k] = 0.0;
+    for (m = first[node]; m < first[node]+count[node]; m++) {
+      i = perm[m];
+      if (q[i] == 0.0) continue;
+      s[0] = x[i][0] - center[node][0];
+      s[1] = x[i][1] - center[node][1];
+      s[2] = x[i][2] - center[node][2];
+      mom[0] += q[i];
+      mom[1] -= q[i]*s[0];
+      mom[2] -= q[i]*s[1];
+      mom[3] -= q[i]*s[2];
+      mom[4] += 0.5*q[i]*s[0]*s[0];
+      mom[5] += 0.5*q[i]*s[1]*s[1];
+      mom[6] += 0.5*q[i]*s[2]*s[2];
+      mom[7] += 0.5*q[i]*s[0]*s[1];
+      mom[8] += 0.5*q[i]*s[0]*s[2];
+      mom[9] += 0.5*q[i]*s[1]*s[2];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   multipole moments of the point dipoles mu about each node center
+------------------------------------------------------------------------- */
+
+void PolarTree::dipole_moments(double **mu)
+{
+  int i,k,m,node;
+  double s[3];
+
+  for (node = 0; node < nnodes; node++) {
+    double *mom = dmom[node];
+    for (k = 0; k < 9; k++) mom[k] = 0.0;
+    for (m = first[node]; m < first[node]+count[node]; m++) {
+      i = perm[m];
+      s[0] = x[i][0] - center[node][0];
+      s[1] = x[i][1] - center[node][1];
+      s[2] = x[i][2] - center[node][2];
+      mom[0] -= mu[i][0];
+      mom[1] -= mu[i][1];
+      mom[2] -= mu[i][2];
+      mom[3] += mu[i][0]*s[0];
+      mom[4] += mu[i][1]*s[1];
+      mom[5] += mu[i][2]*s[2];
+      mom[6] += 0.5*(mu[i][0]*s[1] + mu[i][1]*s[0]);
+      mom[7] += 0.5*(mu[i][0]*s[2] + mu[i][2]*s[0]);
+      mom[8] += 0.5*(mu[i][1]*s[2] + mu[i][2]*s[1]);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   far field at point xi from the nodes that satisfy edge < theta*distance
+   out = field and field gradients as selected by mode, see header
+   return # of atoms in nearlist whose contributions the caller must add
+   nodes that may hold atoms of molecule moli != 0 are opened, so the
+     caller can exclude them, unless they only hold that molecule,
+     then they do not contribute to the excluded fields
+------------------------------------------------------------------------- */
+
+int PolarTree::evaluate(double *xi, int moli, int mode, double *out)
+{
+  int k,m,node,own,leaf;
+  double R[3],rsq;
+
+  double *g = NULL;
+  for (k = 0; k < NOUT; k++) out[k] = 0.0;
+  if (nnodes == 0) return 0;
+
+  double e[3],grad[9];
+  int nnear = 0;
+  int nstack = 0;
+  stack[nstack++] = 0;
+
+  while (nstack) {
+    node = stack[--nstack];
+    R[0] = xi[0] - center[node][0];
+    R[1] = xi[1] - center[node][1];
+    R[2] = xi[2] - center[node][2];
+    rsq = R[0]*R[0] + R[1]*R[1] + R[2]*R[2];
+
+    own = 0;
+    if (moli && molmin[node] <= moli && moli <= molmax[node])
+      own = (molmin[node] == molmax[node]) ? 1 : 2;
+
+    if (own != 2 && edge[node]*edge[node] < theta*theta*rsq) {
+      g = (mode & GRADIENT) ? grad : NULL;
+      if ((mode & CHARGE) && !own) {
+        multipole_field(R,qmom[node][0],&qmom[node][1],&qmom[node][4],e,g);
+        for (k = 0; k < 3; k++) out[EQ+k] += e[k];
+        if (g) for (k = 0; k < 9; k++) out[GQ+k] += g[k];
+      }
+      if (mode & DIPOLE) {
+        multipole_field(R,0.0,&dmom[node][0],&dmom[node][3],e,g);
+        for (k = 0; k < 3; k++) out[EMU+k] += e[k];
+        if (!own) for (k = 0; k < 3; k++) out[EMUX+k] += e[k];
+        if (g) for (k = 0; k < 9; k++) out[GMU+k] += g[k];
+      }
+      continue;
+    }
+
+    leaf = 1;
+    for (k = 0; k < 8; k++)
+      if (child[node][k] >= 0) {
+        stack[nstack++] = child[node][k];
+        leaf = 0;
+      }
+
+    if (leaf) {
+      if (nnear + count[node] > maxnear) {
+        maxnear = nnear + count[node] + DELTA;
+        memory->grow(nearlist,maxnear,"polar/tree:nearlist");
+      }
+      for (m = first[node]; m < first[node]+count[node]; m++)
+        nearlist[nnear++] = perm[m];
+    }
+  }
+
+  return nnear;
+}
+
+/* ----------------------------------------------------------------------
+   field e = -grad phi and, if g is set, its gradient g[3*a+b] = dE_a/dR_b
+     at R from the node center of the moments m0, m1[3], m2[6]
+   m2 is stored as xx,yy,zz,xy,xz,yz
+------------------------------------------------------------------------- */
+
+void PolarTree::multipole_field(double *R, double m0, double *m1, double *m2,
+                                double *e, double *g)
+{
+  int a,b;
+  double r2inv = 1.0/(R[0]*R[0] + R[1]*R[1] + R[2]*R[2]);
+  double rinv = sqrt(r2inv);
+  double r3inv = r2inv*rinv;
+  double r5inv = r3inv*r2inv;
+  double r7inv = r5inv*r2inv;
+
+  double mr = m1[0]*R[0] + m1[1]*R[1] + m1[2]*R[2];
+
+  for (a = 0; a < 3; a++)
+    e[a] = m0*R[a]*r3inv - 3.0*R[a]*mr*r5inv + m1[a]*r3inv;
+
+  if (g) {
+    for (a = 0; a < 3; a++)
+      for (b = 0; b < 3; b++) {
+        g[3*a+b] = -m0*3.0*R[a]*R[b]*r5inv + 15.0*R[a]*R[b]*mr*r7inv -
+          3.0*(R[a]*m1[b] + R[b]*m1[a])*r5inv;
+        if (a == b) g[3*a+b] += m0*r3inv - 3.0*mr*r5inv;
+      }
+  }
+
+  if (order < 2) return;
+
+  double M[3][3];
+  M[0][0] = m2[0]; M[1][1] = m2[1]; M[2][2] = m2[2];
+  M[0][1] = M[1][0] = m2[3];
+  M[0][2] = M[2][0] = m2[4];
+  M[1][2] = M[2][1] = m2[5];
+  double tr = m2[0] + m2[1] + m2[2];
+
+  double MR[3];
+  for (a = 0; a < 3; a++) MR[a] = M[a][0]*R[0] + M[a][1]*R[1] + M[a][2]*R[2];
+  double rmr = R[0]*MR[0] + R[1]*MR[1] + R[2]*MR[2];
+
+  for (a = 0; a < 3; a++)
+    e[a] += 15.0*R[a]*rmr*r7inv - 3.0*(R[a]*tr + 2.0*MR[a])*r5inv;
+
+  if (g) {
+    double r9inv = r7inv*r2inv;
+    for (a = 0; a < 3; a++)
+      for (b = 0; b < 3; b++) {
+        g[3*a+b] += -105.0*R[a]*R[b]*rmr*r9inv +
+          15.0*(R[a]*R[b]*tr + 2.0*R[a]*MR[b] + 2.0*R[b]*MR[a])*r7inv -
+          6.0*M[a][b]*r5inv;
+        if (a == b) g[3*a+b] += 15.0*rmr*r7inv - 3.0*tr*r5inv;
+      }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of the tree
+------------------------------------------------------------------------- */
+
+double PolarTree::memory_usage()
+{
+  double bytes = nmax * sizeof(int);
+  bytes += maxnodes * (4 + 19) * sizeof(double);
+  bytes += maxnodes * (12) * sizeof(int);
+  bytes += (maxnear + maxstack) * sizeof(int);
+  return bytes;
+}
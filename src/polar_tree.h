@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_POLAR_TREE_H
+#define LMP_POLAR_TREE_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class PolarTree : protected Pointers {
+ public:
+  // sources and outputs of evaluate()
+
+  enum{CHARGE=1,DIPOLE=2,GRADIENT=4};
+
+  // offsets into the output of evaluate()
+  // field and field gradient of the charges, field of the dipoles,
+  //   field of the dipoles with exclusions, field gradient of the dipoles
+
+  enum{EQ=0,GQ=3,EMU=12,EMUX=15,GMU=18,NOUT=27};
+
+  int order;                    // highest multipole kept, 1 or 2
+  double theta;                 // opening angle
+  int *nearlist;                // atoms to be summed directly by caller
+
+  PolarTree(class LAMMPS *);
+  ~PolarTree();
+  void build(int, double **, int *);
+  void charge_moments(double *);
+  void dipole_moments(double **);
+  int evaluate(double *, int, int, double *);
+  double memory_usage();
+
+ private:
+  int natoms;                   // # of atoms in the tree
+  double **x;                   // ptr to coords of the atoms
+  int *molecule;                // ptr to molecule IDs of the atoms, or NULL
+  int *perm;                    // atom indices ordered by node
+  int nmax;                     // size of perm
+
+  int nnodes,maxnodes;
+  double **center;              // geometric center of each cubic node
+  double *edge;                 // edge length of each node
+  int *first,*count;            // range of each node in perm
+  int **child;                  // 8 children, -1 if none
+  int *molmin,*molmax;          // range of molecule IDs in each node
+  double **qmom;                // M0,M1[3],M2[6] of the charges
+  double **dmom;                // M1[3],M2[6] of the dipoles
+
+  int maxnear;
+  int *stack;
+  int maxstack;
+
+  int build_node(int, int, double *, double, int);
+  void grow_nodes();
+  void multipole_field(double *, double, double *, double *,
+                       double *, double *);
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   Philox4x32-10 counter-based RNG
+   Salmon, Moraes, Dror, Shaw, "Parallel random numbers: as easy as
+   1, 2, 3", Proc of SC11 (2011)
+------------------------------------------------------------------------- */
+
+#ifndef LMP_RANPHILOX_H
+#define LMP_RANPHILOX_H
+
+#include "lmptype.h"
+#include "math.h"
+
+namespace LAMMPS_NS {
+
+class RanPhilox {
+ public:
+
+  // seed and stream form the key
+  // different streams give independent sequences for the same counter
+
+  RanPhilox(int seed, int stream = 0) {
+    key0 = (uint32_t) seed;
+    stream0 = (uint32_t) stream;
+    reset(0,0,0);
+  }
+
+  // set the counter, e.g. to (atom ID, 0, timestep) or (ID1, ID2, timestep)
+  // subsequent draws are a pure function of seed, stream and counter,
+  //   so they do not depend on the order in which atoms are visited,
+  //   on which processor or thread owns them, or on prior draws
+
+  void reset(tagint a, tagint b, bigint step) {
+    uint64_t ustep = (uint64_t) step;
+    ctr[0] = (uint32_t) a;
+    ctr[1] = (uint32_t) b;
+    ctr[2] = (uint32_t) ustep;
+    ctr[3] = 0;
+    key1 = stream0 + 0x9E3779B9U * (uint32_t) (ustep >> 32);
+    nout = 4;
+  }
+
+  // uniform RN in the open interval (0,1)
+
+  double uniform() {
+    if (nout == 4) generate();
+    return (out[nout++] + 0.5) * 2.3283064365386963e-10;
+  }
+
+  // gaussian RN with zero mean and unit variance, via Box-Muller
+
+  double gaussian() {
+    double r = sqrt(-2.0*log(uniform()));
+    return r * cos(6.283185307179586*uniform());
+  }
+
+ private:
+  uint32_t key0,key1,stream0;
+  uint32_t ctr[4],out[4];
+  int nout;
+
+  // 10 rounds of the Philox S-box on the current counter,
+  // then increment the last counter word for the next block of 4 values
+
+  void generate() {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key0, k1 = key1;
+    for (int round = 0; round < 10; round++) {
+      uint64_t p0 = (uint64_t) 0xD2511F53U * c0;
+      uint64_t p1 = (uint64_t) 0xCD9E8D57U * c2;
+      uint32_t hi0 = (uint32_t) (p0 >> 32), lo0 = (uint32_t) p0;
+      uint32_t hi1 = (uint32_t) (p1 >> 32), lo1 = (uint32_t) p1;
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += 0x9E3779B9U;
+      k1 += 0xBB67AE85U;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+    ctr[3]++;
+    nout = 0;
+  }
+};
+
+}
+
+#endif
@@ -21,13 +21,15 @@
 #include "domain.h"
 #include "comm.h"
 #include "special.h"
+#include "irregular.h"
 #include "memory.h"
 #include "error.h"
 
 using namespace LAMMPS_NS;
 
 #define LB_FACTOR 1.1
-#define EPSILON   1.0e-6
+#define BUFFACTOR 1.5
+#define BUFMIN 1000
 
 /* ---------------------------------------------------------------------- */
 
@@ -37,7 +39,7 @@ Replicate::Replicate(LAMMPS *lmp) : Pointers(lmp) {}
 
 void Replicate::command(int narg, char **arg)
 {
-  int i,j,m,n;
+  int i,m,n;
 
   if (domain->box_exist == 0)
     error->all(FLERR,"Replicate command before simulation box is defined");
@@ -50,9 +52,9 @@ void Replicate::command(int narg, char **arg)
 
   // nrep = total # of replications
 
-  int nx = atoi(arg[0]);
-  int ny = atoi(arg[1]);
-  int nz = atoi(arg[2]);
+  nx = atoi(arg[0]);
+  ny = atoi(arg[1]);
+  nz = atoi(arg[2]);
   int nrep = nx*ny*nz;
 
   // error and warning checks
@@ -73,7 +75,7 @@ void Replicate::command(int narg, char **arg)
 
   // maxtag = largest atom tag across all existing atoms
 
-  int maxtag = 0;
+  maxtag = 0;
   for (i = 0; i < atom->nlocal; i++) maxtag = MAX(atom->tag[i],maxtag);
   int maxtag_all;
   MPI_Allreduce(&maxtag,&maxtag_all,1,MPI_INT,MPI_MAX,world);
@@ -81,7 +83,7 @@ void Replicate::command(int narg, char **arg)
 
   // maxmol = largest molecule tag across all existing atoms
 
-  int maxmol = 0;
+  maxmol = 0;
   if (atom->molecular) {
     for (i = 0; i < atom->nlocal; i++) maxmol = MAX(atom->molecule[i],maxmol);
     int maxmol_all;
@@ -94,17 +96,16 @@ void Replicate::command(int narg, char **arg)
   for (i = 0; i < atom->nlocal; i++)
     domain->unmap(atom->x[i],atom->image[i]);
 
-  // communication buffer for all my atom's info
-  // max_size = largest buffer needed by any proc
+  // pack my unmapped atoms into buf, only my atoms are replicated by me
   // must do before new Atom class created,
   //   since size_restart() uses atom->nlocal
 
-  int max_size;
-  int send_size = atom->avec->size_restart();
-  MPI_Allreduce(&send_size,&max_size,1,MPI_INT,MPI_MAX,world);
-
   double *buf;
-  memory->create(buf,max_size,"replicate:buf");
+  memory->create(buf,atom->avec->size_restart(),"replicate:buf");
+
+  int nbuf = 0;
+  for (i = 0; i < atom->nlocal; i++)
+    nbuf += atom->avec->pack_restart(i,&buf[nbuf]);
 
   // old = original atom class
   // atom = new replicated atom class
@@ -165,13 +166,13 @@ void Replicate::command(int narg, char **arg)
 
   // store old simulation box
 
-  int triclinic = domain->triclinic;
-  double old_xprd = domain->xprd;
-  double old_yprd = domain->yprd;
-  double old_zprd = domain->zprd;
-  double old_xy = domain->xy;
-  double old_xz = domain->xz;
-  double old_yz = domain->yz;
+  triclinic = domain->triclinic;
+  old_xprd = domain->xprd;
+  old_yprd = domain->yprd;
+  old_zprd = domain->zprd;
+  old_xy = domain->xy;
+  old_xz = domain->xz;
+  old_yz = domain->yz;
 
   // setup new simulation box
 
@@ -208,150 +209,102 @@ void Replicate::command(int narg, char **arg)
     }
   }
 
-  // set bounds for my proc
-  // if periodic and I am lo/hi proc, adjust bounds by EPSILON
-  // insures all replicated atoms will be owned even with round-off
-
-  double epsilon[3];
-  if (triclinic) epsilon[0] = epsilon[1] = epsilon[2] = EPSILON;
-  else {
-    epsilon[0] = domain->prd[0] * EPSILON;
-    epsilon[1] = domain->prd[1] * EPSILON;
-    epsilon[2] = domain->prd[2] * EPSILON;
-  }
-
-  double sublo[3],subhi[3];
-  if (triclinic == 0) {
-    sublo[0] = domain->sublo[0]; subhi[0] = domain->subhi[0];
-    sublo[1] = domain->sublo[1]; subhi[1] = domain->subhi[1];
-    sublo[2] = domain->sublo[2]; subhi[2] = domain->subhi[2];
-  } else {
-    sublo[0] = domain->sublo_lamda[0]; subhi[0] = domain->subhi_lamda[0];
-    sublo[1] = domain->sublo_lamda[1]; subhi[1] = domain->subhi_lamda[1];
-    sublo[2] = domain->sublo_lamda[2]; subhi[2] = domain->subhi_lamda[2];
-  }
+  // old atom class is no longer needed, its atoms are in buf
 
-  if (domain->xperiodic) {
-    if (comm->myloc[0] == 0) sublo[0] -= epsilon[0];
-    if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] += epsilon[0];
-  }
-  if (domain->yperiodic) {
-    if (comm->myloc[1] == 0) sublo[1] -= epsilon[1];
-    if (comm->myloc[1] == comm->procgrid[1]-1) subhi[1] += epsilon[1];
-  }
-  if (domain->zperiodic) {
-    if (comm->myloc[2] == 0) sublo[2] -= epsilon[2];
-    if (comm->myloc[2] == comm->procgrid[2]-1) subhi[2] += epsilon[2];
-  }
+  delete old;
 
-  // loop over all procs
-  // if this iteration of loop is me:
-  //   pack my unmapped atom data into buf
-  //   bcast it to all other procs
-  // performs 3d replicate loop with while loop over atoms in buf
+  // loop over my atoms in buf and all their images
   //   x = new replicated position, remapped into simulation box
-  //   unpack atom into new atom class from buf if I own it
-  //   adjust tag, mol #, coord, topology info as needed
+  //   proc = owner of x via same assignment as Irregular::migrate_atoms()
+  //   if I own it, unpack it into new atom class now
+  //   else add image index and atom to send buffer for proc
+  // no other proc loops over my atoms, no proc sees all the old atoms
 
-  AtomVec *old_avec = old->avec;
-  AtomVec *avec = atom->avec;
+  Irregular *irregular = new Irregular(lmp);
+  irregular->setup_coord2proc();
 
-  int ix,iy,iz,atom_offset,mol_offset;
+  int ix,iy,iz,igx,igy,igz,proc,size;
   tagint image;
   double x[3],lamda[3];
   double *coord;
-  int tag_enable = atom->tag_enable;
-
-  for (int iproc = 0; iproc < nprocs; iproc++) {
-    if (me == iproc) {
-      n = 0;
-      for (i = 0; i < old->nlocal; i++) n += old_avec->pack_restart(i,&buf[n]);
-    }
-    MPI_Bcast(&n,1,MPI_INT,iproc,world);
-    MPI_Bcast(buf,n,MPI_DOUBLE,iproc,world);
 
+  int nsend = 0;
+  int nsendatom = 0;
+  int maxsend = BUFMIN;
+  int maxsendatom = BUFMIN;
+  double *buf_send;
+  int *sizes,*proclist;
+  memory->create(buf_send,maxsend,"replicate:buf_send");
+  memory->create(sizes,maxsendatom,"replicate:sizes");
+  memory->create(proclist,maxsendatom,"replicate:proclist");
+
+  m = 0;
+  while (m < nbuf) {
+    size = static_cast<int> (buf[m]);
     for (ix = 0; ix < nx; ix++) {
       for (iy = 0; iy < ny; iy++) {
         for (iz = 0; iz < nz; iz++) {
+          replicate_coord(&buf[m+1],ix,iy,iz,x,image);
+          if (triclinic) {
+            domain->x2lamda(x,lamda);
+            coord = lamda;
+          } else coord = x;
+          proc = irregular->coord2proc(coord,igx,igy,igz);
+
+          if (proc == me) {
+            unpack_atom(&buf[m],ix,iy,iz);
+            continue;
+          }
 
-          // while loop over one proc's atom list
-
-          m = 0;
-          while (m < n) {
-            image = ((tagint) IMGMAX << IMG2BITS) |
-              ((tagint) IMGMAX << IMGBITS) | IMGMAX;
-            if (triclinic == 0) {
-              x[0] = buf[m+1] + ix*old_xprd;
-              x[1] = buf[m+2] + iy*old_yprd;
-              x[2] = buf[m+3] + iz*old_zprd;
-            } else {
-              x[0] = buf[m+1] + ix*old_xprd + iy*old_xy + iz*old_xz;
-              x[1] = buf[m+2] + iy*old_yprd + iz*old_yz;
-              x[2] = buf[m+3] + iz*old_zprd;
-            }
-            domain->remap(x,image);
-            if (triclinic) {
-              domain->x2lamda(x,lamda);
-              coord = lamda;
-            } else coord = x;
-
-            if (coord[0] >= sublo[0] && coord[0] < subhi[0] &&
-                coord[1] >= sublo[1] && coord[1] < subhi[1] &&
-                coord[2] >= sublo[2] && coord[2] < subhi[2]) {
-
-              m += avec->unpack_restart(&buf[m]);
-
-              i = atom->nlocal - 1;
-              if (tag_enable)
-                atom_offset = iz*ny*nx*maxtag + iy*nx*maxtag + ix*maxtag;
-              else atom_offset = 0;
-              mol_offset = iz*ny*nx*maxmol + iy*nx*maxmol + ix*maxmol;
-
-              atom->x[i][0] = x[0];
-              atom->x[i][1] = x[1];
-              atom->x[i][2] = x[2];
-
-              atom->tag[i] += atom_offset;
-              atom->image[i] = image;
-
-              if (atom->molecular) {
-                if (atom->molecule[i] > 0)
-                  atom->molecule[i] += mol_offset;
-                if (atom->avec->bonds_allow)
-                  for (j = 0; j < atom->num_bond[i]; j++)
-                    atom->bond_atom[i][j] += atom_offset;
-                if (atom->avec->angles_allow)
-                  for (j = 0; j < atom->num_angle[i]; j++) {
-                    atom->angle_atom1[i][j] += atom_offset;
-                    atom->angle_atom2[i][j] += atom_offset;
-                    atom->angle_atom3[i][j] += atom_offset;
-                  }
-                if (atom->avec->dihedrals_allow)
-                  for (j = 0; j < atom->num_dihedral[i]; j++) {
-                    atom->dihedral_atom1[i][j] += atom_offset;
-                    atom->dihedral_atom2[i][j] += atom_offset;
-                    atom->dihedral_atom3[i][j] += atom_offset;
-                    atom->dihedral_atom4[i][j] += atom_offset;
-                  }
-                if (atom->avec->impropers_allow)
-                  for (j = 0; j < atom->num_improper[i]; j++) {
-                    atom->improper_atom1[i][j] += atom_offset;
-                    atom->improper_atom2[i][j] += atom_offset;
-                    atom->improper_atom3[i][j] += atom_offset;
-                    atom->improper_atom4[i][j] += atom_offset;
-                  }
-              }
-            } else m += static_cast<int> (buf[m]);
+          if (nsend+size+1 > maxsend) {
+            maxsend = static_cast<int> (BUFFACTOR * (nsend+size+1));
+            memory->grow(buf_send,maxsend,"replicate:buf_send");
+          }
+          if (nsendatom == maxsendatom) {
+            maxsendatom = static_cast<int> (BUFFACTOR * maxsendatom);
+            memory->grow(sizes,maxsendatom,"replicate:sizes");
+            memory->grow(proclist,maxsendatom,"replicate:proclist");
           }
+          buf_send[nsend] = (iz*ny + iy)*nx + ix;
+          memcpy(&buf_send[nsend+1],&buf[m],size*sizeof(double));
+          sizes[nsendatom] = size + 1;
+          proclist[nsendatom] = proc;
+          nsend += size + 1;
+          nsendatom++;
         }
       }
     }
+    m += size;
   }
 
-  // free communication buffer and old atom class
-
   memory->destroy(buf);
-  delete old;
+
+  // send atoms to owning procs via irregular comm
+  // each received atom is preceded by its image index
+
+  int nrecv = irregular->create_atom(nsendatom,sizes,proclist);
+  double *buf_recv;
+  memory->create(buf_recv,nrecv,"replicate:buf_recv");
+  irregular->exchange_atom(buf_send,sizes,buf_recv);
+  irregular->destroy_atom();
+  delete irregular;
+
+  memory->destroy(buf_send);
+  memory->destroy(sizes);
+  memory->destroy(proclist);
+
+  int index;
+  m = 0;
+  while (m < nrecv) {
+    index = static_cast<int> (buf_recv[m]);
+    ix = index % nx;
+    iy = (index/nx) % ny;
+    iz = index / (nx*ny);
+    unpack_atom(&buf_recv[m+1],ix,iy,iz);
+    m += static_cast<int> (buf_recv[m+1]) + 1;
+  }
+
+  memory->destroy(buf_recv);
 
   // check that all atoms were assigned to procs
 
@@ -404,3 +357,82 @@ void Replicate::command(int narg, char **arg)
     special.build();
   }
 }
+
+/* ----------------------------------------------------------------------
+   xold = unmapped coords of an old atom
+   return x = coords of its ix,iy,iz image, remapped into new box
+   return image = image flags of x
+------------------------------------------------------------------------- */
+
+void Replicate::replicate_coord(double *xold, int ix, int iy, int iz,
+                                double *x, tagint &image)
+{
+  image = ((tagint) IMGMAX << IMG2BITS) |
+    ((tagint) IMGMAX << IMGBITS) | IMGMAX;
+  if (triclinic == 0) {
+    x[0] = xold[0] + ix*old_xprd;
+    x[1] = xold[1] + iy*old_yprd;
+    x[2] = xold[2] + iz*old_zprd;
+  } else {
+    x[0] = xold[0] + ix*old_xprd + iy*old_xy + iz*old_xz;
+    x[1] = xold[1] + iy*old_yprd + iz*old_yz;
+    x[2] = xold[2] + iz*old_zprd;
+  }
+  domain->remap(x,image);
+}
+
+/* ----------------------------------------------------------------------
+   unpack restart record of an old atom as its ix,iy,iz image
+   adjust tag, mol #, coord, topology info as needed
+------------------------------------------------------------------------- */
+
+void Replicate::unpack_atom(double *buf, int ix, int iy, int iz)
+{
+  int j,atom_offset,mol_offset;
+  tagint image;
+  double x[3];
+
+  replicate_coord(&buf[1],ix,iy,iz,x,image);
+  atom->avec->unpack_restart(buf);
+
+  int i = atom->nlocal - 1;
+  if (atom->tag_enable)
+    atom_offset = iz*ny*nx*maxtag + iy*nx*maxtag + ix*maxtag;
+  else atom_offset = 0;
+  mol_offset = iz*ny*nx*maxmol + iy*nx*maxmol + ix*maxmol;
+
+  atom->x[i][0] = x[0];
+  atom->x[i][1] = x[1];
+  atom->x[i][2] = x[2];
+
+  atom->tag[i] += atom_offset;
+  atom->image[i] = image;
+
+  if (atom->molecular) {
+    if (atom->molecule[i] > 0)
+      atom->molecule[i] += mol_offset;
+    if (atom->avec->bonds_allow)
+      for (j = 0; j < atom->num_bond[i]; j++)
+        atom->bond_atom[i][j] += atom_offset;
+    if (atom->avec->angles_allow)
+      for (j = 0; j < atom->num_angle[i]; j++) {
+        atom->angle_atom1[i][j] += atom_offset;
+        atom->angle_atom2[i][j] += atom_offset;
+        atom->angle_atom3[i][j] += atom_offset;
+      }
+    if (atom->avec->dihedrals_allow)
+      for (j = 0; j < atom->num_dihedral[i]; j++) {
+        atom->dihedral_atom1[i][j] += atom_offset;
+        atom->dihedral_atom2[i][j] += atom_offset;
+        atom->dihedral_atom3[i][j] += atom_offset;
+        atom->dihedral_atom4[i][j] += atom_offset;
+      }
+    if (atom->avec->impropers_allow)
+      for (j = 0; j < atom->num_improper[i]; j++) {
+        atom->improper_atom1[i][j] += atom_offset;
+        atom->improper_atom2[i][j] += atom_offset;
+        atom->improper_atom3[i][j] += atom_offset;
+        atom->improper_atom4[i][j] += atom_offset;
+      }
+  }
+}
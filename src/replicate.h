@@ -28,6 +28,16 @@ class Replicate : protected Pointers {
  public:
   Replicate(class LAMMPS *);
   void command(int, char **);
+
+ private:
+  int nx,ny,nz;                       // # of replications in each dim
+  int maxtag,maxmol;                  // largest atom and molecule IDs
+  int triclinic;
+  double old_xprd,old_yprd,old_zprd;  // old simulation box
+  double old_xy,old_xz,old_yz;
+
+  void replicate_coord(double *, int, int, int, double *, tagint &);
+  void unpack_atom(double *, int, int, int);
 };
 
 }